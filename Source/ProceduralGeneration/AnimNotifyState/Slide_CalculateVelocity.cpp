@@ -4,28 +4,22 @@
 #include "ProceduralGeneration/AnimNotifyState/Slide_CalculateVelocity.h"
 
 #include "GameFramework/CharacterMovementComponent.h"
-#include "ProceduralGeneration/PGameTags.h"
-#include "ProceduralGeneration/MechanicComponents/MechanicsComponent.h"
 
 void USlide_CalculateVelocity::Notify(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, const FAnimNotifyEventReference& EventReference)
 {
-	Super::Notify(MeshComp, Animation);
+	Super::Notify(MeshComp, Animation, EventReference);
 
-	if (Player == Cast<AParkourCharacter>(MeshComp->GetOwner()))
+	const AParkourCharacter* Player = Cast<AParkourCharacter>(MeshComp->GetOwner());
+	if (!Player)
 	{
-		if(UMechanicsComponent* MechanicsComponent = Player->FindComponentByClass<UMechanicsComponent>())
-		{
-			if (MechanicsComponent)
-			{
-				if(UBaseMechanic* SlideMechanic = MechanicsComponent->GetMechanic(USlideMechanic::StaticClass()))
-				{
-					if(USlideMechanic* Slide = Cast<USlideMechanic>(SlideMechanic))
-					{
-						Slide->SetSlideVelocity(Player->GetCharacterMovement()->Velocity);
-						Slide->CheckShouldContinueSlide();
-					}
-				}
-			}
-		}
+		return;
+	}
+
+	USlideMechanic* Slide = Player->GetSlideMechanic();
+	const FMechanicContext Context = Slide ? Player->GetMechanicComponent()->GetMechanicContext(Slide) : FMechanicContext();
+	if (Context.IsValid())
+	{
+		Slide->SetSlideVelocity(Context, Player->GetCharacterMovement()->Velocity);
+		Slide->CheckShouldContinueSlide(Context);
 	}
 }
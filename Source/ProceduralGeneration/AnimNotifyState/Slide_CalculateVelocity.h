@@ -19,10 +19,6 @@ class PROCEDURALGENERATION_API USlide_CalculateVelocity : public UAnimNotify
 	GENERATED_BODY()
 
 public:
+	// The notify is shared by every mesh playing the animation, so the character is looked up per call
 	virtual void Notify(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, const FAnimNotifyEventReference& EventReference) override;
-
-protected:
-	AParkourCharacter* Player;
-
-	UPAnimInstance* Instance;
 };
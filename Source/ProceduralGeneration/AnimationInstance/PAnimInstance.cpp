@@ -30,30 +30,16 @@ void UPAnimInstance::SetWallrunDirection(EDirection Direction)
 	WallrunDirection = Direction;
 }
 
-void UPAnimInstance::SetHandRightAlpha(float Alpha)
+void UPAnimInstance::SetWallrunHandIK(const FWallRunHandIK& HandIK)
 {
-	WallrunHandIK_RightAlpha = FMath::FInterpTo(WallrunHandIK_RightAlpha, Alpha, GetWorld()->DeltaTimeSeconds, 10.f);
-}
-
-void UPAnimInstance::SetHandLeftAlpha(float Alpha)
-{
-	WallrunHandIK_LeftAlpha = FMath::FInterpTo(WallrunHandIK_LeftAlpha, Alpha, GetWorld()->DeltaTimeSeconds, 10.f);
-}
-
-void UPAnimInstance::SetHandRightLocation(FVector Location)
-{
-	WallrunHandIK_RightLocation = Location;
-}
-
-void UPAnimInstance::SetHandLeftLocation(FVector Location)
-{
-	WallrunHandIK_LeftLocation = Location;
+	// Already blended by the mechanic
+	WallrunHandIK_LeftLocation = HandIK.LeftLocation;
+	WallrunHandIK_RightLocation = HandIK.RightLocation;
+	WallrunHandIK_LeftAlpha = HandIK.LeftAlpha;
+	WallrunHandIK_RightAlpha = HandIK.RightAlpha;
 }
 
 void UPAnimInstance::ResetIK()
 {
-	WallrunHandIK_LeftLocation = FVector(0,0,0);
-	WallrunHandIK_RightLocation = FVector(0,0,0);
-	WallrunHandIK_LeftAlpha = 0;
-	WallrunHandIK_RightAlpha = 0;
+	SetWallrunHandIK(FWallRunHandIK());
 }
@@ -7,6 +7,18 @@
 #include "ProceduralGeneration/PGameTags.h"
 #include "PAnimInstance.generated.h"
 
+// Wall run hand IK targets, worked out by the wall run mechanic and handed over once per update
+USTRUCT(BlueprintType)
+struct FWallRunHandIK
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly) FVector LeftLocation = FVector::ZeroVector;
+	UPROPERTY(BlueprintReadOnly) FVector RightLocation = FVector::ZeroVector;
+	UPROPERTY(BlueprintReadOnly) float LeftAlpha = 0.f;
+	UPROPERTY(BlueprintReadOnly) float RightAlpha = 0.f;
+};
+
 /**
  * 
  */
@@ -29,11 +41,8 @@ public:
 	void SetIsWallrunning(bool Val);
 	FORCEINLINE UFUNCTION() EDirection GetWallrunDirection() { return WallrunDirection; }
 	void SetWallrunDirection(EDirection Direction);
-	// Wall Running - Hand IK
-	void SetHandRightAlpha(float Alpha);
-	void SetHandLeftAlpha(float Alpha);
-	void SetHandRightLocation(FVector Location);
-	void SetHandLeftLocation(FVector Location);
+	// Wall Running - Hand IK, copied into the properties the anim blueprint reads
+	void SetWallrunHandIK(const FWallRunHandIK& HandIK);
 	void ResetIK();
 protected:
 	UPROPERTY(BlueprintReadWrite, Category = "Animation") bool bIsCrouching;
@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Set of mechanic gameplay tags as bits. The mechanics component gives each tag it sees a bit when the
+ * tags are compiled, so block checks and giving or removing tags on start and stop are single AND/OR ops
+ * instead of container searches. Tags are matched exactly, like HasAnyExact.
+ */
+struct FMechanicTagMask
+{
+	static constexpr int32 MaxTags = 64;
+
+	uint64 Bits = 0;
+
+	FORCEINLINE bool IsEmpty() const { return Bits == 0; }
+	FORCEINLINE bool HasAny(const FMechanicTagMask& Other) const { return (Bits & Other.Bits) != 0; }
+	FORCEINLINE bool HasBit(int32 Bit) const { return (Bits & (uint64(1) << Bit)) != 0; }
+
+	FORCEINLINE void SetBit(int32 Bit) { Bits |= uint64(1) << Bit; }
+	FORCEINLINE void Append(const FMechanicTagMask& Other) { Bits |= Other.Bits; }
+	FORCEINLINE void Remove(const FMechanicTagMask& Other) { Bits &= ~Other.Bits; }
+
+	// Bits set here that aren't set in Other
+	FORCEINLINE FMechanicTagMask Without(const FMechanicTagMask& Other) const { return FMechanicTagMask{ Bits & ~Other.Bits }; }
+
+	template <typename FuncType>
+	void ForEachBit(FuncType Func) const
+	{
+		for (uint64 Remaining = Bits; Remaining != 0; Remaining &= Remaining - 1)
+		{
+			Func(static_cast<int32>(FMath::CountTrailingZeros64(Remaining)));
+		}
+	}
+};
@@ -2,16 +2,21 @@
 
 #include "MechanicsComponent.h"
 
+#include "MechanicsSubsystem.h"
+#include "ProceduralGeneration/ParkourCharacter.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "ProceduralGeneration/AnimationInstance/PAnimInstance.h"
 #include "ProceduralGeneration/Mechanics/BaseMechanic.h"
+#include "Procedural Generation/ProcGenStats.h"
 
 // Sets default values for this component's properties
 UMechanicsComponent::UMechanicsComponent()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
-	PrimaryComponentTick.bCanEverTick = true;
+	// Mechanics are ticked in batches by UMechanicsSubsystem
+	PrimaryComponentTick.bCanEverTick = false;
 
-	// ...
+	MechanicsSubsystem = nullptr;
 }
 
 UMechanicsComponent* UMechanicsComponent::GetMechanicsComponent(AActor* GetActor)
@@ -24,7 +29,7 @@ UMechanicsComponent* UMechanicsComponent::GetMechanicsComponent(AActor* GetActor
 	return nullptr;
 }
 
-FGameplayTagContainer& UMechanicsComponent::GetActiveTags()
+const FGameplayTagContainer& UMechanicsComponent::GetActiveTags() const
 {
 	return ActiveGameplayTags;
 }
@@ -34,132 +39,289 @@ FGameplayTagContainer UMechanicsComponent::GetBlockedTags()
 	return BlockedGameplayTags;
 }
 
+void UMechanicsComponent::SetBlockedTags(const FGameplayTagContainer& Tags)
+{
+	BlockedGameplayTags = Tags;
+	BlockedTagMask = CompileTags(BlockedGameplayTags);
+}
+
+void UMechanicsComponent::AddBlockedTags(const FGameplayTagContainer& Tags)
+{
+	BlockedGameplayTags.AppendTags(Tags);
+	BlockedTagMask = CompileTags(BlockedGameplayTags);
+}
+
+void UMechanicsComponent::RemoveBlockedTags(const FGameplayTagContainer& Tags)
+{
+	BlockedGameplayTags.RemoveTags(Tags);
+	BlockedTagMask = CompileTags(BlockedGameplayTags);
+}
+
 FGameplayTag& UMechanicsComponent::GetMasterBlockedTag()
 {
 	return MasterBlockTag;
 }
 
+FMechanicContext UMechanicsComponent::GetMechanicContext(const UBaseMechanic* Mechanic) const
+{
+	const int32 Index = Mechanics.IndexOfByKey(Mechanic);
+	if (Index == INDEX_NONE || !MechanicsSubsystem)
+	{
+		return FMechanicContext();
+	}
+
+	return MechanicsSubsystem->GetContext(MechanicStates[Index]);
+}
+
+bool UMechanicsComponent::IsMechanicRunning(const UBaseMechanic* Mechanic) const
+{
+	const FMechanicContext Context = GetMechanicContext(Mechanic);
+	return Context.IsValid() && Context.IsRunning();
+}
+
+void UMechanicsComponent::OnMechanicStateMoved(const FMechanicStateHandle& From, int32 NewIndex)
+{
+	if (FMechanicStateHandle* Handle = MechanicStates.FindByKey(From))
+	{
+		Handle->Index = NewIndex;
+	}
+}
+
 UBaseMechanic* UMechanicsComponent::GetMechanic(TSubclassOf<UBaseMechanic> Mechanic)
 {
-	for (int i = 0; i < Mechanics.Num(); i++)
+	return MechanicsByClass.FindRef(Mechanic.Get());
+}
+
+UBaseMechanic* UMechanicsComponent::FindMechanic(FGameplayTag MechanicTag) const
+{
+	return MechanicsByTag.FindRef(MechanicTag);
+}
+
+void UMechanicsComponent::RegisterMechanic(UBaseMechanic* Mechanic)
+{
+	// An empty tag never matched anything in the old exact tag search
+	if (Mechanic->MechanicTag.IsValid())
+	{
+		MechanicsByTag.Add(Mechanic->MechanicTag, Mechanic);
+	}
+
+	for (UClass* Class = Mechanic->GetClass(); Class; Class = Class->GetSuperClass())
 	{
-		if (Mechanics[i] && Mechanics[i]->IsA(Mechanic))
+		if (!MechanicsByClass.Contains(Class))
 		{
-			return Mechanics[i];
+			MechanicsByClass.Add(Class, Mechanic);
+		}
+
+		if (Class == UBaseMechanic::StaticClass())
+		{
+			break;
 		}
 	}
+}
 
-	return nullptr;
+void UMechanicsComponent::RebuildMechanicLookups()
+{
+	MechanicsByTag.Reset();
+	MechanicsByClass.Reset();
+
+	for (UBaseMechanic* Mechanic : Mechanics)
+	{
+		if (Mechanic)
+		{
+			RegisterMechanic(Mechanic);
+		}
+	}
 }
 
 void UMechanicsComponent::AddMechanic(AActor* TargetActor, TSubclassOf<UBaseMechanic> MechanicClass, bool bAutoAdded)
 {
-	if (!MechanicClass)
+	// States live in the subsystem, which only exists in game worlds
+	if (!MechanicClass || !MechanicsSubsystem)
 	{
 		return;
 	}
 
-	UBaseMechanic* NewMechanic = NewObject<UBaseMechanic>(GetOwner(), MechanicClass);
+	// Every character shares the class default, only a row of state is added for this one
+	UBaseMechanic* Definition = MechanicClass.GetDefaultObject();
 
 	// Check to see if tag already exists
-	if (DoesTagExist(NewMechanic->MechanicTag))
+	if (DoesTagExist(Definition->MechanicTag) || Mechanics.Contains(Definition))
 	{
 		return;
 	}
 
-	if (NewMechanic)
-	{
-		NewMechanic->Initialize(this);
-		NewMechanic->OnMechanicAdded(GetOwner());
-		Mechanics.Add(NewMechanic);
+	const FMechanicStateHandle Handle = MechanicsSubsystem->AddMechanicState(this, Definition);
+	Mechanics.Add(Definition);
+	MechanicStates.Add(Handle);
+	RegisterMechanic(Definition);
 
-		if (NewMechanic->StartByDefault && NewMechanic->CanStart(TargetActor))
-		{
-			NewMechanic->StartMechanic(TargetActor);
-		}
+	Definition->InitializeState(MechanicsSubsystem->GetContext(Handle));
+
+	OnMechanicsChanged.Broadcast();
+
+	// Listeners may have added mechanics of their own, which can move the state
+	const FMechanicContext Context = GetMechanicContext(Definition);
+	if (Definition->StartByDefault && Context.IsValid() && Definition->CanStart(Context))
+	{
+		Definition->StartMechanic(Context);
 	}
 }
 
 void UMechanicsComponent::RemoveMechanic(UBaseMechanic* MechanicToRemove)
 {
-	if (!MechanicToRemove)
+	const int32 Index = Mechanics.IndexOfByKey(MechanicToRemove);
+	if (Index == INDEX_NONE)
 	{
 		return;
 	}
 
-	if (MechanicToRemove->GetIsRunning())
+	const FMechanicContext Context = GetMechanicContext(MechanicToRemove);
+	if (Context.IsValid())
 	{
-		MechanicToRemove->StopMechanic(GetOwner());
+		if (Context.IsRunning())
+		{
+			MechanicToRemove->StopMechanic(Context);
+		}
+
+		MechanicToRemove->OnMechanicRemoved(Context);
+		MechanicsSubsystem->RemoveMechanicState(MechanicStates[Index]);
 	}
 
-	Mechanics.Remove(MechanicToRemove);
+	Mechanics.RemoveAt(Index);
+	MechanicStates.RemoveAt(Index);
+
+	// Another mechanic may take over one of its parent classes, removing is rare enough to rebuild
+	RebuildMechanicLookups();
+
+	OnMechanicsChanged.Broadcast();
 }
 
 bool UMechanicsComponent::StartMechanic(AActor* Actor, FGameplayTag MechanicTag)
 {
-	//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Entering StartMechanic Function"));
+	return StartMechanicInstance(Actor, FindMechanic(MechanicTag));
+}
+
+bool UMechanicsComponent::StopMechanic(AActor* Actor, FGameplayTag MechanicTag)
+{
+	return StopMechanicInstance(Actor, FindMechanic(MechanicTag));
+}
 
-	if (GetActiveTags().HasAnyExact(GetBlockedTags()))
+bool UMechanicsComponent::StartMechanicInstance(AActor* Actor, UBaseMechanic* Mechanic)
+{
+	if (!Mechanic)
 	{
-		//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Matches Blocked Tags"));
 		return false;
 	}
 
-	for (int i = 0; i < Mechanics.Num(); i++)
+	if (HasAnyActiveTags(BlockedTagMask))
 	{
-		if (Mechanics[i] && Mechanics[i]->MechanicTag.MatchesTagExact(MechanicTag))
-		{
-			//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Found Mechanic from tag"));
-			if (!Mechanics[i]->CanStart(Actor))
-			{
-				// log no start
-				//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Mechanic Won't start"));
-				continue;
-			}
-
-			Mechanics[i]->StartMechanic_Implementation(Actor);
-			return true;
-		}
+		return false;
 	}
 
-	//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("No matching tags"));
+	const FMechanicContext Context = GetMechanicContext(Mechanic);
+	if (!Context.IsValid() || !Mechanic->CanStart(Context))
+	{
+		return false;
+	}
 
-	return false;
+	Mechanic->StartMechanic(Context);
+	return true;
 }
 
-bool UMechanicsComponent::StopMechanic(AActor* Actor, FGameplayTag MechanicTag)
+bool UMechanicsComponent::StopMechanicInstance(AActor* Actor, UBaseMechanic* Mechanic)
 {
-	//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Entering StopMechanic Function"));
+	// if running stop action
+	const FMechanicContext Context = GetMechanicContext(Mechanic);
+	if (!Context.IsValid() || !Context.IsRunning())
+	{
+		return false;
+	}
+
+	Mechanic->StopMechanic(Context);
+	return true;
+}
 
-	for (int i = 0; i < Mechanics.Num(); i++)
+void UMechanicsComponent::OnOwnerHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	if (!MechanicsSubsystem)
 	{
-		if (Mechanics[i] && Mechanics[i]->MechanicTag.MatchesTagExact(MechanicTag))
-		{
-			//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Found Mechanic from tag"));
-			if (Mechanics[i]->GetIsRunning())
-			{
-				// if running stop action
-				//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Mechanic Stopped"));
-				Mechanics[i]->StopMechanic_Implementation(Actor);
-				return true;
-			}
-		}
+		return;
 	}
 
-	return false;
+	for (int32 Index = 0; Index < Mechanics.Num(); Index++)
+	{
+		Mechanics[Index]->OnOwnerHit(MechanicsSubsystem->GetContext(MechanicStates[Index]), OtherActor, OtherComp, Hit);
+	}
 }
 
 bool UMechanicsComponent::DoesTagExist(FGameplayTag Tag)
 {
-	for (int i = 0; i < Mechanics.Num(); i++)
+	return MechanicsByTag.Contains(Tag);
+}
+
+FMechanicTagMask UMechanicsComponent::CompileTags(const FGameplayTagContainer& Tags)
+{
+	FMechanicTagMask Mask;
+	for (const FGameplayTag& Tag : Tags)
 	{
-		if (Mechanics[i]->MechanicTag.MatchesTagExact(Tag))
+		if (const int32* Bit = TagBits.Find(Tag))
+		{
+			Mask.SetBit(*Bit);
+			continue;
+		}
+
+		if (TagsByBit.Num() >= FMechanicTagMask::MaxTags)
 		{
-			return true;
+			UE_LOG(LogProcGen, Error, TEXT("%s: more than %d mechanic tags, %s won't be tracked"), *GetNameSafe(GetOwner()), FMechanicTagMask::MaxTags, *Tag.ToString());
+			continue;
 		}
+
+		const int32 NewBit = TagsByBit.Add(Tag);
+		TagBits.Add(Tag, NewBit);
+		Mask.SetBit(NewBit);
+	}
+	return Mask;
+}
+
+void UMechanicsComponent::CompileComponentTags()
+{
+	BlockedTagMask = CompileTags(BlockedGameplayTags);
+
+	// Tags set up as active in the editor start active
+	ActiveTagMask = CompileTags(ActiveGameplayTags);
+}
+
+void UMechanicsComponent::AddActiveTags(const FMechanicTagMask& Tags)
+{
+	const FMechanicTagMask Added = Tags.Without(ActiveTagMask);
+	if (Added.IsEmpty())
+	{
+		return;
 	}
 
-	return false;
+	ActiveTagMask.Append(Added);
+
+	// Only tags that actually changed touch the container
+	Added.ForEachBit([this](int32 Bit)
+	{
+		ActiveGameplayTags.AddTag(TagsByBit[Bit]);
+	});
+}
+
+void UMechanicsComponent::RemoveActiveTags(const FMechanicTagMask& Tags)
+{
+	const FMechanicTagMask Removed{ ActiveTagMask.Bits & Tags.Bits };
+	if (Removed.IsEmpty())
+	{
+		return;
+	}
+
+	ActiveTagMask.Remove(Removed);
+
+	Removed.ForEachBit([this](int32 Bit)
+	{
+		ActiveGameplayTags.RemoveTag(TagsByBit[Bit]);
+	});
 }
 
 // Called when the game starts
@@ -167,6 +329,24 @@ void UMechanicsComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
+	MechanicsSubsystem = GetWorld()->GetSubsystem<UMechanicsSubsystem>();
+
+	OwnerState.Character = Cast<AParkourCharacter>(GetOwner());
+	if (OwnerState.Character)
+	{
+		OwnerState.AnimInstance = Cast<UPAnimInstance>(OwnerState.Character->GetMesh()->GetAnimInstance());
+
+		// Mechanics change movement settings, so they have to tick before this frame's move
+		if (MechanicsSubsystem)
+		{
+			MechanicsSubsystem->AddMovementPrerequisite(OwnerState.Character->GetCharacterMovement());
+		}
+
+		OwnerState.Character->GetCapsuleComponent()->OnComponentHit.AddDynamic(this, &UMechanicsComponent::OnOwnerHit);
+	}
+
+	CompileComponentTags();
+
 	for (int i = 0; i < StartingMechanics.Num(); i++)
 	{
 		AddMechanic(GetOwner(), StartingMechanics[i], true);
@@ -176,27 +356,51 @@ void UMechanicsComponent::BeginPlay()
 
 void UMechanicsComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	TArray<UBaseMechanic*> TempMechanics = Mechanics;
-	for (int i = 0; i < TempMechanics.Num(); i++)
+	if (MechanicsSubsystem)
 	{
-		if (Mechanics[i] && Mechanics[i]->GetIsRunning())
+		for (int32 Index = 0; Index < Mechanics.Num(); Index++)
+		{
+			const FMechanicContext Context = MechanicsSubsystem->GetContext(MechanicStates[Index]);
+			if (Context.IsValid() && Context.IsRunning())
+			{
+				Mechanics[Index]->StopMechanic(Context);
+			}
+		}
+
+		// Some mechanics refuse to stop (e.g. sliding mid air), their state goes either way
+		for (const FMechanicStateHandle& Handle : MechanicStates)
 		{
-			Mechanics[i]->StopMechanic(GetOwner());
+			MechanicsSubsystem->RemoveMechanicState(Handle);
 		}
+
+		if (OwnerState.Character)
+		{
+			MechanicsSubsystem->RemoveMovementPrerequisite(OwnerState.Character->GetCharacterMovement());
+		}
+	}
+
+	if (OwnerState.Character)
+	{
+		OwnerState.Character->GetCapsuleComponent()->OnComponentHit.RemoveDynamic(this, &UMechanicsComponent::OnOwnerHit);
 	}
 
+	Mechanics.Reset();
+	MechanicStates.Reset();
+	RebuildMechanicLookups();
+
 	Super::EndPlay(EndPlayReason);
 }
 
-
-// Called every frame
-void UMechanicsComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+#if WITH_EDITOR
+void UMechanicsComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	Super::PostEditChangeProperty(PropertyChangedEvent);
 
-	for (int i = 0; i < Mechanics.Num(); i++)
+	// Before play the tags are compiled in BeginPlay
+	if (HasBegunPlay() && PropertyChangedEvent.GetMemberPropertyName() == GET_MEMBER_NAME_CHECKED(UMechanicsComponent, BlockedGameplayTags))
 	{
-		Mechanics[i]->TickMechanic_Implementation(DeltaTime);
+		BlockedTagMask = CompileTags(BlockedGameplayTags);
 	}
 }
+#endif
 
@@ -5,11 +5,26 @@
 #include "CoreMinimal.h"
 #include "GameplayTagContainer.h"
 #include "Components/ActorComponent.h"
+#include "MechanicTagMask.h"
+#include "MechanicsSubsystem.h"
 #include "MechanicsComponent.generated.h"
 
 // player class
 class AParkourCharacter;
 class UBaseMechanic;
+class UPAnimInstance;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnMechanicStarted, FGameplayTag);
+
+// What every mechanic needs from its character, looked up once per character rather than by each mechanic
+USTRUCT()
+struct FMechanicOwnerState
+{
+	GENERATED_BODY()
+
+	UPROPERTY() AParkourCharacter* Character = nullptr;
+	UPROPERTY() UPAnimInstance* AnimInstance = nullptr;
+};
 
 // component which will contain all UObjects related to game mechanics
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
@@ -24,13 +39,45 @@ public:
 	// Get component from Actor
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Mechanics") static UMechanicsComponent* GetMechanicsComponent(AActor* GetActor);
 
-	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "GameplayTags") FGameplayTagContainer& GetActiveTags();
+	// Container view of the active tags, change them through AddActiveTags and RemoveActiveTags
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "GameplayTags") const FGameplayTagContainer& GetActiveTags() const;
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "GameplayTags") FGameplayTagContainer GetBlockedTags();
+
+	// Change the blocked tags through these so the blocked mask is compiled again
+	UFUNCTION(BlueprintCallable, Category = "GameplayTags") void SetBlockedTags(const FGameplayTagContainer& Tags);
+	UFUNCTION(BlueprintCallable, Category = "GameplayTags") void AddBlockedTags(const FGameplayTagContainer& Tags);
+	UFUNCTION(BlueprintCallable, Category = "GameplayTags") void RemoveBlockedTags(const FGameplayTagContainer& Tags);
 	FGameplayTag& GetMasterBlockedTag();
 
+	// Mechanics are the class defaults shared by every character, this character's state for one lives in the
+	// mechanics subsystem. The context is only good until a mechanic is next added or removed.
+	FMechanicContext GetMechanicContext(const UBaseMechanic* Mechanic) const;
+
+	// Stands in for the running flag mechanics used to keep themselves
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Mechanics") bool IsMechanicRunning(const UBaseMechanic* Mechanic) const;
+
+	// Called by the subsystem when it moves one of this character's states to fill a hole
+	void OnMechanicStateMoved(const FMechanicStateHandle& From, int32 NewIndex);
+
 	// Get a mechanic from given mechanic class
 	UFUNCTION(BlueprintCallable, Category = "Mechanics") UBaseMechanic* GetMechanic(TSubclassOf<UBaseMechanic> Mechanic);
 
+	// Get the mechanic registered under a tag
+	UFUNCTION(BlueprintCallable, Category = "Mechanics") UBaseMechanic* FindMechanic(FGameplayTag MechanicTag) const;
+
+	// Typed lookups, fetch once and keep the pointer, OnMechanicsChanged says when to fetch again
+	template <class T>
+	T* GetMechanic() const
+	{
+		return Cast<T>(MechanicsByClass.FindRef(T::StaticClass()));
+	}
+
+	template <class T>
+	T* FindMechanic(FGameplayTag MechanicTag) const
+	{
+		return Cast<T>(FindMechanic(MechanicTag));
+	}
+
 	// Adds an action to the component
 	UFUNCTION(BlueprintCallable, Category = "GameplayTags") void AddMechanic(AActor* Actor, TSubclassOf<UBaseMechanic> Mechanic, bool bAutoAdded = false);
 
@@ -41,8 +88,29 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "Mechanics") bool StopMechanic(AActor* Actor, FGameplayTag MechanicTag);
 
+	// Same as the tag versions for callers that already hold the mechanic
+	bool StartMechanicInstance(AActor* Actor, UBaseMechanic* Mechanic);
+	bool StopMechanicInstance(AActor* Actor, UBaseMechanic* Mechanic);
+
 	bool DoesTagExist(FGameplayTag Tag);
 
+	// Gives each tag a bit if it doesn't have one yet and returns the tags as a mask
+	FMechanicTagMask CompileTags(const FGameplayTagContainer& Tags);
+
+	// Whether any of the tags are active, the mask form of GetActiveTags().HasAnyExact
+	FORCEINLINE bool HasAnyActiveTags(const FMechanicTagMask& Tags) const { return ActiveTagMask.HasAny(Tags); }
+
+	void AddActiveTags(const FMechanicTagMask& Tags);
+	void RemoveActiveTags(const FMechanicTagMask& Tags);
+
+	FORCEINLINE const FMechanicOwnerState& GetOwnerState() const { return OwnerState; }
+
+	// Broadcast with the mechanic's tag whenever one starts, used by the playthrough bot to count activations
+	FOnMechanicStarted OnMechanicStarted;
+
+	// Broadcast after a mechanic is added or removed, cached mechanic pointers should be fetched again
+	FSimpleMulticastDelegate OnMechanicsChanged;
+
 protected:
 
 	// Called when the game starts
@@ -50,19 +118,41 @@ protected:
 
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+#if WITH_EDITOR
+	// Picks up blocked tags edited in the details panel during play
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 	// Array of actions available from the start of play
 	UPROPERTY(EditAnywhere, Category = "Mechanics") TArray<TSubclassOf<UBaseMechanic>> StartingMechanics;
 
-	// add array of all mechanics
-	UPROPERTY(BlueprintReadWrite, Category = "Mechanics") TArray<UBaseMechanic*> Mechanics;
+	// add array of all mechanics, the class defaults, with where each one's state lives at the same index
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Mechanics") TArray<UBaseMechanic*> Mechanics;
+	TArray<FMechanicStateHandle> MechanicStates;
+
+	// Lookups over Mechanics, kept up to date by AddMechanic and RemoveMechanic. A mechanic is also
+	// registered under each of its parent classes, the first one added wins like the old linear search.
+	UPROPERTY(Transient) TMap<FGameplayTag, UBaseMechanic*> MechanicsByTag;
+	UPROPERTY(Transient) TMap<UClass*, UBaseMechanic*> MechanicsByClass;
+
+	UPROPERTY(Transient) FMechanicOwnerState OwnerState;
+
+	// Ticks the mechanics of every character in the world, the component itself never ticks
+	UPROPERTY(Transient) UMechanicsSubsystem* MechanicsSubsystem;
+
+	void RegisterMechanic(UBaseMechanic* Mechanic);
+	void RebuildMechanicLookups();
+
+	// Hands the capsule's hits to every mechanic, the definitions can't bind to each character themselves
+	UFUNCTION() void OnOwnerHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
 	/* ---------------------------------  Gameplay Tags --------------------------------- */
 
-	// gameplay tags to determine when actions are blocked.
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gameplay Tags") FGameplayTagContainer BlockedGameplayTags;
+	// gameplay tags to determine when actions are blocked, kept in step with BlockedTagMask
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Gameplay Tags") FGameplayTagContainer BlockedGameplayTags;
 
-	// current active gameplay tags
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gameplay Tags") FGameplayTagContainer ActiveGameplayTags;
+	// current active gameplay tags, kept in step with ActiveTagMask
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Gameplay Tags") FGameplayTagContainer ActiveGameplayTags;
 
 	// list of tags to determine if a mechanic can play
 	UPROPERTY(EditDefaultsOnly, Category = "Gameplay Tags")
@@ -72,9 +162,13 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Gameplay Tags")
 	FGameplayTag MasterBlockTag;
 
-public:	
-	// Called every frame
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	// Bit given to each compiled tag and the tag behind each bit
+	TMap<FGameplayTag, int32> TagBits;
+	TArray<FGameplayTag> TagsByBit;
+
+	FMechanicTagMask ActiveTagMask;
+	FMechanicTagMask BlockedTagMask;
 
-	
+	// Compiles the tags set up on the component, done before any mechanic is added
+	void CompileComponentTags();
 };
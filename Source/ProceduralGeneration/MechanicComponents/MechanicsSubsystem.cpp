@@ -0,0 +1,279 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MechanicsSubsystem.h"
+
+#include "MechanicsComponent.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "ProceduralGeneration/Mechanics/BaseMechanic.h"
+#include "ProceduralGeneration/ProcGenMemory.h"
+#include "ProceduralGeneration/ProcGenTrace.h"
+
+FMechanicContext FMechanicStateBatch::GetContext(int32 Index)
+{
+	FMechanicContext Context;
+	Context.Component = Owners[Index];
+	Context.Character = Context.Component->GetOwnerState().Character;
+	Context.AnimInstance = Context.Component->GetOwnerState().AnimInstance;
+	Context.Batch = this;
+	Context.Index = Index;
+	return Context;
+}
+
+int32 FMechanicStateBatch::Add(UMechanicsComponent* Owner)
+{
+	const int32 Index = Owners.Add(Owner);
+	GivenTagMasks.AddDefaulted();
+	BlockedTagMasks.AddDefaulted();
+	Running.Add(false);
+	Ticking.Add(false);
+	TimeSinceTick.Add(0.0f);
+	TickDeltaTime.Add(0.0f);
+
+	if (StateStruct)
+	{
+		StateMemory.AddUninitialized(StateStride);
+		StateStruct->InitializeStruct(GetStateMemory(Index));
+	}
+	return Index;
+}
+
+int32 FMechanicStateBatch::RemoveAtSwap(int32 Index)
+{
+	const int32 LastIndex = Num() - 1;
+
+	Owners.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	GivenTagMasks.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	BlockedTagMasks.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Running.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Ticking.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	TimeSinceTick.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	TickDeltaTime.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	if (StateStruct)
+	{
+		// Structs are relocated bitwise, the same as TArray does with them
+		StateStruct->DestroyStruct(GetStateMemory(Index));
+		if (Index != LastIndex)
+		{
+			FMemory::Memcpy(GetStateMemory(Index), GetStateMemory(LastIndex), StateStride);
+		}
+		StateMemory.SetNum(LastIndex * StateStride, EAllowShrinking::No);
+	}
+	return LastIndex;
+}
+
+void FMechanicStateBatch::Empty()
+{
+	if (StateStruct)
+	{
+		for (int32 Index = 0; Index < Num(); Index++)
+		{
+			StateStruct->DestroyStruct(GetStateMemory(Index));
+		}
+	}
+
+	Owners.Empty();
+	GivenTagMasks.Empty();
+	BlockedTagMasks.Empty();
+	Running.Empty();
+	Ticking.Empty();
+	TimeSinceTick.Empty();
+	TickDeltaTime.Empty();
+	StateMemory.Empty();
+	DueIndices.Empty();
+	NumTicking = 0;
+}
+
+void FMechanicsTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Subsystem)
+	{
+		Subsystem->TickMechanics(DeltaTime);
+	}
+}
+
+FString FMechanicsTickFunction::DiagnosticMessage()
+{
+	return TEXT("UMechanicsSubsystem::TickMechanics");
+}
+
+void UMechanicsSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	TickFunction.TickGroup = TG_PrePhysics;
+	TickFunction.bCanEverTick = true;
+	TickFunction.Subsystem = this;
+	TickFunction.RegisterTickFunction(InWorld.PersistentLevel);
+	TickFunction.SetTickFunctionEnable(NumTickingMechanics > 0);
+}
+
+void UMechanicsSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+	TickFunction.Subsystem = nullptr;
+
+	for (FMechanicStateBatch& Batch : Batches)
+	{
+		Batch.Empty();
+	}
+	NumTickingMechanics = 0;
+
+	Super::Deinitialize();
+}
+
+void UMechanicsSubsystem::AddMovementPrerequisite(UActorComponent* MovementComponent)
+{
+	if (MovementComponent)
+	{
+		MovementComponent->PrimaryComponentTick.AddPrerequisite(this, TickFunction);
+	}
+}
+
+void UMechanicsSubsystem::RemoveMovementPrerequisite(UActorComponent* MovementComponent)
+{
+	if (MovementComponent)
+	{
+		MovementComponent->PrimaryComponentTick.RemovePrerequisite(this, TickFunction);
+	}
+}
+
+void UMechanicsSubsystem::TickMechanics(float DeltaTime)
+{
+	PROCGEN_TRACE_SCOPE(MechanicsSubsystem_Tick);
+
+	LLM_SCOPE_BYTAG(ProcGen_Mechanics);
+	PROCGEN_ALLOC_AUDIT_SCOPE(UMechanicsSubsystem_Tick);
+
+	// Mechanics start and stop each other while ticking, which only flips rows in other batches, rows are
+	// never added or removed from inside a tick
+	for (FMechanicStateBatch& Batch : Batches)
+	{
+		if (Batch.NumTicking == 0)
+		{
+			continue;
+		}
+
+		Batch.DueIndices.Reset();
+		for (int32 Index = 0; Index < Batch.Num(); Index++)
+		{
+			if (!Batch.Ticking[Index])
+			{
+				continue;
+			}
+
+			if (!IsValid(Batch.Owners[Index]))
+			{
+				SetTicking(Batch, Index, false);
+				continue;
+			}
+
+			Batch.TimeSinceTick[Index] += DeltaTime;
+			if (Batch.TimeSinceTick[Index] >= Batch.TickInterval)
+			{
+				Batch.TickDeltaTime[Index] = Batch.TimeSinceTick[Index];
+				Batch.TimeSinceTick[Index] = 0.0f;
+				Batch.DueIndices.Add(Index);
+			}
+		}
+
+		if (!Batch.DueIndices.IsEmpty())
+		{
+			Batch.Definition->TickStates(Batch, Batch.DueIndices);
+		}
+	}
+}
+
+bool UMechanicsSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+FMechanicStateHandle UMechanicsSubsystem::AddMechanicState(UMechanicsComponent* Owner, UBaseMechanic* Definition)
+{
+	check(Definition && Definition->HasAnyFlags(RF_ClassDefaultObject));
+
+	FMechanicStateHandle Handle;
+	Handle.Batch = Batches.IndexOfByPredicate([Definition](const FMechanicStateBatch& Existing)
+	{
+		return Existing.Definition == Definition;
+	});
+
+	if (Handle.Batch == INDEX_NONE)
+	{
+		Handle.Batch = Batches.AddDefaulted();
+
+		FMechanicStateBatch& Batch = Batches[Handle.Batch];
+		Batch.Definition = Definition;
+		Batch.Subsystem = this;
+		Batch.TickInterval = Definition->TickInterval;
+		Batch.StateStruct = Definition->GetStateStruct();
+		if (Batch.StateStruct)
+		{
+			// The memory comes from FMemory::Malloc, which aligns to 16
+			check(Batch.StateStruct->GetMinAlignment() <= 16);
+			Batch.StateStride = Align(Batch.StateStruct->GetStructureSize(), Batch.StateStruct->GetMinAlignment());
+		}
+	}
+
+	Handle.Index = Batches[Handle.Batch].Add(Owner);
+	return Handle;
+}
+
+void UMechanicsSubsystem::RemoveMechanicState(const FMechanicStateHandle& Handle)
+{
+	// Rows are already gone if the world tore the subsystem down first
+	if (!Batches.IsValidIndex(Handle.Batch) || !Batches[Handle.Batch].Owners.IsValidIndex(Handle.Index))
+	{
+		return;
+	}
+
+	FMechanicStateBatch& Batch = Batches[Handle.Batch];
+	SetTicking(Batch, Handle.Index, false);
+
+	const int32 MovedFrom = Batch.RemoveAtSwap(Handle.Index);
+	if (MovedFrom != Handle.Index && Batch.Owners[Handle.Index])
+	{
+		Batch.Owners[Handle.Index]->OnMechanicStateMoved(FMechanicStateHandle{ Handle.Batch, MovedFrom }, Handle.Index);
+	}
+}
+
+FMechanicContext UMechanicsSubsystem::GetContext(const FMechanicStateHandle& Handle)
+{
+	if (!Batches.IsValidIndex(Handle.Batch) || !Batches[Handle.Batch].Owners.IsValidIndex(Handle.Index))
+	{
+		return FMechanicContext();
+	}
+	return Batches[Handle.Batch].GetContext(Handle.Index);
+}
+
+void UMechanicsSubsystem::SetTicking(FMechanicStateBatch& Batch, int32 Index, bool bTick)
+{
+	if (Batch.Ticking[Index] == bTick)
+	{
+		return;
+	}
+
+	Batch.Ticking[Index] = bTick;
+	if (bTick)
+	{
+		Batch.TimeSinceTick[Index] = 0.0f;
+		Batch.NumTicking++;
+		if (NumTickingMechanics++ == 0)
+		{
+			TickFunction.SetTickFunctionEnable(true);
+		}
+	}
+	else
+	{
+		Batch.NumTicking--;
+		if (--NumTickingMechanics == 0)
+		{
+			TickFunction.SetTickFunctionEnable(false);
+		}
+	}
+}
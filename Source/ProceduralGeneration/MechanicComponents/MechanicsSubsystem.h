@@ -0,0 +1,189 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "MechanicTagMask.h"
+#include "MechanicsSubsystem.generated.h"
+
+class AParkourCharacter;
+class UBaseMechanic;
+class UMechanicsComponent;
+class UMechanicsSubsystem;
+class UPAnimInstance;
+struct FMechanicStateBatch;
+
+// Where one character's state for one mechanic lives, kept up to date by the subsystem as states move
+struct FMechanicStateHandle
+{
+	int32 Batch = INDEX_NONE;
+	int32 Index = INDEX_NONE;
+
+	FORCEINLINE bool IsValid() const { return Batch != INDEX_NONE; }
+	FORCEINLINE bool operator==(const FMechanicStateHandle& Other) const { return Batch == Other.Batch && Index == Other.Index; }
+};
+
+/**
+ * One character's view of a mechanic, handed to the shared definition for everything it does to that
+ * character. Only good for the call it is passed to, adding or removing mechanics can move the state.
+ */
+struct PROCEDURALGENERATION_API FMechanicContext
+{
+	UMechanicsComponent* Component = nullptr;
+	AParkourCharacter* Character = nullptr;
+	UPAnimInstance* AnimInstance = nullptr;
+
+	FMechanicStateBatch* Batch = nullptr;
+	int32 Index = INDEX_NONE;
+
+	FORCEINLINE bool IsValid() const { return Batch != nullptr; }
+
+	// The definition's own state struct for this character
+	template <typename StateType>
+	StateType& GetState() const;
+
+	bool IsRunning() const;
+	bool IsTicking() const;
+	const FMechanicTagMask& GetGivenTags() const;
+	const FMechanicTagMask& GetBlockedTags() const;
+};
+
+/**
+ * Every character's state for one mechanic class, a column per field. The class default object is the
+ * definition all of them share, and the definition's state struct is one more column laid out back to back
+ * in StateMemory. Entries are swapped out on removal, the subsystem tells the owner when one moves.
+ */
+USTRUCT()
+struct PROCEDURALGENERATION_API FMechanicStateBatch
+{
+	GENERATED_BODY()
+
+	UPROPERTY() UBaseMechanic* Definition = nullptr;
+
+	UPROPERTY() TArray<UMechanicsComponent*> Owners;
+	TArray<FMechanicTagMask> GivenTagMasks;
+	TArray<FMechanicTagMask> BlockedTagMasks;
+	TArray<bool> Running;
+	TArray<bool> Ticking;
+	TArray<float> TimeSinceTick;
+
+	// Time since each character's last tick, filled in for the characters due this frame
+	TArray<float> TickDeltaTime;
+
+	// Null for mechanics without state of their own
+	const UScriptStruct* StateStruct = nullptr;
+	int32 StateStride = 0;
+	TArray<uint8> StateMemory;
+
+	// Read once from the definition, every character shares it
+	float TickInterval = 0.0f;
+	int32 NumTicking = 0;
+
+	// Characters due a tick this frame, kept between frames so ticking doesn't allocate
+	TArray<int32> DueIndices;
+
+	UMechanicsSubsystem* Subsystem = nullptr;
+
+	FORCEINLINE int32 Num() const { return Owners.Num(); }
+
+	FORCEINLINE void* GetStateMemory(int32 Index) { return StateMemory.GetData() + Index * StateStride; }
+
+	template <typename StateType>
+	FORCEINLINE StateType& GetState(int32 Index)
+	{
+		checkSlow(StateStruct && StateStruct->IsChildOf(StateType::StaticStruct()));
+		return *static_cast<StateType*>(GetStateMemory(Index));
+	}
+
+	FMechanicContext GetContext(int32 Index);
+
+	int32 Add(UMechanicsComponent* Owner);
+
+	// Moves the last entry into the hole, returns the index it came from
+	int32 RemoveAtSwap(int32 Index);
+
+	// Destroys every state struct, only the subsystem going away calls this
+	void Empty();
+};
+
+// Rows own raw state memory, so the batch is never copied
+template <>
+struct TStructOpsTypeTraits<FMechanicStateBatch> : public TStructOpsTypeTraitsBase2<FMechanicStateBatch>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+template <typename StateType>
+FORCEINLINE StateType& FMechanicContext::GetState() const
+{
+	return Batch->GetState<StateType>(Index);
+}
+
+FORCEINLINE bool FMechanicContext::IsRunning() const { return Batch->Running[Index]; }
+FORCEINLINE bool FMechanicContext::IsTicking() const { return Batch->Ticking[Index]; }
+FORCEINLINE const FMechanicTagMask& FMechanicContext::GetGivenTags() const { return Batch->GivenTagMasks[Index]; }
+FORCEINLINE const FMechanicTagMask& FMechanicContext::GetBlockedTags() const { return Batch->BlockedTagMasks[Index]; }
+
+// Pre-physics tick for the subsystem, mechanics components make their owner's movement depend on it
+struct FMechanicsTickFunction : public FTickFunction
+{
+	UMechanicsSubsystem* Subsystem = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+/**
+ * Holds and ticks the mechanics of every character in the world. A mechanic class is defined once by its
+ * class default object, which holds the tunables, curves and montages, and each character only adds a row
+ * to that class's batch with its timers, flags and timeline positions. Adding a mechanic to a character
+ * creates no UObject.
+ *
+ * The tick makes one call per mechanic class with every character due a tick, so each mechanic's tick runs
+ * over all agents back to back. A row only ticks while its mechanic wants it to and the subsystem doesn't
+ * tick at all when none do.
+ *
+ * The tick runs in TG_PrePhysics ahead of each registered character's movement, same as the component ticks
+ * it replaced, so mechanics still change movement settings before the move that uses them.
+ */
+UCLASS()
+class PROCEDURALGENERATION_API UMechanicsSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	void TickMechanics(float DeltaTime);
+
+	// Makes the movement component wait for this frame's mechanics tick
+	void AddMovementPrerequisite(UActorComponent* MovementComponent);
+	void RemoveMovementPrerequisite(UActorComponent* MovementComponent);
+
+	// Adds a row for the character to the batch of the definition's class
+	FMechanicStateHandle AddMechanicState(UMechanicsComponent* Owner, UBaseMechanic* Definition);
+	void RemoveMechanicState(const FMechanicStateHandle& Handle);
+
+	FMechanicContext GetContext(const FMechanicStateHandle& Handle);
+
+	// Rows are dropped on the first tick their mechanic no longer wants ticking
+	void SetTicking(FMechanicStateBatch& Batch, int32 Index, bool bTick);
+
+	FORCEINLINE int32 GetNumTickingMechanics() const { return NumTickingMechanics; }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// Batch indices are handed out in handles, so batches are only ever added
+	UPROPERTY() TArray<FMechanicStateBatch> Batches;
+
+	FMechanicsTickFunction TickFunction;
+
+	int32 NumTickingMechanics = 0;
+};
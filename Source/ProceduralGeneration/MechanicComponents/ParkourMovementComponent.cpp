@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourMovementComponent.h"
+
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/Character.h"
+#include "ProceduralGeneration/ProcGenTrace.h"
+
+float UParkourMovementComponent::GetMaxSpeed() const
+{
+	// Both modes are paced by the walk speed the movement states and mechanics already set
+	if (MovementMode == MOVE_Custom)
+	{
+		return MaxWalkSpeed;
+	}
+	return Super::GetMaxSpeed();
+}
+
+bool UParkourMovementComponent::IsMovingOnGround() const
+{
+	return Super::IsMovingOnGround() || IsCustomMovementMode(CMOVE_Slide);
+}
+
+void UParkourMovementComponent::StartWallRun(const FVector& Direction)
+{
+	SetWallRunDirection(Direction);
+	PendingWallRunRise = 0.f;
+	Velocity.Z = 0.f;
+	SetMovementMode(MOVE_Custom, CMOVE_WallRun);
+}
+
+void UParkourMovementComponent::StopWallRun()
+{
+	PendingWallRunRise = 0.f;
+	if (IsCustomMovementMode(CMOVE_WallRun))
+	{
+		SetMovementMode(MOVE_Falling);
+	}
+}
+
+void UParkourMovementComponent::StartSlide()
+{
+	PendingSlideBoost = 0.f;
+	if (IsMovingOnGround())
+	{
+		SetMovementMode(MOVE_Custom, CMOVE_Slide);
+	}
+}
+
+void UParkourMovementComponent::StopSlide()
+{
+	PendingSlideBoost = 0.f;
+	if (IsCustomMovementMode(CMOVE_Slide))
+	{
+		SetMovementMode(MOVE_Walking);
+	}
+}
+
+void UParkourMovementComponent::RequestCapsuleRadius(float Radius)
+{
+	if (!bHasPendingCapsuleSize && CharacterOwner)
+	{
+		PendingCapsuleSize.Y = CharacterOwner->GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight();
+	}
+	PendingCapsuleSize.X = Radius;
+	bHasPendingCapsuleSize = true;
+}
+
+void UParkourMovementComponent::RequestCapsuleHalfHeight(float HalfHeight)
+{
+	if (!bHasPendingCapsuleSize && CharacterOwner)
+	{
+		PendingCapsuleSize.X = CharacterOwner->GetCapsuleComponent()->GetUnscaledCapsuleRadius();
+	}
+	PendingCapsuleSize.Y = HalfHeight;
+	bHasPendingCapsuleSize = true;
+}
+
+void UParkourMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	if (bHasPendingCapsuleSize && CharacterOwner)
+	{
+		CharacterOwner->GetCapsuleComponent()->SetCapsuleSize(PendingCapsuleSize.X, PendingCapsuleSize.Y, false);
+		bHasPendingCapsuleSize = false;
+	}
+}
+
+void UParkourMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
+{
+	Super::PhysCustom(deltaTime, Iterations);
+
+	switch (CustomMovementMode)
+	{
+	case CMOVE_WallRun:
+		PhysWallRun(deltaTime, Iterations);
+		break;
+	case CMOVE_Slide:
+		PhysSlide(deltaTime, Iterations);
+		break;
+	default:
+		break;
+	}
+}
+
+void UParkourMovementComponent::PhysWallRun(float deltaTime, int32 Iterations)
+{
+	PROCGEN_TRACE_SCOPE(ParkourMovement_PhysWallRun);
+
+	if (deltaTime < MIN_TICK_TIME)
+	{
+		return;
+	}
+
+	float RemainingTime = deltaTime;
+	while (RemainingTime >= MIN_TICK_TIME && Iterations < MaxSimulationIterations)
+	{
+		Iterations++;
+		const float TimeTick = GetSimulationTimeStep(RemainingTime, Iterations);
+		RemainingTime -= TimeTick;
+
+		// Along the wall at walk speed, gravity only pulls when the wall run scales it in
+		const float VerticalSpeed = Velocity.Z + GetGravityZ() * TimeTick;
+		Velocity = WallRunDirection * GetMaxSpeed();
+		Velocity.Z = VerticalSpeed;
+
+		const float Rise = PendingWallRunRise * (TimeTick / deltaTime);
+		const FVector Delta = Velocity * TimeTick + FVector(0.f, 0.f, Rise);
+
+		// Turn to face along the wall in the same move
+		const FRotator CurrentRotation = UpdatedComponent->GetComponentRotation();
+		const FRotator TargetRotation(CurrentRotation.Pitch, WallRunDirection.Rotation().Yaw, CurrentRotation.Roll);
+		const FQuat NewRotation = FMath::RInterpTo(CurrentRotation, TargetRotation, TimeTick, WallRunRotationSpeed).Quaternion();
+
+		FHitResult Hit(1.f);
+		SafeMoveUpdatedComponent(Delta, NewRotation, true, Hit);
+		if (Hit.Time < 1.f)
+		{
+			HandleImpact(Hit, TimeTick, Delta);
+			SlideAlongSurface(Delta, 1.f - Hit.Time, Hit.Normal, Hit, true);
+		}
+	}
+
+	PendingWallRunRise = 0.f;
+}
+
+void UParkourMovementComponent::PhysSlide(float deltaTime, int32 Iterations)
+{
+	PROCGEN_TRACE_SCOPE(ParkourMovement_PhysSlide);
+
+	if (deltaTime < MIN_TICK_TIME)
+	{
+		return;
+	}
+
+	float RemainingTime = deltaTime;
+	while (RemainingTime >= MIN_TICK_TIME && Iterations < MaxSimulationIterations)
+	{
+		Iterations++;
+		const float TimeTick = GetSimulationTimeStep(RemainingTime, Iterations);
+		RemainingTime -= TimeTick;
+
+		const FVector FloorNormal = CurrentFloor.HitResult.ImpactNormal;
+
+		// Boost first so the friction and slope below act on it like any other speed
+		Velocity += Velocity.GetSafeNormal2D() * PendingSlideBoost;
+		PendingSlideBoost = 0.f;
+
+		// Gravity along the floor speeds the slide up downhill and slows it uphill
+		Velocity += FVector::VectorPlaneProject(FVector(0.f, 0.f, GetGravityZ()), FloorNormal) * TimeTick;
+		Velocity -= Velocity * FMath::Min(SlideFriction * TimeTick, 1.f);
+		Velocity = FVector::VectorPlaneProject(Velocity, FloorNormal).GetClampedToMaxSize(GetMaxSpeed());
+
+		const FVector Delta = Velocity * TimeTick;
+		FHitResult Hit(1.f);
+		SafeMoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), true, Hit);
+		if (Hit.Time < 1.f)
+		{
+			HandleImpact(Hit, TimeTick, Delta);
+			SlideAlongSurface(Delta, 1.f - Hit.Time, Hit.Normal, Hit, true);
+		}
+
+		// Off an edge the slide becomes a fall, too slow and it becomes a walk
+		FindFloor(UpdatedComponent->GetComponentLocation(), CurrentFloor, false);
+		if (!CurrentFloor.IsWalkableFloor())
+		{
+			SetMovementMode(MOVE_Falling);
+			StartNewPhysics(RemainingTime, Iterations);
+			return;
+		}
+
+		AdjustFloorHeight();
+		SetBase(CurrentFloor.HitResult.Component.Get(), CurrentFloor.HitResult.BoneName);
+
+		if (Velocity.SizeSquared() < FMath::Square(MinSlideSpeed))
+		{
+			SetMovementMode(MOVE_Walking);
+			StartNewPhysics(RemainingTime, Iterations);
+			return;
+		}
+	}
+}
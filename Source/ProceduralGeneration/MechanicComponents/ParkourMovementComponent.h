@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "ParkourMovementComponent.generated.h"
+
+UENUM(BlueprintType)
+enum ECustomMovementMode
+{
+	CMOVE_None UMETA(Hidden),
+	CMOVE_WallRun UMETA(DisplayName = "Wall Run"),
+	CMOVE_Slide UMETA(DisplayName = "Slide"),
+	CMOVE_MAX UMETA(Hidden)
+};
+
+/**
+ * Character movement with native wall run and slide modes. The mechanics decide when to start and stop
+ * and feed in direction, rise and capsule size, the modes move the character with one sweep per substep
+ * instead of the mechanics offsetting the actor and overwriting velocity on their own.
+ */
+UCLASS()
+class PROCEDURALGENERATION_API UParkourMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	virtual float GetMaxSpeed() const override;
+	virtual bool IsMovingOnGround() const override;
+
+	FORCEINLINE bool IsCustomMovementMode(ECustomMovementMode Mode) const { return MovementMode == MOVE_Custom && CustomMovementMode == Mode; }
+
+	// Wall Running - Direction is along the wall, the mode keeps the character facing it
+	void StartWallRun(const FVector& Direction);
+	void StopWallRun();
+	FORCEINLINE void SetWallRunDirection(const FVector& Direction) { WallRunDirection = Direction.GetSafeNormal2D(); }
+	// Vertical offset for the next update, spread over its substeps
+	FORCEINLINE void AddWallRunRise(float DeltaZ) { PendingWallRunRise += DeltaZ; }
+
+	// Sliding
+	void StartSlide();
+	void StopSlide();
+	// Speed added along the slide direction on the next update
+	FORCEINLINE void AddSlideBoost(float Speed) { PendingSlideBoost += Speed; }
+
+	// Capsule changes are applied before the next move without their own overlap update, the move's sweep covers it
+	void RequestCapsuleRadius(float Radius);
+	void RequestCapsuleHalfHeight(float HalfHeight);
+
+protected:
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+	virtual void PhysCustom(float deltaTime, int32 Iterations) override;
+
+	void PhysWallRun(float deltaTime, int32 Iterations);
+	void PhysSlide(float deltaTime, int32 Iterations);
+
+	UPROPERTY(EditAnywhere, Category = "Character Movement: Wall Run") float WallRunRotationSpeed = 15.f;
+
+	// Braking applied while sliding, there is no input acceleration
+	UPROPERTY(EditAnywhere, Category = "Character Movement: Slide") float SlideFriction = 0.5f;
+	// Below this the slide drops back to walking
+	UPROPERTY(EditAnywhere, Category = "Character Movement: Slide") float MinSlideSpeed = 150.f;
+
+	FVector WallRunDirection = FVector::ForwardVector;
+	float PendingWallRunRise = 0.f;
+
+	float PendingSlideBoost = 0.f;
+
+	FVector2f PendingCapsuleSize = FVector2f::ZeroVector;
+	bool bHasPendingCapsuleSize = false;
+};
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourProbeSchedule.h"
+
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<float> CVarParkourProbeRate(
+	TEXT("p.Parkour.ProbeRate"),
+	30.f,
+	TEXT("Environment probes per second for the parkour mechanics, 0 probes every frame"),
+	ECVF_Default);
+
+bool FParkourProbeSchedule::Tick(float DeltaTime)
+{
+	const float Interval = GetInterval();
+	if (TimeSinceProbe != TNumericLimits<float>::Max())
+	{
+		TimeSinceProbe += DeltaTime;
+	}
+
+	if (TimeSinceProbe < Interval)
+	{
+		return false;
+	}
+
+	// Carry the remainder so the rate holds when it doesn't divide the frame time, but never more than
+	// one interval so a hitch doesn't turn into a burst of probes
+	TimeSinceProbe = TimeSinceProbe == TNumericLimits<float>::Max() ? 0.f : FMath::Min(TimeSinceProbe - Interval, Interval);
+	return true;
+}
+
+float FParkourProbeSchedule::GetInterval()
+{
+	const float Rate = CVarParkourProbeRate.GetValueOnGameThread();
+	return Rate > 0.f ? 1.f / Rate : 0.f;
+}
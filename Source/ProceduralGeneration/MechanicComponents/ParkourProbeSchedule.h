@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Runs environment probes at p.Parkour.ProbeRate instead of every rendered frame, so a character makes
+ * the same number of collision queries at 144 fps as at 30. Frames in between hold the last results.
+ */
+struct PROCEDURALGENERATION_API FParkourProbeSchedule
+{
+	// True when a probe is due, the first call after a reset always probes
+	bool Tick(float DeltaTime);
+
+	FORCEINLINE void Reset() { TimeSinceProbe = TNumericLimits<float>::Max(); }
+
+	// Seconds between probes, 0 when probing every frame
+	static float GetInterval();
+
+private:
+	float TimeSinceProbe = TNumericLimits<float>::Max();
+};
@@ -0,0 +1,366 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourSensingComponent.h"
+
+#include "DrawDebugHelpers.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "ProceduralGeneration/ParkourCharacter.h"
+#include "ProceduralGeneration/ParkourQueries.h"
+#include "ProceduralGeneration/ProcGenTrace.h"
+#include "Procedural Generation/GeneratedGeometry.h"
+
+// Height samples along the vault obstacle, SecondaryTraceGap apart
+static constexpr int32 NumVaultHeightTraces = 14;
+static constexpr float SenseSphereRadius = 10.f;
+
+UParkourSensingComponent::UParkourSensingComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+}
+
+void UParkourSensingComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Character = Cast<AParkourCharacter>(GetOwner());
+	GeneratedGeometry = GetWorld()->GetSubsystem<UGeneratedGeometrySubsystem>();
+	if (!Character)
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+void UParkourSensingComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	PROCGEN_TRACE_SCOPE(ParkourSensing_Tick);
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	TimeSincePass += DeltaTime;
+
+	// Each round's traces were issued last frame, their results are only kept for this one
+	switch (Stage)
+	{
+	case ESenseStage::Idle:
+		if (TimeSincePass >= SenseInterval && !Character->bIsPerformingAction)
+		{
+			BeginPass();
+		}
+		break;
+	case ESenseStage::Reach:
+		ProcessReach();
+		break;
+	case ESenseStage::Height:
+		ProcessHeight();
+		break;
+	case ESenseStage::Clearance:
+		ProcessClearance();
+		break;
+	}
+}
+
+const FSensedParkourActions* UParkourSensingComponent::GetSensedActions() const
+{
+	if (Sensed.Time < 0.0 || GetWorld()->GetTimeSeconds() - Sensed.Time > MaxSenseAge)
+	{
+		return nullptr;
+	}
+
+	// Running straight on keeps the targets ahead valid, turning or stepping sideways doesn't
+	const FVector Offset = Character->GetActorLocation() - Sensed.Location;
+	const FVector Lateral = FVector::VectorPlaneProject(Offset, Sensed.Forward);
+	if (Lateral.SizeSquared2D() > FMath::Square(MaxLateralDrift) || FVector::DotProduct(Character->GetActorForwardVector(), Sensed.Forward) < MinFacingDot)
+	{
+		return nullptr;
+	}
+
+	return &Sensed;
+}
+
+void UParkourSensingComponent::ConsumeSensedActions()
+{
+	Sensed = FSensedParkourActions();
+	AbortPass();
+}
+
+void UParkourSensingComponent::BeginPass()
+{
+	TimeSincePass = 0.f;
+
+	Pending = FSensedParkourActions();
+	Pending.Location = Character->GetActorLocation();
+	Pending.Forward = Character->GetActorForwardVector();
+	Pending.Time = GetWorld()->GetTimeSeconds();
+	bPendingFalling = Character->GetCharacterMovement()->IsFalling();
+
+	if (SenseLedges())
+	{
+		return;
+	}
+
+	// Something low enough to vault over, or anything at chest height to mantle onto
+	FVector Start = Pending.Location + FVector(0,0,-15);
+	VaultReachTrace = LineTrace(Start, Start + Pending.Forward * Character->InitialTraceLength + FVector(0,0,-15));
+
+	Start = Pending.Location + FVector(0,0,25.f);
+	MantleReachTrace = LineTrace(Start, Start + Pending.Forward * Character->MantleInitialTraceLength);
+
+	Stage = ESenseStage::Reach;
+}
+
+bool UParkourSensingComponent::SenseLedges()
+{
+	PROCGEN_TRACE_SCOPE(ParkourSensing_Ledges);
+
+	if (!GeneratedGeometry || GeneratedGeometry->GetLedges().Num() == 0)
+	{
+		return false;
+	}
+
+	FGeneratedLedge Ledge;
+	FVector Point;
+
+	// Same window the reach line and height sweeps cover, the first sample sits on the near edge
+	const float VaultReach = -15.f;
+	bool bVault = GeneratedGeometry->FindLedge(Pending.Location, Pending.Forward, Character->InitialTraceLength, VaultReach, VaultReach + Character->SecondaryTraceZOffset, SenseSphereRadius, Ledge, Point);
+	if (bVault)
+	{
+		// Samples SecondaryTraceGap apart run across the top until the first one past the far edge
+		const float TopDepth = Ledge.Depth / FMath::Max(-FVector::DotProduct(Pending.Forward.GetSafeNormal2D(), Ledge.Normal), UE_KINDA_SMALL_NUMBER);
+		const int32 LastOnTop = FMath::FloorToInt32(TopDepth / FMath::Max(Character->SecondaryTraceGap, 1.f));
+		bVault = LastOnTop < NumVaultHeightTraces - 1;
+
+		Pending.VaultStart = Point;
+		Pending.VaultMiddle = Point + Pending.Forward.GetSafeNormal2D() * LastOnTop * Character->SecondaryTraceGap;
+	}
+
+	const float MantleReach = 25.f;
+	const float MantleOffset = Character->MantleSecondaryTraceZOffset * (bPendingFalling ? Character->MantleFallHeightMultiplier : 1.0f);
+	const bool bMantle = GeneratedGeometry->FindLedge(Pending.Location, Pending.Forward, Character->MantleInitialTraceLength, MantleReach, MantleReach + MantleOffset, SenseSphereRadius, Ledge, Point);
+	if (bMantle)
+	{
+		Pending.MantlePosition1 = Point + (Pending.Forward * -50.f);
+		Pending.MantlePosition2 = Point + (Pending.Forward * 50.f);
+	}
+
+	if (!bVault && !bMantle)
+	{
+		return false;
+	}
+
+	IssueClearance(bVault, bMantle);
+	return true;
+}
+
+void UParkourSensingComponent::ProcessReach()
+{
+	FHitResult VaultReachHit;
+	const ETraceResult VaultReach = GetTraceResult(VaultReachTrace, VaultReachHit);
+
+	FHitResult MantleReachHit;
+	const ETraceResult MantleReach = GetTraceResult(MantleReachTrace, MantleReachHit);
+
+	const bool bVaultReach = VaultReach == ETraceResult::Hit;
+	const bool bMantleReach = MantleReach == ETraceResult::Hit;
+	if (VaultReach == ETraceResult::Unavailable || MantleReach == ETraceResult::Unavailable || (!bVaultReach && !bMantleReach))
+	{
+		AbortPass();
+		return;
+	}
+
+	// Sample the obstacle's height along its length, the first miss is its far side
+	VaultHeightTraces.Reset();
+	if (bVaultReach)
+	{
+		for (int32 i = 0; i < NumVaultHeightTraces; i++)
+		{
+			const FVector End = VaultReachHit.Location + Pending.Forward * i * Character->SecondaryTraceGap;
+			VaultHeightTraces.Add(SphereSweep(End + FVector(0,0,Character->SecondaryTraceZOffset), End, SenseSphereRadius));
+		}
+	}
+
+	// Top of the mantle ledge, a falling character can't reach as high
+	MantleHeightTrace = FTraceHandle();
+	if (bMantleReach)
+	{
+		const float Offset = Character->MantleSecondaryTraceZOffset * (bPendingFalling ? Character->MantleFallHeightMultiplier : 1.0f);
+		MantleHeightTrace = SphereSweep(MantleReachHit.Location + FVector(0,0,Offset), MantleReachHit.Location, SenseSphereRadius);
+	}
+
+	Stage = ESenseStage::Height;
+}
+
+void UParkourSensingComponent::ProcessHeight()
+{
+	int32 FirstMiss = INDEX_NONE;
+	FHitResult HeightHit;
+	for (int32 i = 0; i < VaultHeightTraces.Num(); i++)
+	{
+		const ETraceResult Result = GetTraceResult(VaultHeightTraces[i], HeightHit);
+		if (Result == ETraceResult::Unavailable)
+		{
+			AbortPass();
+			return;
+		}
+		if (Result == ETraceResult::Miss)
+		{
+			FirstMiss = i;
+			break;
+		}
+
+		if (i == 0)
+		{
+			Pending.VaultStart = HeightHit.ImpactPoint;
+		}
+		Pending.VaultMiddle = HeightHit.ImpactPoint;
+	}
+
+	FHitResult MantleHeightHit;
+	const ETraceResult MantleHeight = GetTraceResult(MantleHeightTrace, MantleHeightHit);
+	if (MantleHeight == ETraceResult::Unavailable)
+	{
+		AbortPass();
+		return;
+	}
+
+	const bool bMantle = MantleHeight == ETraceResult::Hit;
+	if (bMantle)
+	{
+		Pending.MantlePosition1 = MantleHeightHit.ImpactPoint + (Pending.Forward * -50.f);
+		Pending.MantlePosition2 = MantleHeightHit.ImpactPoint + (Pending.Forward * 50.f);
+	}
+
+	// Needs a top to vault from and a far side within reach
+	IssueClearance(FirstMiss > 0, bMantle);
+}
+
+void UParkourSensingComponent::IssueClearance(bool bVault, bool bMantle)
+{
+	VaultStartClearTrace = FTraceHandle();
+	VaultLandTrace = FTraceHandle();
+	VaultLandClearTrace = FTraceHandle();
+	MantleSpaceTrace = FTraceHandle();
+	MantleClearTrace = FTraceHandle();
+
+	if (bVault)
+	{
+		// Room above the start for the hands, and somewhere to land past the end of the reach line
+		VaultStartClearTrace = SphereSweep(Pending.VaultStart + FVector(0,0,50), Pending.VaultStart + FVector(0,0,20), SenseSphereRadius);
+
+		const FVector LandStart = Pending.Location + FVector(0,0,-30) + Pending.Forward * (Character->InitialTraceLength + Character->LandingPositionForwardOffset);
+		VaultLandTrace = LineTrace(LandStart, LandStart + FVector(0,0,-100));
+		VaultLandClearTrace = SphereSweep(LandStart, LandStart, SenseSphereRadius);
+	}
+
+	if (bMantle)
+	{
+		// Space for the player to climb up, then the path from the first warp point to the second
+		const FVector Ledge = (Pending.MantlePosition1 + Pending.MantlePosition2) * 0.5f;
+		const FVector SpaceCheck = Ledge + (Pending.Forward * 120.f) + FVector(0,0,20);
+		MantleSpaceTrace = SphereSweep(SpaceCheck, SpaceCheck, SenseSphereRadius);
+		const FVector ClearStart(Pending.MantlePosition1.X, Pending.MantlePosition1.Y, Pending.MantlePosition2.Z + 100);
+		MantleClearTrace = SphereSweep(ClearStart, Pending.MantlePosition2 + FVector(0,0,120), SenseSphereRadius);
+	}
+
+	if (!bVault && !bMantle)
+	{
+		AbortPass();
+		return;
+	}
+
+	Stage = ESenseStage::Clearance;
+}
+
+void UParkourSensingComponent::ProcessClearance()
+{
+	// Missing data must not read as open space, so the whole pass is dropped rather than guessed at
+	FHitResult Hit;
+	const ETraceResult VaultStartClear = GetTraceResult(VaultStartClearTrace, Hit);
+	const ETraceResult VaultLandClear = GetTraceResult(VaultLandClearTrace, Hit);
+	const ETraceResult MantleSpace = GetTraceResult(MantleSpaceTrace, Hit);
+	const ETraceResult MantleClear = GetTraceResult(MantleClearTrace, Hit);
+	FHitResult LandHit;
+	const ETraceResult VaultLand = GetTraceResult(VaultLandTrace, LandHit);
+
+	for (const ETraceResult Result : { VaultStartClear, VaultLandClear, VaultLand, MantleSpace, MantleClear })
+	{
+		if (Result == ETraceResult::Unavailable)
+		{
+			AbortPass();
+			return;
+		}
+	}
+
+	if (VaultLandTrace.IsValid() && VaultStartClear == ETraceResult::Miss && VaultLandClear == ETraceResult::Miss && VaultLand == ETraceResult::Hit)
+	{
+		Pending.VaultLand = LandHit.Location + FVector(0,0,-20.f);
+		Pending.bCanVault = true;
+	}
+
+	if (MantleClearTrace.IsValid() && MantleSpace == ETraceResult::Miss && MantleClear == ETraceResult::Miss)
+	{
+		Pending.bCanMantle = !Pending.MantlePosition1.IsZero() && !Pending.MantlePosition2.IsZero();
+	}
+
+	if (AParkourCharacter::IsDebugDrawEnabled())
+	{
+		if (Pending.bCanVault)
+		{
+			DrawDebugSphere(GetWorld(), Pending.VaultStart, SenseSphereRadius, 12, FColor::Green, false, SenseInterval);
+			DrawDebugSphere(GetWorld(), Pending.VaultMiddle, SenseSphereRadius, 12, FColor::Yellow, false, SenseInterval);
+			DrawDebugSphere(GetWorld(), Pending.VaultLand, SenseSphereRadius, 12, FColor::Red, false, SenseInterval);
+		}
+		if (Pending.bCanMantle)
+		{
+			DrawDebugSphere(GetWorld(), Pending.MantlePosition1, SenseSphereRadius, 12, FColor::Orange, false, SenseInterval);
+			DrawDebugSphere(GetWorld(), Pending.MantlePosition2, SenseSphereRadius, 12, FColor::White, false, SenseInterval);
+		}
+	}
+
+	Sensed = Pending;
+	Stage = ESenseStage::Idle;
+}
+
+void UParkourSensingComponent::AbortPass()
+{
+	// A pass that finds nothing still replaces what was there, the old actions belong to an older pose
+	if (Stage != ESenseStage::Idle)
+	{
+		Sensed = Pending;
+		Sensed.bCanVault = false;
+		Sensed.bCanMantle = false;
+	}
+	Stage = ESenseStage::Idle;
+}
+
+FTraceHandle UParkourSensingComponent::LineTrace(const FVector& Start, const FVector& End) const
+{
+	return ParkourQueries::AsyncLineTrace(this, Start, End);
+}
+
+FTraceHandle UParkourSensingComponent::SphereSweep(const FVector& Start, const FVector& End, float Radius) const
+{
+	return ParkourQueries::AsyncSweep(this, Start, End, FCollisionShape::MakeSphere(Radius));
+}
+
+UParkourSensingComponent::ETraceResult UParkourSensingComponent::GetTraceResult(const FTraceHandle& Handle, FHitResult& OutHit) const
+{
+	if (!Handle.IsValid())
+	{
+		return ETraceResult::Miss;
+	}
+
+	FTraceDatum Datum;
+	if (!GetWorld()->QueryTraceData(Handle, Datum))
+	{
+		return ETraceResult::Unavailable;
+	}
+
+	if (const FHitResult* Hit = FHitResult::GetFirstBlockingHit(Datum.OutHits))
+	{
+		OutHit = *Hit;
+		return ETraceResult::Hit;
+	}
+	return ETraceResult::Miss;
+}
@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "WorldCollision.h"
+#include "ParkourSensingComponent.generated.h"
+
+class AParkourCharacter;
+class UGeneratedGeometrySubsystem;
+
+// Vault and mantle the character could start right now, with their motion warp targets
+USTRUCT()
+struct FSensedParkourActions
+{
+	GENERATED_BODY()
+
+	bool bCanVault = false;
+	FVector VaultStart = FVector::ZeroVector;
+	FVector VaultMiddle = FVector::ZeroVector;
+	FVector VaultLand = FVector::ZeroVector;
+
+	bool bCanMantle = false;
+	FVector MantlePosition1 = FVector::ZeroVector;
+	FVector MantlePosition2 = FVector::ZeroVector;
+
+	// Pose the searches started from, the result only holds while the character stays close to it
+	FVector Location = FVector::ZeroVector;
+	FVector Forward = FVector::ForwardVector;
+	double Time = -1.0;
+};
+
+/**
+ * Searches for vault and mantle candidates in the background so Interact is a lookup. Every
+ * SenseInterval a search pass starts from the character's pose and runs as a few rounds of async
+ * traces, each round issued together and read back on the next frame, so no frame waits on a query.
+ * In front of generated geometry the ledge graph stands in for the reach and height rounds. The finished
+ * pass replaces the cached actions.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class PROCEDURALGENERATION_API UParkourSensingComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UParkourSensingComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Null when nothing has been sensed or the last pass no longer matches the character's pose
+	const FSensedParkourActions* GetSensedActions() const;
+
+	// Drops the cached actions once one has been started so it can't be started again from the same pass
+	void ConsumeSensedActions();
+
+protected:
+	virtual void BeginPlay() override;
+
+	// Seconds between the start of one search pass and the next
+	UPROPERTY(EditAnywhere, Category = "Sensing") float SenseInterval = 0.1f;
+
+	// How long and how far off its line a pass stays usable
+	UPROPERTY(EditAnywhere, Category = "Sensing") float MaxSenseAge = 0.3f;
+	UPROPERTY(EditAnywhere, Category = "Sensing") float MaxLateralDrift = 30.f;
+	UPROPERTY(EditAnywhere, Category = "Sensing") float MinFacingDot = 0.95f;
+
+	enum class ESenseStage : uint8
+	{
+		Idle,
+		Reach,
+		Height,
+		Clearance
+	};
+
+	enum class ETraceResult : uint8
+	{
+		Hit,
+		// Also a trace that wasn't issued
+		Miss,
+		// Issued but its results are gone, nothing can be said about what is there
+		Unavailable
+	};
+
+	void BeginPass();
+	// Finds the vault and mantle tops from the generated ledges, false to fall back to the reach traces
+	bool SenseLedges();
+	void ProcessReach();
+	void ProcessHeight();
+	void IssueClearance(bool bVault, bool bMantle);
+	void ProcessClearance();
+	void AbortPass();
+
+	FTraceHandle LineTrace(const FVector& Start, const FVector& End) const;
+	FTraceHandle SphereSweep(const FVector& Start, const FVector& End, float Radius) const;
+
+	// Result of a trace issued last frame, OutHit is only set for a hit
+	ETraceResult GetTraceResult(const FTraceHandle& Handle, FHitResult& OutHit) const;
+
+	UPROPERTY() AParkourCharacter* Character;
+	UPROPERTY() UGeneratedGeometrySubsystem* GeneratedGeometry;
+
+	ESenseStage Stage = ESenseStage::Idle;
+	float TimeSincePass = 0.f;
+
+	// Pass in flight
+	FSensedParkourActions Pending;
+	bool bPendingFalling = false;
+
+	FTraceHandle VaultReachTrace;
+	FTraceHandle MantleReachTrace;
+	TArray<FTraceHandle> VaultHeightTraces;
+	FTraceHandle MantleHeightTrace;
+	FTraceHandle VaultStartClearTrace;
+	FTraceHandle VaultLandTrace;
+	FTraceHandle VaultLandClearTrace;
+	FTraceHandle MantleSpaceTrace;
+	FTraceHandle MantleClearTrace;
+
+	FSensedParkourActions Sensed;
+};
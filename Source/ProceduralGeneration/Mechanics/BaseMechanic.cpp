@@ -2,31 +2,51 @@
 
 
 #include "BaseMechanic.h"
+#include "Curves/CurveFloat.h"
 #include "ProceduralGeneration/MechanicComponents/MechanicsComponent.h"
+#include "ProceduralGeneration/ProcGenTrace.h"
 
-void UBaseMechanic::Initialize(UMechanicsComponent* NewMechanic)
+bool FMechanicTimeline::Tick(float DeltaTime)
 {
-	MechanicComponent = NewMechanic;
+	if (!IsPlaying())
+	{
+		return false;
+	}
 
-	bIsRunning = false;
+	Position += DeltaTime * PlayRate;
+	if (bLooping)
+	{
+		Position = FMath::Fmod(Position + DefaultLength, DefaultLength);
+	}
+	else if (Position >= DefaultLength || Position <= 0.0f)
+	{
+		Position = FMath::Clamp(Position, 0.0f, DefaultLength);
+		Stop();
+	}
+	return true;
+}
 
+float FMechanicTimeline::GetValue(const UCurveFloat* Curve) const
+{
+	return Curve ? Curve->GetFloatValue(Position) : 0.0f;
 }
 
-bool UBaseMechanic::GetIsRunning() const
+void UBaseMechanic::InitializeState(const FMechanicContext& Context) const
 {
-	return bIsRunning;
+	Context.Batch->GivenTagMasks[Context.Index] = Context.Component->CompileTags(GivenTags);
+	Context.Batch->BlockedTagMasks[Context.Index] = Context.Component->CompileTags(BlockedTags);
+
+	OnMechanicAdded(Context);
 }
 
-bool UBaseMechanic::CanStart_Implementation(AActor* Actor)
+bool UBaseMechanic::CanStart(const FMechanicContext& Context) const
 {
-	if (GetIsRunning())
+	if (Context.IsRunning())
 	{
 		return false;
 	}
 
-	UMechanicsComponent* OwnerComponent = GetOwningComponent();
-
-	if (OwnerComponent->GetActiveTags().HasAnyExact(BlockedTags))
+	if (Context.Component->HasAnyActiveTags(Context.GetBlockedTags()))
 	{
 		//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Canstart is false"));
 		return false;
@@ -36,64 +56,68 @@ bool UBaseMechanic::CanStart_Implementation(AActor* Actor)
 	return true;
 }
 
-void UBaseMechanic::OnMechanicAdded_Implementation(AActor* Actor)
+void UBaseMechanic::OnMechanicAdded(const FMechanicContext& Context) const
 {
 
 }
 
-void UBaseMechanic::OnMechanicRemoved_Implementation(AActor* Actor)
+void UBaseMechanic::OnMechanicRemoved(const FMechanicContext& Context) const
 {
 
 }
 
-void UBaseMechanic::TickMechanic_Implementation(float DeltaTime)
+void UBaseMechanic::OnOwnerHit(const FMechanicContext& Context, AActor* OtherActor, UPrimitiveComponent* OtherComp, const FHitResult& Hit) const
 {
 
 }
 
-UMechanicsComponent* UBaseMechanic::GetOwningComponent() const
+const UScriptStruct* UBaseMechanic::GetStateStruct() const
 {
-	return MechanicComponent;
+	return nullptr;
 }
 
-void UBaseMechanic::StartMechanic_Implementation(AActor* Actor)
+void UBaseMechanic::TickStates(FMechanicStateBatch& Batch, TConstArrayView<int32> Indices) const
 {
-	UMechanicsComponent* OwnerComponent = GetOwningComponent();
-
-	OwnerComponent->GetActiveTags().AppendTags(GivenTags);
-
-	bIsRunning = true;
-	OwningActor = Actor;
+	// Nothing to do per frame, just let go of the characters that no longer want ticking
+	for (const int32 Index : Indices)
+	{
+		const FMechanicContext Context = Batch.GetContext(Index);
+		SetTicking(Context, UBaseMechanic::WantsTick(Context));
+	}
+}
 
-	
+bool UBaseMechanic::WantsTick(const FMechanicContext& Context) const
+{
+	return Context.IsRunning();
+}
 
-	//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("BaseMechanic StartMechanic Function"));
+void UBaseMechanic::RefreshTick(const FMechanicContext& Context) const
+{
+	SetTicking(Context, WantsTick(Context));
 }
 
-void UBaseMechanic::StopMechanic_Implementation(AActor* Actor)
+void UBaseMechanic::StartMechanic(const FMechanicContext& Context) const
 {
-	UMechanicsComponent* OwnerComponent = GetOwningComponent();
-	OwnerComponent->GetActiveTags().RemoveTags(GivenTags);
+	Context.Component->AddActiveTags(Context.GetGivenTags());
+
+	Context.Batch->Running[Context.Index] = true;
 
-	bIsRunning = false;
-	OwningActor = Actor;
+	PROCGEN_TRACE_BOOKMARK(TEXT("Start %s"), *MechanicTag.ToString());
 
+	Context.Component->OnMechanicStarted.Broadcast(MechanicTag);
 
+	RefreshTick(Context);
+
+	//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("BaseMechanic StartMechanic Function"));
 }
 
-bool UBaseMechanic::CanStartMechanic_Implementation(AActor* InInstigator)
+void UBaseMechanic::StopMechanic(const FMechanicContext& Context) const
 {
-	if (GetIsRunning())
-	{
-		return false;
-	}
-	
-	UMechanicsComponent* OwnerComponent = GetOwningComponent();
+	Context.Component->RemoveActiveTags(Context.GetGivenTags());
 
-	if (OwnerComponent->GetActiveTags().HasAnyExact(BlockedTags))
-	{
-		return false;
-	}
+	Context.Batch->Running[Context.Index] = false;
 
-	return true;
+	PROCGEN_TRACE_BOOKMARK(TEXT("Stop %s"), *MechanicTag.ToString());
+
+	RefreshTick(Context);
 }
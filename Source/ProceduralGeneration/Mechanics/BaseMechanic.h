@@ -5,66 +5,116 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "GameplayTagContainer.h"
+#include "ProceduralGeneration/MechanicComponents/MechanicsComponent.h"
+#include "ProceduralGeneration/MechanicComponents/MechanicsSubsystem.h"
+#include "ProceduralGeneration/MechanicComponents/MechanicTagMask.h"
 #include "BaseMechanic.generated.h"
 
+class UCurveFloat;
 class UMechanicsComponent;
+class AParkourCharacter;
+class UPAnimInstance;
 
 /**
- * 
+ * Play position along a float curve, the part of an FTimeline that differs per character. The mechanic
+ * evaluates its curve at the position each tick instead of the timeline calling back into an object.
+ */
+USTRUCT()
+struct PROCEDURALGENERATION_API FMechanicTimeline
+{
+	GENERATED_BODY()
+
+	// Length FTimeline plays for when it isn't given one, the mechanics' curves were made against it
+	static constexpr float DefaultLength = 5.0f;
+
+	float Position = 0.0f;
+
+	// 1 playing forwards, -1 reversing, 0 stopped
+	float PlayRate = 0.0f;
+
+	bool bLooping = false;
+
+	FORCEINLINE bool IsPlaying() const { return PlayRate != 0.0f; }
+
+	FORCEINLINE void PlayFromStart() { Position = 0.0f; PlayRate = 1.0f; }
+	FORCEINLINE void Reverse() { PlayRate = -1.0f; }
+	FORCEINLINE void Stop() { PlayRate = 0.0f; }
+
+	// Moves along the timeline, stopping at either end unless looping. True if it was playing.
+	bool Tick(float DeltaTime);
+
+	float GetValue(const UCurveFloat* Curve) const;
+};
+
+/**
+ * A mechanic's definition. Only the class default object is used, it holds the tunables, tags, curves and
+ * montages every character shares, and the mechanics subsystem holds each character's state for it.
+ * Everything a mechanic does to a character takes that character's context, so the definition itself is
+ * never changed at runtime.
  */
 UCLASS(Blueprintable)
 class PROCEDURALGENERATION_API UBaseMechanic : public UObject
 {
 	GENERATED_BODY()
 
-public:
-	void Initialize(UMechanicsComponent* NewMechanic);
+	friend class UMechanicsSubsystem;
 
-	UFUNCTION(BlueprintNativeEvent, Category = "Mechanics") bool CanStartMechanic(AActor* Actor);
+public:
+	// Compiles the tags against the character's component and calls OnMechanicAdded
+	void InitializeState(const FMechanicContext& Context) const;
 
-	UFUNCTION(BlueprintCallable, Category = "Mechanics") bool GetIsRunning() const;
-	
 	// Check if this mechanic can be started
-	UFUNCTION(BlueprintNativeEvent, Category = "Mechanics")
-	bool CanStart(AActor* Actor);
+	virtual bool CanStart(const FMechanicContext& Context) const;
 
 	bool StartByDefault = false;
 
 	// Start Mechanic
-	UFUNCTION(BlueprintNativeEvent, Category = "Mechanics")
-	void StartMechanic(AActor* Actor);
+	virtual void StartMechanic(const FMechanicContext& Context) const;
 
 	// Stop Mechanic
-	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Mechanics")
-	void StopMechanic(AActor* Actor);
+	virtual void StopMechanic(const FMechanicContext& Context) const;
 
-	UFUNCTION(BlueprintNativeEvent, Category = "Mechanics") void TickMechanic(float DeltaTime);
+	// Ticks every character in the batch at the given indices, one call per class each frame
+	virtual void TickStates(FMechanicStateBatch& Batch, TConstArrayView<int32> Indices) const;
 
 	// Event called when action is added
-	UFUNCTION(BlueprintNativeEvent, Category = "Mechanics") void OnMechanicAdded(AActor* Actor);
+	virtual void OnMechanicAdded(const FMechanicContext& Context) const;
 
 	// Event called when action is removed
-	UFUNCTION(BlueprintNativeEvent, Category = "Mechanics") void OnMechanicRemoved(AActor* Actor);
+	virtual void OnMechanicRemoved(const FMechanicContext& Context) const;
+
+	// The character's capsule hit something, forwarded by its mechanics component
+	virtual void OnOwnerHit(const FMechanicContext& Context, AActor* OtherActor, UPrimitiveComponent* OtherComp, const FHitResult& Hit) const;
+
+	// Struct added to the subsystem for each character, null when the shared columns are all it needs
+	virtual const UScriptStruct* GetStateStruct() const;
 
 	// the gameplay tag associated with this mechanic
 	UPROPERTY(EditAnywhere, Category = "Mechanics") FGameplayTag MechanicTag;
 
-	//UFUNCTION(BlueprintNativeEvent, Category = "Mechanics") void PlayMontage(UAnimMontage* MontageToPlay);
-
 protected:
-	UPROPERTY() UMechanicsComponent* MechanicComponent;
 	UPROPERTY(EditAnywhere, Category = "Animation") UAnimMontage* MechanicMontage;
 
-	UFUNCTION(BlueprintCallable, Category = "Action") UMechanicsComponent* GetOwningComponent() const;
+	// Mechanics without per frame work turn this off and are never ticked
+	UPROPERTY(EditDefaultsOnly, Category = "Tick") bool bCanEverTick = true;
+
+	// Seconds between ticks, 0 ticks every frame. Each character's tick gets the time since its last one.
+	// Shared by the class, the mechanics subsystem reads it from the definition.
+	UPROPERTY(EditDefaultsOnly, Category = "Tick", meta = (ClampMin = "0.0")) float TickInterval = 0.0f;
+
+	// Running mechanics tick by default, override to keep ticking after stopping (e.g. a timeline playing back)
+	virtual bool WantsTick(const FMechanicContext& Context) const;
+
+	// Call when WantsTick may have changed so the subsystem starts or stops ticking the character
+	void RefreshTick(const FMechanicContext& Context) const;
+
+	// RefreshTick for ticks, which already know the answer without a virtual call per character
+	FORCEINLINE void SetTicking(const FMechanicContext& Context, bool bWantsTick) const
+	{
+		Context.Batch->Subsystem->SetTicking(*Context.Batch, Context.Index, bCanEverTick && bWantsTick);
+	}
 
 	// Tags to be given to MechanicComponent
 	UPROPERTY(EditDefaultsOnly, Category = "Gameplay Tags") FGameplayTagContainer GivenTags;
 	UPROPERTY(EditDefaultsOnly, Category = "Gameplay Tags") FGameplayTagContainer BlockedTags;
-
-	//UPROPERTY(BlueprintReadWrite, Category = "Animation") UPAnimInstance* AnimInstance;
-
-	UPROPERTY() bool bIsRunning;
-	
-	// Actor that owns mechanic
-	UPROPERTY(BlueprintReadOnly) AActor* OwningActor;
 };
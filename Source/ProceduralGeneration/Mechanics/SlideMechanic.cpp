@@ -4,128 +4,118 @@
 
 #include "Components/CapsuleComponent.h"
 #include "ProceduralGeneration/ParkourCharacter.h"
+#include "ProceduralGeneration/ProcGenTrace.h"
 #include "ProceduralGeneration/AnimationInstance/PAnimInstance.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "ProceduralGeneration/MechanicComponents/MechanicsComponent.h"
+#include "ProceduralGeneration/MechanicComponents/ParkourMovementComponent.h"
 
 USlideMechanic::USlideMechanic()
 {
 	SlideSpeed = 750.f;
 }
 
-void USlideMechanic::OnMechanicAdded_Implementation(AActor* Actor)
+void USlideMechanic::OnMechanicAdded(const FMechanicContext& Context) const
 {
-	Super::OnMechanicAdded_Implementation(Actor);
+	Super::OnMechanicAdded(Context);
 
-	Player = Cast<AParkourCharacter>(Actor);
-	AnimInstance = Cast<UPAnimInstance>(Player->GetMesh()->GetAnimInstance());
-	MovementComp = Player->GetCharacterMovement<UMovementComponent>();
-
-	bIsRunning = false;
-	bIsCrouching = false;
-	bIsSliding = false;
-
-	if (TimelineCapsuleCurveFloat && TimelineMeshCurveFloat)
-	{
-		// Bind the timeline curve for Capsule to the UpdateCapsule function
-		FOnTimelineFloat CapsuleTimelineProgress;
-		CapsuleTimelineProgress.BindUFunction(this, FName("UpdateCapsule"));
-		SlideCapsuleScaleTimeline.AddInterpFloat(TimelineCapsuleCurveFloat, CapsuleTimelineProgress);
-
-		// Bind the timeline curve for Mesh to the UpdateMesh function
-		FOnTimelineFloat MeshTimelineProgress;
-		MeshTimelineProgress.BindUFunction(this, FName("UpdateMesh"));
-		SlideMeshLocationTimeline.AddInterpFloat(TimelineMeshCurveFloat, MeshTimelineProgress);
-	}
+	Context.GetState<FSlideMechanicState>().SlidingTagMask = Context.Component->CompileTags(SlidingTags);
 
 	//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Added!"));
 }
 
-void USlideMechanic::OnMechanicRemoved_Implementation(AActor* Actor)
+const UScriptStruct* USlideMechanic::GetStateStruct() const
 {
-	Super::OnMechanicRemoved_Implementation(Actor);
+	return FSlideMechanicState::StaticStruct();
 }
 
-void USlideMechanic::StartMechanic_Implementation(AActor* Actor)
+void USlideMechanic::StartMechanic(const FMechanicContext& Context) const
 {
 
-	Super::StartMechanic_Implementation(Actor);
+	Super::StartMechanic(Context);
 
-	Player = Cast<AParkourCharacter>(Actor);
+	AParkourCharacter* Player = Context.Character;
 
 	// Check velocity of player to determine whether to slide or crouch.
 	if (Player->GetMovementComponent()->Velocity.Length() > Player->GetPlayerWalkSpeed() && !Player->GetMovementComponent()->IsFalling())
 	{
-		AnimInstance->SetSliding(true);
+		Context.AnimInstance->SetSliding(true);
 		Player->SwitchMovementState(EMovementState::SLIDING);
-		StartSlide();
+		StartSlide(Context);
 	}
 	// If velocity > RUNSPEED value then set slide bool
 	else
 	{
-		AnimInstance->SetCrouching(true);
+		Context.AnimInstance->SetCrouching(true);
 		Player->SwitchMovementState(EMovementState::CROUCHING);
-		bIsCrouching = true;
+		Context.GetState<FSlideMechanicState>().bIsCrouching = true;
 	}
 
 	//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Crouching and Sliding!"));
 }
 
-void USlideMechanic::StartSlide()
+void USlideMechanic::StartSlide(const FMechanicContext& Context) const
 {
-	bIsSliding = true;
+	FSlideMechanicState& State = Context.GetState<FSlideMechanicState>();
+	State.bIsSliding = true;
 
-	GetOwningComponent()->GetActiveTags().AppendTags(SlidingTags);
+	Context.Component->AddActiveTags(State.SlidingTagMask);
+
+	Context.Character->GetParkourMovement()->StartSlide();
 	
-	if (AnimInstance && MechanicMontage) // Ensure the anim instance and montage are valid
+	if (Context.AnimInstance && MechanicMontage) // Ensure the anim instance and montage are valid
 	{
-		AnimInstance->Montage_Play(MechanicMontage); // Play the montage
+		Context.AnimInstance->Montage_Play(MechanicMontage); // Play the montage
 		//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Sliding!"));
 	}
 
 	// Scale capsule component - timeline
-	SlideCapsuleScaleTimeline.PlayFromStart();
-	//Player->GetMesh()->SetRelativeLocation(FVector(0,0, -45));
-	SlideMeshLocationTimeline.PlayFromStart();
+	State.CapsuleTimeline.PlayFromStart();
+	//GetPlayer()->GetMesh()->SetRelativeLocation(FVector(0,0, -45));
+	State.MeshTimeline.PlayFromStart();
 	  
 }
 
-void USlideMechanic::StopSlide()
+void USlideMechanic::StopSlide(const FMechanicContext& Context) const
 {
-	if (AnimInstance && EndSlideMontage && MechanicMontage) // Ensure the anim instance and montage are valid
+	FSlideMechanicState& State = Context.GetState<FSlideMechanicState>();
+	AParkourCharacter* Player = Context.Character;
+
+	Player->GetParkourMovement()->StopSlide();
+
+	if (Context.AnimInstance && EndSlideMontage && MechanicMontage) // Ensure the anim instance and montage are valid
 		{
-			AnimInstance->Montage_StopWithBlendOut(0.2f ,MechanicMontage); // Play the montage
-		if(bIsCrouching)
+			Context.AnimInstance->Montage_StopWithBlendOut(0.2f ,MechanicMontage); // Play the montage
+		if(State.bIsCrouching)
 		{
 			Player->GetCharacterMovement()->SetMovementMode(MOVE_Falling);
 		}
 		else
 		{
-			AnimInstance->Montage_Play(EndSlideMontage);
+			Context.AnimInstance->Montage_Play(EndSlideMontage);
 		}
 			//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("NOT Sliding!"));
 		}
 	
-	SlideCapsuleScaleTimeline.Reverse();
+	State.CapsuleTimeline.Reverse();
 	Player->GetMesh()->SetRelativeRotation(FRotator(0,-90, 0));
-	SlideMeshLocationTimeline.Reverse();
+	State.MeshTimeline.Reverse();
+
+	RefreshTick(Context);
 }
 
-void USlideMechanic::UpdateCapsule(float Value) const
+void USlideMechanic::UpdateCapsule(const FMechanicContext& Context, float Value) const
 {
 	// GetCapsuleFull.X returns the height of the full player capsule - GetFullCapsule.Y returns the Radius of the full player capsule
 
-	if (UCapsuleComponent* CapsuleComponent = Player->GetCapsuleComponent())
-	{
-		CapsuleComponent->SetCapsuleHalfHeight(FMath::Lerp(Player->GetCapsuleFull().Y, Player->GetCapsuleHalf().Y, Value));
-
-		//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Changing Capsule Height?!"));
-	}
+	// Applied by the movement component before its next move rather than resizing and updating overlaps here
+	AParkourCharacter* Player = Context.Character;
+	Player->GetParkourMovement()->RequestCapsuleHalfHeight(FMath::Lerp(Player->GetCapsuleFull().Y, Player->GetCapsuleHalf().Y, Value));
 }
 
-void USlideMechanic::UpdateMesh(float Value) const
+void USlideMechanic::UpdateMesh(const FMechanicContext& Context, float Value) const
 {
-	if (USkeletalMeshComponent* Mesh = Player->GetMesh())
+	if (USkeletalMeshComponent* Mesh = Context.Character->GetMesh())
 	{
 		//GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Yellow, FString::Printf(TEXT("Timeline Value: %f"), Value));
 		
@@ -142,109 +132,126 @@ void USlideMechanic::UpdateMesh(float Value) const
 	}
 }
 
-void USlideMechanic::SetSlideVelocity(FVector NewSlideVelocity)
+void USlideMechanic::SetSlideVelocity(const FMechanicContext& Context, FVector NewSlideVelocity) const
 {
-	SlideVelocity = NewSlideVelocity;
+	Context.GetState<FSlideMechanicState>().SlideVelocity = NewSlideVelocity;
 }
 
-void USlideMechanic::CheckShouldContinueSlide()
+void USlideMechanic::CheckShouldContinueSlide(const FMechanicContext& Context) const
 {
-	if(bIsSliding)
+	if(Context.GetState<FSlideMechanicState>().bIsSliding)
 	{
-		const FHitResult& Floor = Player->GetCharacterMovement()->CurrentFloor.HitResult;
-		const float SlideAngle = GetSlideSlope(Floor.Normal);
+		UParkourMovementComponent* Movement = Context.Character->GetParkourMovement();
+		const FHitResult& Floor = Movement->CurrentFloor.HitResult;
+		const float SlideAngle = GetSlideSlope(Context, Floor.Normal);
 
+		// Same speed change the old impulses gave, the slide mode applies it in its next move
 		if(FMath::IsNearlyZero(SlideAngle))
 		{
-			Player->GetCharacterMovement()->AddImpulse(Player->GetCharacterMovement()->Velocity.GetSafeNormal() * SlideSpeed);
+			Movement->AddSlideBoost(SlideSpeed / Movement->Mass);
 		}
-		else if (Player->GetVelocity().Length() != 0)
+		else if (Context.Character->GetVelocity().Length() != 0)
 		{
 			const float ActualSlideForce = SlideAngle > 1.6f ? SlideSpeed / SlideAngle : SlideSpeed;
 			
-			Player->GetCharacterMovement()->AddImpulse(Player->GetCharacterMovement()->Velocity.GetSafeNormal() * ActualSlideForce);
+			Movement->AddSlideBoost(ActualSlideForce / Movement->Mass);
 		}
 		else
 		{
-			StopSlide();
+			StopSlide(Context);
 		}
 
-		//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, FString::Printf(TEXT("Speed - %f"), Player->GetCharacterMovement()->Velocity.Length()));
+		//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, FString::Printf(TEXT("Speed - %f"), GetPlayer()->GetCharacterMovement()->Velocity.Length()));
 	}
 }
 
-float USlideMechanic::GetSlideSlope(const FVector& FloorNormal)
+float USlideMechanic::GetSlideSlope(const FMechanicContext& Context, const FVector& FloorNormal) const
 {
-	const float AngleRadians = FMath::Acos(FVector::DotProduct(FloorNormal, Player->GetVelocity()));
+	const float AngleRadians = FMath::Acos(FVector::DotProduct(FloorNormal, Context.Character->GetVelocity()));
 	return FMath::RadiansToDegrees(AngleRadians);
 }
 
-void USlideMechanic::StopMechanic_Implementation(AActor* Actor)
+void USlideMechanic::StopMechanic(const FMechanicContext& Context) const
 {
-	Player = Cast<AParkourCharacter>(Actor);
-	if(Player->GetCharacterMovement()->IsFalling())
+	if(Context.Character->GetCharacterMovement()->IsFalling())
 	{
 		return;
 	}
 	
-	Super::StopMechanic_Implementation(Actor);
+	Super::StopMechanic(Context);
 
 	//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("STOP!"));
-	AnimInstance->SetCrouching(false);
-	AnimInstance->SetSliding(false);
+	Context.AnimInstance->SetCrouching(false);
+	Context.AnimInstance->SetSliding(false);
 
-	StopSlide();
+	StopSlide(Context);
 	
-	bIsCrouching = false;
-	bIsSliding = false;
+	FSlideMechanicState& State = Context.GetState<FSlideMechanicState>();
+	State.bIsCrouching = false;
+	State.bIsSliding = false;
+}
+
+bool USlideMechanic::WantsTick(const FMechanicContext& Context) const
+{
+	const FSlideMechanicState& State = Context.GetState<FSlideMechanicState>();
+	return Super::WantsTick(Context) || State.CapsuleTimeline.IsPlaying() || State.MeshTimeline.IsPlaying();
 }
 
-void USlideMechanic::TickMechanic_Implementation(float DeltaTime) // Replace with Async tick
+void USlideMechanic::TickStates(FMechanicStateBatch& Batch, TConstArrayView<int32> Indices) const
 {
-	Super::TickMechanic_Implementation(DeltaTime);
+	PROCGEN_TRACE_SCOPE(SlideMechanic_TickStates);
 
-	// if the timeline is active then tick:
-	if (SlideCapsuleScaleTimeline.IsPlaying())
+	for (const int32 Index : Indices)
 	{
-		SlideCapsuleScaleTimeline.TickTimeline(DeltaTime);
+		const FMechanicContext Context = Batch.GetContext(Index);
+		TickState(Context, Batch.TickDeltaTime[Index]);
+
+		// Known to be a slide, no need to go through the vtable per character
+		SetTicking(Context, USlideMechanic::WantsTick(Context));
 	}
-	if (SlideMeshLocationTimeline.IsPlaying())
+}
+
+void USlideMechanic::TickState(const FMechanicContext& Context, float DeltaTime) const // Replace with Async tick
+{
+	FSlideMechanicState& State = Context.GetState<FSlideMechanicState>();
+	AParkourCharacter* Player = Context.Character;
+
+	// if the timeline is active then tick, the curves drive nothing unless both are set
+	const bool bCapsulePlaying = State.CapsuleTimeline.Tick(DeltaTime);
+	const bool bMeshPlaying = State.MeshTimeline.Tick(DeltaTime);
+	if (TimelineCapsuleCurveFloat && TimelineMeshCurveFloat)
 	{
-		SlideMeshLocationTimeline.TickTimeline(DeltaTime);
+		if (bCapsulePlaying)
+		{
+			UpdateCapsule(Context, State.CapsuleTimeline.GetValue(TimelineCapsuleCurveFloat));
+		}
+		if (bMeshPlaying)
+		{
+			UpdateMesh(Context, State.MeshTimeline.GetValue(TimelineMeshCurveFloat));
+		}
 	}
 	
-	if (bIsSliding)
+	if (State.bIsSliding)
 	{
-		FHitResult SphereHitResult;
-		FVector Start = Player->GetMesh()->GetComponentTransform().GetLocation();
-		FVector End = Player->GetMesh()->GetComponentTransform().GetLocation();
-		FCollisionQueryParams CollisionParams;
-		
-		// Draw debug sphere for each trace in the loop
-		//DrawDebugCapsule(GetWorld(), Start, 4, 18, FQuat::Identity, FColor::Yellow, false, 5.0f);
-		
-		// Check if On Floor
-		if (GetWorld()->SweepSingleByChannel(SphereHitResult, Start, End, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeCapsule(4, 18), CollisionParams))
-		{
-			// 
-		}
-		else
+		// The slide mode drops to falling off an edge and to walking when too slow, either ends the slide
+		if (!Player->GetParkourMovement()->IsCustomMovementMode(CMOVE_Slide))
 		{
 			// set sliding to false
-			StopMechanic_Implementation(Player);
+			StopMechanic(Context);
 			//GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::Red, TEXT("Stop slide!"));
 		}
 
-		CheckShouldContinueSlide();
+		CheckShouldContinueSlide(Context);
 		
 		// Align player to floor while sliding
-		if (Player && bIsSliding)
+		if (State.bIsSliding)
 		{
 			
 			// Get floor hit result
 			const FHitResult HitResult = Player->GetCharacterMovement()->CurrentFloor.HitResult;
 			
-			if(Player->GetCharacterMovement()->GetMovementName() == "Walking")
+			// Compare the mode directly, GetMovementName builds a string every frame
+			if (Player->GetCharacterMovement()->MovementMode == MOVE_Walking && AParkourCharacter::IsDebugDrawEnabled())
 			{
 				GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::Red, TEXT("Walking!"));
 			}
@@ -259,45 +266,14 @@ void USlideMechanic::TickMechanic_Implementation(float DeltaTime) // Replace wit
 
 				const FRotator TargetRotation = FRotationMatrix::MakeFromXZ(Player->GetMesh()->GetForwardVector(), FloorNorm).Rotator();
 				const FRotator FinalTargetRotation = FRotator(TargetRotation.Pitch, Player->GetMesh()->GetRelativeRotation().Yaw, TargetRotation.Roll);
-				//const FRotator FinalTargetRotation = FRotator(TargetRotation.Pitch, Player->GetMesh()->GetRelativeRotation().Yaw, TargetRotation.Roll);
+				//const FRotator FinalTargetRotation = FRotator(TargetRotation.Pitch, GetPlayer()->GetMesh()->GetRelativeRotation().Yaw, TargetRotation.Roll);
 
 				// Apply smooth rotation
 				Player->GetMesh()->SetRelativeRotation(FMath::RInterpTo(Player->GetMesh()->GetRelativeRotation(), FinalTargetRotation, DeltaTime, 3.f));
 				//GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, TEXT("Set Rotation!"));
-				
-				//GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::Yellow, FString::Printf(TEXT("ActorRotation - Pitch: %f  Roll: %f  Yaw: %f"), Player->GetActorRotation().Pitch, Player->GetActorRotation().Roll, Player->GetActorRotation().Yaw));
-				//GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::Yellow, FString::Printf(TEXT("TargetRotation - Pitch: %f  Roll: %f  Yaw: %f"), TargetRotation.Pitch, TargetRotation.Roll, TargetRotation.Yaw));
-				//GEngine->AddOnScreenDebugMessage(-1, 0.f, FColor::Yellow, FString::Printf(TEXT("FinalTargetRotation - Pitch: %f  Roll: %f  Yaw: %f"), FinalTargetRotation.Pitch, FinalTargetRotation.Roll, FinalTargetRotation.Yaw));
-				
-			}
-
-			Start = Player->GetMesh()->GetSocketLocation(FName("foot_l"));
-			// Turn offset into variable
-			Start += FVector (0,0,0);
-			End = Start;
-			CollisionParams.AddIgnoredActor(Player->GetCharacterMovement()->CurrentFloor.HitResult.GetActor());
-			
-			if (GetWorld()->SweepSingleByChannel(SphereHitResult, Start, End, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(20), CollisionParams))
-			{
-				FVector Normal = SphereHitResult.ImpactNormal;
-				float DotProduct = Normal.Dot(FVector(0,0,1));
-				float AngleRadians = FMath::Abs(FMath::Acos(FMath::Clamp(DotProduct, -1.f, 1.f)));
-				if(AngleRadians > 80) // make variable
-				{
-					
-				}
-				else
-				{
-					
-				}
 			}
 		}
 		
 	}
 	
 }
-
-bool USlideMechanic::CanStart_Implementation(AActor* Actor)
-{
-	return Super::CanStart_Implementation(Actor);
-}
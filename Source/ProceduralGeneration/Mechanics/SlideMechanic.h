@@ -4,12 +4,30 @@
 
 #include "CoreMinimal.h"
 #include "BaseMechanic.h"
-#include "Components/TimelineComponent.h"
 #include "ProceduralGeneration/AnimationInstance/PAnimInstance.h"
 #include "SlideMechanic.generated.h"
 
 class AParkourCharacter;
-class UMovementComponent;
+
+// One character's slide, the definition holds the tunables and curves
+USTRUCT()
+struct PROCEDURALGENERATION_API FSlideMechanicState
+{
+	GENERATED_BODY()
+
+	FMechanicTagMask SlidingTagMask;
+
+	FVector SlideVelocity = FVector::ZeroVector;
+
+	// Whether we are currently crouching
+	bool bIsCrouching = false;
+	// Whether we are currently sliding
+	bool bIsSliding = false;
+
+	// Capsule scale and mesh height, both played forwards on a slide and reversed on stopping
+	FMechanicTimeline CapsuleTimeline;
+	FMechanicTimeline MeshTimeline;
+};
 
 /**
  * 
@@ -22,60 +40,49 @@ class PROCEDURALGENERATION_API USlideMechanic : public UBaseMechanic
 public:
 	USlideMechanic();
 
-	virtual void OnMechanicAdded_Implementation(AActor* Actor) override;
-	virtual void OnMechanicRemoved_Implementation(AActor* Actor) override;
+	virtual void OnMechanicAdded(const FMechanicContext& Context) const override;
 
-	//virtual void Tick_Implementation
+	virtual void StartMechanic(const FMechanicContext& Context) const override;
+	virtual void StopMechanic(const FMechanicContext& Context) const override;
+	virtual void TickStates(FMechanicStateBatch& Batch, TConstArrayView<int32> Indices) const override;
 
-	virtual void StartMechanic_Implementation(AActor* Actor) override;
-	virtual void StopMechanic_Implementation(AActor* Actor) override;
-	virtual void TickMechanic_Implementation(float DeltaTime) override;
-	virtual bool CanStart_Implementation(AActor* Actor) override;
+	virtual const UScriptStruct* GetStateStruct() const override;
 
-	void StartSlide();
-	void StopSlide();
+	void StartSlide(const FMechanicContext& Context) const;
+	void StopSlide(const FMechanicContext& Context) const;
 
 	// Get Slope Angle
 	FVector2f GetSlopeDegreeAngle(FVector SurfaceNorm, FVector RightVector, FVector UpVector);
 	
 	// Slide Timeline Function
-	UFUNCTION() void UpdateCapsule(float Value) const;
-	UFUNCTION() void UpdateMesh(float Value) const;
+	void UpdateCapsule(const FMechanicContext& Context, float Value) const;
+	void UpdateMesh(const FMechanicContext& Context, float Value) const;
 
-	FORCEINLINE FVector GetSlideVelocity() { return SlideVelocity; };
-	void SetSlideVelocity(FVector NewSlideVelocity);
+	FORCEINLINE FVector GetSlideVelocity(const FMechanicContext& Context) const { return Context.GetState<FSlideMechanicState>().SlideVelocity; }
+	void SetSlideVelocity(const FMechanicContext& Context, FVector NewSlideVelocity) const;
 
-	void CheckShouldContinueSlide();
-	float GetSlideSlope(const FVector& FloorNormal);
+	void CheckShouldContinueSlide(const FMechanicContext& Context) const;
+	float GetSlideSlope(const FMechanicContext& Context, const FVector& FloorNormal) const;
 
 protected:
+	// Keeps ticking after a stop until the capsule and mesh timelines finish reversing
+	virtual bool WantsTick(const FMechanicContext& Context) const override;
 
-	UPROPERTY() AParkourCharacter* Player;
-	UPROPERTY() UPAnimInstance* AnimInstance;
-	UPROPERTY() UMovementComponent* MovementComp;
+	// One character's tick, TickStates runs it for each character due
+	void TickState(const FMechanicContext& Context, float DeltaTime) const;
 
 	UPROPERTY(EditAnywhere, Category = "Tags") FGameplayTagContainer CrouchTags;
 
 	UPROPERTY(EditAnywhere, Category = "Tags") FGameplayTagContainer SlidingTags;
 
 	// Slide Physics Values
-	UPROPERTY(EditAnywhere, Category = "Physics") FVector SlideVelocity;
 	UPROPERTY(EditAnywhere, Category = "Physics") float SlideSpeed;
 	UPROPERTY(EditAnywhere, Category = "Physics") float SlideDuration;
 	UPROPERTY(EditAnywhere, Category = "Physics") float MaxSlideSpeed;
 
 	UPROPERTY(EditAnywhere, Category = "Animation") UAnimMontage* EndSlideMontage;
 
-	float WalkSpeed;
-
-	// Whether we are currently crouching
-	bool bIsCrouching;
-	// Whether we are currently sliding
-	bool bIsSliding;
-
-	// Timeline variables
-	UPROPERTY() FTimeline SlideCapsuleScaleTimeline;
-	UPROPERTY() FTimeline SlideMeshLocationTimeline;
+	// Timeline curves, evaluated at each character's timeline positions
 	UPROPERTY(EditAnywhere, Category = "Timeline Float") UCurveFloat* TimelineCapsuleCurveFloat;
 	UPROPERTY(EditAnywhere, Category = "Timeline Float") UCurveFloat* TimelineMeshCurveFloat;
 };
@@ -5,24 +5,15 @@
 #include "ProceduralGeneration/ParkourCharacter.h"
 #include "GameFramework/CharacterMovementComponent.h"
 
-void UVaultMechanic::OnMechanicAdded_Implementation(AActor* Actor)
+UVaultMechanic::UVaultMechanic()
 {
-	Super::OnMechanicAdded_Implementation(Actor);
-
-	Player = Cast<AParkourCharacter>(Actor);
-	MovementComp = Player->GetCharacterMovement<UMovementComponent>();
-
-	bIsRunning = false;
-}
-
-void UVaultMechanic::OnMechanicRemoved_Implementation(AActor* Actor)
-{
-	Super::OnMechanicRemoved_Implementation(Actor);
+	// Vaults and mantles are driven by the character's interact traces, nothing happens per frame
+	bCanEverTick = false;
 }
 
-void UVaultMechanic::StartMechanic_Implementation(AActor* Actor)
+void UVaultMechanic::StartMechanic(const FMechanicContext& Context) const
 {
-	Super::StartMechanic_Implementation(Actor);
+	Super::StartMechanic(Context);
 
 	
 
@@ -30,19 +21,14 @@ void UVaultMechanic::StartMechanic_Implementation(AActor* Actor)
 	//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Crouching and Sliding!"));
 }
 
-void UVaultMechanic::StopMechanic_Implementation(AActor* Actor)
+void UVaultMechanic::StopMechanic(const FMechanicContext& Context) const
 {
-	Super::StopMechanic_Implementation(Actor);
+	Super::StopMechanic(Context);
 
 	
 }
 
-void UVaultMechanic::TickMechanic_Implementation(float DeltaTime)
-{
-
-}
-
-bool UVaultMechanic::CanStart_Implementation(AActor* Actor)
+bool UVaultMechanic::CanStart(const FMechanicContext& Context) const
 {
-	return Super::CanStart_Implementation(Actor);
+	return Super::CanStart(Context);
 }
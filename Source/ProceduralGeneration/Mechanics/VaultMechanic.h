@@ -7,7 +7,6 @@
 #include "VaultMechanic.generated.h"
 
 class AParkourCharacter;
-class UMovementComponent;
 
 /**
  * 
@@ -18,20 +17,13 @@ class PROCEDURALGENERATION_API UVaultMechanic : public UBaseMechanic
 	GENERATED_BODY()
 	
 public:
-	virtual void OnMechanicAdded_Implementation(AActor* Actor) override;
-	virtual void OnMechanicRemoved_Implementation(AActor* Actor) override;
+	UVaultMechanic();
 
-	//virtual void Tick_Implementation
-
-	virtual void StartMechanic_Implementation(AActor* Actor) override;
-	virtual void StopMechanic_Implementation(AActor* Actor) override;
-	virtual void TickMechanic_Implementation(float DeltaTime) override;
-	virtual bool CanStart_Implementation(AActor* Actor) override;
+	// Vaults have no state of their own, the shared running flag and tags are all they use
+	virtual void StartMechanic(const FMechanicContext& Context) const override;
+	virtual void StopMechanic(const FMechanicContext& Context) const override;
+	virtual bool CanStart(const FMechanicContext& Context) const override;
 
 protected:
-	UPROPERTY() AParkourCharacter* Player;
-
-	UPROPERTY() UMovementComponent* MovementComp;
-
 	UPROPERTY(EditAnywhere, Category = "Tags") FGameplayTagContainer VaultTags;
 };
@@ -3,6 +3,8 @@
 
 #include "ProceduralGeneration/Mechanics/WallRunMechanic.h"
 #include "ProceduralGeneration/ParkourCharacter.h"
+#include "ProceduralGeneration/ParkourQueries.h"
+#include "ProceduralGeneration/ProcGenTrace.h"
 #include "ProceduralGeneration/AnimationInstance/PAnimInstance.h"
 #include <GameFramework/CharacterMovementComponent.h>
 
@@ -10,114 +12,109 @@
 #include "ProceduralGeneration/PGameTags.h"
 
 #include "Components/CapsuleComponent.h"
-#include "TimerManager.h"
+#include "DrawDebugHelpers.h"
 #include "Engine/World.h"
+#include "ProceduralGeneration/ParkourCollision.h"
 #include "ProceduralGeneration/MechanicComponents/MechanicsComponent.h"
+#include "ProceduralGeneration/MechanicComponents/ParkourMovementComponent.h"
 
 UWallRunMechanic::UWallRunMechanic()
 {
 	//SetWallRunOptions()
 	WallRunGravityScale = 0.0f;
-	bIsPlaneConstraintEnabled = true;
-	WallRunConstrainNormal = FVector(0,0,1);
 	bShouldPlayerOrientToMovement = false;
 	WallRunCapsuleRadius = 45;
 
 	bApplyGravity = false;
-	bIsWallRunning = false;
 }
 
-void UWallRunMechanic::OnMechanicAdded_Implementation(AActor* Actor)
+void UWallRunMechanic::OnMechanicAdded(const FMechanicContext& Context) const
 {
-	Super::OnMechanicAdded_Implementation(Actor);
+	Super::OnMechanicAdded(Context);
 
-	GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Wall Run Added"));
-	
-	Player = Cast<AParkourCharacter>(Actor);
-	AnimInstance = Cast<UPAnimInstance>(Player->GetMesh()->GetAnimInstance());
-	MovementComp = Player->GetCharacterMovement<UMovementComponent>();
+	FWallRunMechanicState& State = Context.GetState<FWallRunMechanicState>();
+	State.WallRunningTagMask = Context.Component->CompileTags(WallRunningTags);
 
-	if (WallRunArcCurve)
-	{
-		// Bind the timeline curve for Capsule to the UpdateCapsule function
-		FOnTimelineFloat WallRunTimelineProgress;
-		FOnTimelineEventStatic onTimelineFinishedCallback;
-		WallRunTimelineProgress.BindUFunction(this, FName("TimelineArcUpdate"));
-		onTimelineFinishedCallback.BindUFunction(this, FName("TimelineArcComplete"));
-		WallRunningTimeline.AddInterpFloat(WallRunArcCurve, WallRunTimelineProgress);
-		WallRunningTimeline.SetTimelineFinishedFunc(onTimelineFinishedCallback);
-	}
+	State.GeneratedGeometry = Context.Character->GetWorld()->GetSubsystem<UGeneratedGeometrySubsystem>();
 
-	// Gravity Timeline
-	GravityScaleTimeline.SetLooping(true);
-	FOnTimelineFloat GravityTimelineProgress;
-	GravityTimelineProgress.BindUFunction(this, FName("GravityUpdate"));
-
-	// Setup function to detect if player should wallrun
-	Player->GetCapsuleComponent()->OnComponentHit.AddDynamic(this, &UWallRunMechanic::OnCapsuleComponentHit);
+	// Capsule hits reach OnOwnerHit through the mechanics component
 }
 
-void UWallRunMechanic::OnMechanicRemoved_Implementation(AActor* Actor)
+const UScriptStruct* UWallRunMechanic::GetStateStruct() const
 {
-	Super::OnMechanicRemoved_Implementation(Actor);
-	
+	return FWallRunMechanicState::StaticStruct();
 }
 
-void UWallRunMechanic::OnCapsuleComponentHit(UPrimitiveComponent* HitComponent, AActor* OtherActor,
-	UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+void UWallRunMechanic::OnOwnerHit(const FMechanicContext& Context, AActor* OtherActor, UPrimitiveComponent* OtherComp, const FHitResult& Hit) const
 {
 	//GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, TEXT("Capsule Overlap!"));
+
+	FWallRunMechanicState& State = Context.GetState<FWallRunMechanicState>();
+	AParkourCharacter* Player = Context.Character;
 	
-	if(!bIsWallRunning && !Player->GetCharacterMovement()->IsFalling())
+	if(!State.bIsWallRunning && !Player->GetCharacterMovement()->IsFalling())
 	{
 		//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Wall Run is false && Not Falling"));
 	}
 	else
 	{
+		// Generated walls are exact boxes, use the face the character is against rather than the contact normal
+		FVector WallNormal = Hit.ImpactNormal;
+		const FGeneratedBox* WallBox = State.GeneratedGeometry ? State.GeneratedGeometry->FindBox(OtherActor) : nullptr;
+		if (WallBox && WallBox->Type == EGeneratedBoxType::WallRun)
+		{
+			WallNormal = WallBox->GetFaceNormal(Player->GetActorLocation());
+		}
+		State.WallPlane = FPlane(Hit.ImpactPoint, WallNormal);
+		State.WallBounds = WallBox ? *WallBox : FGeneratedBox::FromComponent(OtherComp, EGeneratedBoxType::WallRun, OtherActor);
+
 		// Cross product to receive a vector which is perpendicular to two given vectors - player and wall.
-		float ReName = FVector::DotProduct(Hit.ImpactNormal, Player->GetActorRightVector());
+		float ReName = FVector::DotProduct(WallNormal, Player->GetActorRightVector());
 
 		//GEngine->AddOnScreenDebugMessage(-1, 2.5f, FColor::Red, FString::Printf(TEXT("Starting prep for wall run - ReName: %f"), ReName));
 		
 		if (ReName > 0)
 		{
-			WallRunNormal = FVector::CrossProduct(Hit.ImpactNormal, FVector(0,0,1));
-			WallRunDirection = EDirection::Right;
-			AnimInstance->SetWallrunDirection(EDirection::Right);
+			State.WallRunNormal = FVector::CrossProduct(WallNormal, FVector(0,0,1));
+			State.WallRunDirection = EDirection::Right;
+			Context.AnimInstance->SetWallrunDirection(EDirection::Right);
 		}
 		else
 		{
-			WallRunNormal = FVector::CrossProduct(Hit.ImpactNormal, FVector(0,0,-1));
-			WallRunDirection = EDirection::Left;
-			AnimInstance->SetWallrunDirection(EDirection::Left);
+			State.WallRunNormal = FVector::CrossProduct(WallNormal, FVector(0,0,-1));
+			State.WallRunDirection = EDirection::Left;
+			Context.AnimInstance->SetWallrunDirection(EDirection::Left);
 		}
 
-		FRotator PlayerDirection = Player->GetInputDirection();
 		// Dot product will be 0 if player is perpendicular to wall and will increase the closer their forward is to the wall.
-		float DotResult = FVector::DotProduct(Player->GetActorForwardVector(), WallRunNormal);
-		//PlayerDirection.Vector()
+		float DotResult = FVector::DotProduct(Player->GetActorForwardVector(), State.WallRunNormal);
 		
 		//GEngine->AddOnScreenDebugMessage(-1, 0.0f, FColor::Red, FString::Printf(TEXT("DotResult = %f"), DotResult));
 		
-		if (ContinueWallRun() && DotResult > 0.5) // make variable
+		if (ContinueWallRun(Context) && DotResult > 0.5) // make variable
 		{
 			// Sphere trace to detect if player is far enough from the ground?
 			
 			//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Wall Run Logic!"));
-			BeginWallrun();
+			State.GeneratedWall = WallBox ? OtherActor : nullptr;
+			BeginWallrun(Context);
 		}
 	}
 }
 
-void UWallRunMechanic::StartMechanic_Implementation(AActor* Actor)
+void UWallRunMechanic::StartMechanic(const FMechanicContext& Context) const
 {
-	Super::StartMechanic_Implementation(Actor);
+	Super::StartMechanic(Context);
 
 	//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Star WallRun!"));
 
-	GetWorld()->GetTimerManager().SetTimer(ForwardTraceDelay, this, &UWallRunMechanic::ShouldForwardTrace, 0.2f, false);
+	FWallRunMechanicState& State = Context.GetState<FWallRunMechanicState>();
+	AParkourCharacter* Player = Context.Character;
+
+	// Counted down by the tick, which runs while the mechanic does
+	State.ForwardTraceDelay = 0.2f;
 	
-	if (bIsWallRunning)
+	if (State.bIsWallRunning)
 	{
 		//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("LAUNCH CHARACTER"));
 		// Stop wallrun and launch in camera forward direction
@@ -126,7 +123,7 @@ void UWallRunMechanic::StartMechanic_Implementation(AActor* Actor)
 		
 		Player->LaunchCharacter(JumpOffVector * WallJumpOffForce, true, true);
 
-		EndWallrun();
+		EndWallrun(Context);
 	}
 	else
 	{
@@ -135,166 +132,346 @@ void UWallRunMechanic::StartMechanic_Implementation(AActor* Actor)
 	}
 }
 
-void UWallRunMechanic::StopMechanic_Implementation(AActor* Actor)
+void UWallRunMechanic::StopMechanic(const FMechanicContext& Context) const
 {
-	Super::StopMechanic_Implementation(Actor);
+	Super::StopMechanic(Context);
 
-	GetWorld()->GetTimerManager().ClearTimer(ForwardTraceDelay);
-	EndWallrun();
-	Player->StopJumping();
+	Context.GetState<FWallRunMechanicState>().ForwardTraceDelay = 0.0f;
+	EndWallrun(Context);
+	Context.Character->StopJumping();
 }
 
-void UWallRunMechanic::TickMechanic_Implementation(float DeltaTime)
+bool UWallRunMechanic::WantsTick(const FMechanicContext& Context) const
 {
-	Super::TickMechanic_Implementation(DeltaTime);
+	return Super::WantsTick(Context) || Context.GetState<FWallRunMechanicState>().bIsWallRunning;
+}
+
+void UWallRunMechanic::TickStates(FMechanicStateBatch& Batch, TConstArrayView<int32> Indices) const
+{
+	PROCGEN_TRACE_SCOPE(WallRunMechanic_TickStates);
 
-	if (bIsWallRunning)
+	for (const int32 Index : Indices)
 	{
-		SetWallRunRotation();
-		
-		if(!ContinueWallRun())
+		const FMechanicContext Context = Batch.GetContext(Index);
+		TickState(Context, Batch.TickDeltaTime[Index]);
+
+		// Known to be a wall run, no need to go through the vtable per character
+		SetTicking(Context, UWallRunMechanic::WantsTick(Context));
+	}
+}
+
+void UWallRunMechanic::TickState(const FMechanicContext& Context, float DeltaTime) const
+{
+	FWallRunMechanicState& State = Context.GetState<FWallRunMechanicState>();
+
+	if (State.ForwardTraceDelay > 0.0f)
+	{
+		State.ForwardTraceDelay -= DeltaTime;
+		if (State.ForwardTraceDelay <= 0.0f)
+		{
+			State.ForwardTraceDelay = 0.0f;
+			State.bForwardTrace = true;
+		}
+	}
+
+	if (State.bIsWallRunning)
+	{
+		if(!ContinueWallRun(Context))
 		{
-			EndWallrun();
+			EndWallrun(Context);
 		}
 		else
 		{
-			FHitResult SphereHitResult;
-			FVector Start = Player->GetMesh()->GetComponentLocation();
-			float Direction = (WallRunDirection == EDirection::Left) ? 1.f : -1.f;
-			FVector End = Start + (Player->GetActorRightVector() * Direction * 60);
-
-			// Foot Location Trace
-			if (GetWorld()->SweepSingleByChannel(SphereHitResult, Start, End, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(5)))
+			// Probes run at the fixed probe rate, frames in between keep the last wall plane and direction
+			if (State.ProbeSchedule.Tick(DeltaTime) && !ProbeWall(Context))
 			{
-				
-				DrawDebugSphere(GetWorld(), Start, 5.0f, 12, FColor::Green, false, 5.0f);
-				
-				Start = Player->GetMesh()->GetComponentLocation() + (Player->GetActorRightVector() * Direction * 5);
-				// ground check
-				if (GetWorld()->SweepSingleByChannel(SphereHitResult, Start, Start, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(10)))
-				{
-					EndWallrun();
-				}
-				else
-				{
-					
-					// Capsule Trace for checking if a wall lies ahead.
-					float CapsuleRadius = bForwardTrace ? 10.f : 0.f;
-					Start = Player->GetActorLocation() + (Player->GetActorForwardVector() * 50); // make variable?
-				
-					if (GetWorld()->SweepSingleByChannel(SphereHitResult, Start, Start, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeCapsule(CapsuleRadius, 50)))
-					{
-						EndWallrun();
-					}
-					else
-					{
-						DrawDebugCapsule(GetWorld(), Start, 50.f, CapsuleRadius, FQuat::Identity, FColor::Purple, false, 5.0f);
-						FHitResult LineHitResult;
-						Start = Player->GetActorLocation();
-						FVector WallRunDirectionVector = (WallRunDirection == EDirection::Left) ? FVector(0,0,-1) : FVector(0,0,1);
-						End = Start + FVector(FVector::CrossProduct(WallRunNormal, WallRunDirectionVector) * 200 );
-						if(GetWorld()->LineTraceSingleByChannel(LineHitResult, Start, End, ECC_Visibility))
-						{
-							WallRunNormal = FVector::CrossProduct(LineHitResult.ImpactNormal, WallRunDirectionVector);
-							FVector NewVelocity = FVector(WallRunNormal * Player->GetCharacterMovement()->MaxWalkSpeed);
-							Player->GetCharacterMovement()->Velocity = FVector(NewVelocity.X, NewVelocity.Y, 0);
-						}
-						else
-						{
-							
-						}
-
-						for (int i = 0; i < 5; i++)
-						{
-							Start = Player->GetActorLocation() + FVector(0,0, 50 - (i * 10));
-							End = Player->GetActorLocation() + FVector(FVector::CrossProduct(WallRunNormal, WallRunDirectionVector) * 200 ) + FVector(0,0,(50 - (i * 10)));
-					
-							if(GetWorld()->LineTraceSingleByChannel(LineHitResult, Start, End, ECC_Visibility))
-							{
-								WallSurfaceNormal = LineHitResult.Normal;
-						
-								// Offset for hand on wall location.
-								switch (WallRunDirection)
-								{
-								case EDirection::Left:
-									WallRunHandIK_RightLocation = FVector((LineHitResult.Normal * 5.f) + LineHitResult.ImpactPoint);
-									AnimInstance->SetHandRightLocation(WallRunHandIK_RightLocation);
-									WallRunHandIK_LeftAlpha = 0.f;
-									AnimInstance->SetHandLeftAlpha(WallRunHandIK_LeftAlpha);
-									WallRunHandIK_RightAlpha = 1.f;
-									AnimInstance->SetHandLeftAlpha(WallRunHandIK_RightAlpha);
-									break;
-								case EDirection::Right:
-									WallRunHandIK_Location = FVector((LineHitResult.Normal * 5.f) + LineHitResult.ImpactPoint);
-									AnimInstance->SetHandLeftLocation(WallRunHandIK_Location);
-									WallRunHandIK_LeftAlpha = 1.f;
-									AnimInstance->SetHandLeftAlpha(WallRunHandIK_LeftAlpha);
-									WallRunHandIK_RightAlpha = 0.f;
-									AnimInstance->SetHandLeftAlpha(WallRunHandIK_RightAlpha);
-									break;
-								default:
-									break;
-								}
-							
-							
-								// finally break
-								break;
-							}
-						}
-					
-						if (bApplyGravity)
-						{
-							GravityScaleTimeline.TickTimeline(DeltaTime);
-						}
-		
-						WallRunningTimeline.TickTimeline(DeltaTime);
-					}
-				}
+				EndWallrun(Context);
+				return;
 			}
-			else
+
+			UpdateHandIK(Context, DeltaTime);
+		
+			if (State.ArcTimeline.Tick(DeltaTime) && WallRunArcCurve)
 			{
-				DrawDebugSphere(GetWorld(), Start, 5.0f, 12, FColor::Red, false, 5.0f);
-				EndWallrun();
+				TimelineArcUpdate(Context, State.ArcTimeline.GetValue(WallRunArcCurve));
 			}
 		}
 	}
 }
 
-bool UWallRunMechanic::CanStart_Implementation(AActor* Actor)
+bool UWallRunMechanic::ProbeWall(const FMechanicContext& Context) const
+{
+	PROCGEN_TRACE_SCOPE(WallRunMechanic_ProbeWall);
+
+	FWallRunMechanicState& State = Context.GetState<FWallRunMechanicState>();
+	AParkourCharacter* Player = Context.Character;
+	UWorld* World = Player->GetWorld();
+
+	GatherWallProbeComponents(Context);
+
+	// Draws last until the next probe
+	const float DebugLifetime = FParkourProbeSchedule::GetInterval();
+
+	FHitResult SphereHitResult;
+	FVector Start = Player->GetMesh()->GetComponentLocation();
+	float Direction = (State.WallRunDirection == EDirection::Left) ? 1.f : -1.f;
+	FVector End = Start + (Player->GetActorRightVector() * Direction * 60);
+
+	// Foot Location Trace
+	if (!ProbeSweep(State, SphereHitResult, Start, End, FCollisionShape::MakeSphere(5)))
+	{
+		if (AParkourCharacter::IsDebugDrawEnabled())
+		{
+			DrawDebugSphere(World, Start, 5.0f, 12, FColor::Red, false, DebugLifetime);
+		}
+		return false;
+	}
+
+	if (AParkourCharacter::IsDebugDrawEnabled())
+	{
+		DrawDebugSphere(World, Start, 5.0f, 12, FColor::Green, false, DebugLifetime);
+	}
+	
+	Start = Player->GetMesh()->GetComponentLocation() + (Player->GetActorRightVector() * Direction * 5);
+	// ground check
+	if (ProbeOverlap(State, Start, FCollisionShape::MakeSphere(10)))
+	{
+		return false;
+	}
+
+	// Capsule Trace for checking if a wall lies ahead.
+	float CapsuleRadius = State.bForwardTrace ? 10.f : 0.f;
+	Start = Player->GetActorLocation() + (Player->GetActorForwardVector() * 50); // make variable?
+
+	if (ProbeOverlap(State, Start, FCollisionShape::MakeCapsule(CapsuleRadius, 50)))
+	{
+		return false;
+	}
+
+	if (AParkourCharacter::IsDebugDrawEnabled())
+	{
+		DrawDebugCapsule(World, Start, 50.f, CapsuleRadius, FQuat::Identity, FColor::Purple, false, DebugLifetime);
+	}
+
+	FHitResult LineHitResult;
+	Start = Player->GetActorLocation();
+	FVector WallRunDirectionVector = (State.WallRunDirection == EDirection::Left) ? FVector(0,0,-1) : FVector(0,0,1);
+	End = Start + FVector(FVector::CrossProduct(State.WallRunNormal, WallRunDirectionVector) * WallProbeReach);
+	if(ProbeLine(State, LineHitResult, Start, End, &State.WallBounds))
+	{
+		State.WallPlane = FPlane(LineHitResult.ImpactPoint, LineHitResult.ImpactNormal);
+		State.WallRunNormal = FVector::CrossProduct(LineHitResult.ImpactNormal, WallRunDirectionVector);
+		Player->GetParkourMovement()->SetWallRunDirection(State.WallRunNormal);
+	}
+
+	return true;
+}
+
+void UWallRunMechanic::GatherWallProbeComponents(const FMechanicContext& Context) const
 {
-	if (!Super::CanStart_Implementation(Actor))
+	PROCGEN_TRACE_SCOPE(WallRunMechanic_GatherWallProbe);
+
+	FWallRunMechanicState& State = Context.GetState<FWallRunMechanicState>();
+	AParkourCharacter* Player = Context.Character;
+
+	// Covers every probe in the tick, the hand and normal probes can point anywhere around the character
+	const FVector ActorLocation = Player->GetActorLocation();
+	const float Bottom = FMath::Min(Player->GetMesh()->GetComponentLocation().Z - 10.f, ActorLocation.Z - 50.f);
+	const float Top = ActorLocation.Z + 50.f;
+	const FVector Extent(WallProbeReach + 10.f, WallProbeReach + 10.f, (Top - Bottom) * 0.5f);
+	const FVector Center(ActorLocation.X, ActorLocation.Y, (Top + Bottom) * 0.5f);
+
+	State.WallProbeComponents.Reset();
+
+	// Generators unregister walls they release, so this also catches the wall going away mid run
+	State.bProbeGeneratedGeometry = State.GeneratedWall && State.GeneratedGeometry && State.GeneratedGeometry->FindBox(State.GeneratedWall);
+	if (State.bProbeGeneratedGeometry)
+	{
+		return;
+	}
+
+	// The definition has no world, so the query goes through the character's while still counting against the wall run
+	ParkourQueries::Count(this, EParkourQueryType::Overlap);
+	Player->GetWorld()->OverlapMultiByChannel(State.WallProbeOverlaps, Center, FQuat::Identity, ECC_Parkour, FCollisionShape::MakeBox(Extent));
+
+	// The single traces these replace only ever stopped on blocking components
+	for (const FOverlapResult& Overlap : State.WallProbeOverlaps)
+	{
+		UPrimitiveComponent* Component = Overlap.GetComponent();
+		if (Overlap.bBlockingHit && Component)
+		{
+			State.WallProbeComponents.Add(Component);
+		}
+	}
+
+	if (AParkourCharacter::IsDebugDrawEnabled())
+	{
+		DrawDebugBox(Player->GetWorld(), Center, Extent, FColor::Cyan);
+	}
+}
+
+bool UWallRunMechanic::ProbeSweep(FWallRunMechanicState& State, FHitResult& OutHit, const FVector& Start, const FVector& End, const FCollisionShape& Shape) const
+{
+	if (State.bProbeGeneratedGeometry)
+	{
+		return State.GeneratedGeometry->Raycast(Start, End, Shape.GetSphereRadius(), OutHit);
+	}
+
+	// Narrow phase only, but still a query per component
+	ParkourQueries::Count(this, EParkourQueryType::Sweep, State.WallProbeComponents.Num());
+
+	bool bHit = false;
+	FHitResult ComponentHit;
+	for (UPrimitiveComponent* Component : State.WallProbeComponents)
+	{
+		if (Component->SweepComponent(ComponentHit, Start, End, FQuat::Identity, Shape) && (!bHit || ComponentHit.Time < OutHit.Time))
+		{
+			OutHit = ComponentHit;
+			bHit = true;
+		}
+	}
+	return bHit;
+}
+
+bool UWallRunMechanic::ProbeOverlap(const FWallRunMechanicState& State, const FVector& Position, const FCollisionShape& Shape) const
+{
+	if (State.bProbeGeneratedGeometry)
+	{
+		return Shape.IsCapsule()
+			? State.GeneratedGeometry->OverlapCapsule(Position, Shape.GetCapsuleRadius(), Shape.GetCapsuleHalfHeight())
+			: State.GeneratedGeometry->OverlapSphere(Position, Shape.GetSphereRadius());
+	}
+
+	ParkourQueries::Count(this, EParkourQueryType::Overlap, State.WallProbeComponents.Num());
+
+	for (const UPrimitiveComponent* Component : State.WallProbeComponents)
+	{
+		if (Component->OverlapComponent(Position, FQuat::Identity, Shape))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool UWallRunMechanic::ProbeLine(FWallRunMechanicState& State, FHitResult& OutHit, const FVector& Start, const FVector& End, FGeneratedBox* OutWall) const
+{
+	if (State.bProbeGeneratedGeometry)
+	{
+		// Only walls like the one the run started on, a platform crossing the probe mustn't take over the wall
+		const FGeneratedBox* HitBox = nullptr;
+		if (!State.GeneratedGeometry->Raycast(Start, End, 0.0f, State.WallBounds.Type, OutHit, &HitBox))
+		{
+			return false;
+		}
+		if (OutWall)
+		{
+			*OutWall = *HitBox;
+		}
+		return true;
+	}
+
+	ParkourQueries::Count(this, EParkourQueryType::Line, State.WallProbeComponents.Num());
+
+	bool bHit = false;
+	FHitResult ComponentHit;
+	for (UPrimitiveComponent* Component : State.WallProbeComponents)
+	{
+		if (Component->LineTraceComponent(ComponentHit, Start, End, FCollisionQueryParams::DefaultQueryParam) && (!bHit || ComponentHit.Time < OutHit.Time))
+		{
+			OutHit = ComponentHit;
+			bHit = true;
+		}
+	}
+
+	if (bHit && OutWall)
+	{
+		*OutWall = FGeneratedBox::FromComponent(OutHit.GetComponent(), EGeneratedBoxType::WallRun, OutHit.GetActor());
+	}
+	return bHit;
+}
+
+void UWallRunMechanic::UpdateHandIK(const FMechanicContext& Context, float DeltaTime) const
+{
+	FWallRunMechanicState& State = Context.GetState<FWallRunMechanicState>();
+	FWallRunHandIK& HandIK = State.HandIK;
+	const FPlane& WallPlane = State.WallPlane;
+
+	// The hand on the wall side reaches, the other one blends out
+	const bool bRightHand = State.WallRunDirection == EDirection::Left;
+	const FVector Shoulder = Context.Character->GetMesh()->GetSocketLocation(bRightHand ? RightShoulderSocket : LeftShoulderSocket);
+	const FVector OnWall = FVector::PointPlaneProject(Shoulder, WallPlane) + WallPlane.GetNormal() * HandWallOffset;
+
+	const bool bValid = FMath::Abs(WallPlane.PlaneDot(Shoulder)) <= HandIKReach && State.WallBounds.IsWithinFace(OnWall, WallPlane.GetNormal());
+	const float TargetAlpha = bValid ? 1.f : 0.f;
+
+	if (bRightHand)
+	{
+		HandIK.RightLocation = bValid ? OnWall : HandIK.RightLocation;
+		HandIK.RightAlpha = FMath::FInterpTo(HandIK.RightAlpha, TargetAlpha, DeltaTime, HandIKBlendSpeed);
+		HandIK.LeftAlpha = FMath::FInterpTo(HandIK.LeftAlpha, 0.f, DeltaTime, HandIKBlendSpeed);
+	}
+	else
+	{
+		HandIK.LeftLocation = bValid ? OnWall : HandIK.LeftLocation;
+		HandIK.LeftAlpha = FMath::FInterpTo(HandIK.LeftAlpha, TargetAlpha, DeltaTime, HandIKBlendSpeed);
+		HandIK.RightAlpha = FMath::FInterpTo(HandIK.RightAlpha, 0.f, DeltaTime, HandIKBlendSpeed);
+	}
+
+	Context.AnimInstance->SetWallrunHandIK(HandIK);
+
+	if (AParkourCharacter::IsDebugDrawEnabled() && bValid)
+	{
+		DrawDebugSphere(Context.Character->GetWorld(), OnWall, 5.0f, 8, FColor::Cyan);
+	}
+}
+
+bool UWallRunMechanic::CanStart(const FMechanicContext& Context) const
+{
+	if (!Super::CanStart(Context))
 	{
 		//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("False!"));
 		return false;
 	}
 
-	return Player->CanJump() || Player->GetMovementComponent()->IsJumpAllowed() && bIsWallRunning;
+	AParkourCharacter* Player = Context.Character;
+	return Player->CanJump() || Player->GetMovementComponent()->IsJumpAllowed() && Context.GetState<FWallRunMechanicState>().bIsWallRunning;
 }
 
-void UWallRunMechanic::BeginWallrun()
+void UWallRunMechanic::BeginWallrun(const FMechanicContext& Context) const
 {
 	//if(!bCanWallRun)
 	//{
 	//	return;
 	//}
 
-	SetWallRunOptions(WallRunGravityScale, bIsPlaneConstraintEnabled, WallRunConstrainNormal, false, true, WallRunCapsuleRadius, false);
+	FWallRunMechanicState& State = Context.GetState<FWallRunMechanicState>();
+
+	SetWallRunOptions(Context, WallRunGravityScale, false, true, WallRunCapsuleRadius, false);
+
+	// The wall run movement mode moves and turns the character along the wall from here on
+	Context.Character->GetParkourMovement()->StartWallRun(State.WallRunNormal);
 
-	bCanWallRun = false;
+	State.bCanWallRun = false;
 	
-	GetOwningComponent()->GetActiveTags().AppendTags(WallRunningTags);
+	Context.Component->AddActiveTags(State.WallRunningTagMask);
 
 	// Set Trace Forward
-	bForwardTrace = true;
+	State.bForwardTrace = true;
 
 	// Start Timeline
-	WallRunningTimeline.PlayFromStart();
+	State.ArcTimeline.PlayFromStart();
+
+	// Probe on the first wall running frame whatever the schedule was doing before
+	State.ProbeSchedule.Reset();
+
+	RefreshTick(Context);
 }
 
-bool UWallRunMechanic::ContinueWallRun() // very shoddy, redo completely.
+bool UWallRunMechanic::ContinueWallRun(const FMechanicContext& Context) const // very shoddy, redo completely.
 {
 	float DirectionFloat;
-	if (WallRunDirection == EDirection::Left)
+	if (Context.GetState<FWallRunMechanicState>().WallRunDirection == EDirection::Left)
 	{
 		DirectionFloat = 1.f;
 	}
@@ -304,85 +481,61 @@ bool UWallRunMechanic::ContinueWallRun() // very shoddy, redo completely.
 	}
 
 	//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, FString::Printf(TEXT("DirectionFloat = %f"), DirectionFloat));
-	//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, FString::Printf(TEXT("MoveValue = %f"), Player->GetPlayerMoveValue().X));
+	//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, FString::Printf(TEXT("MoveValue = %f"), GetPlayer()->GetPlayerMoveValue().X));
 	
-	if (FMath::IsNearlyEqual(Player->GetPlayerMoveValue().X, DirectionFloat) || Player->GetPlayerMoveValue().Y > 0)
+	if (FMath::IsNearlyEqual(Context.Character->GetPlayerMoveValue().X, DirectionFloat) || Context.Character->GetPlayerMoveValue().Y > 0)
 	{
 		return true;
 	}
 	return false;
 }
 
-void UWallRunMechanic::SetWallRunRotation()
-{
-	// make interpspeed a variable
-	Player->SetActorRotation(FMath::RInterpTo(Player->GetActorRotation(), FRotationMatrix::MakeFromX(WallRunNormal).Rotator(), GetWorld()->DeltaTimeSeconds, 15.f));
-}
-
-void UWallRunMechanic::SetWallRunOptions(float GravityScale, bool PlaneConstraintVal, FVector PlaneConstraintNormal,
-	bool OrientToMovement, bool Wallrunning, float CapsuleRadius, bool UsePawnRotation)
+void UWallRunMechanic::SetWallRunOptions(const FMechanicContext& Context, float GravityScale, bool OrientToMovement, bool Wallrunning, float CapsuleRadius, bool UsePawnRotation) const
 {
+	AParkourCharacter* Player = Context.Character;
 	Player->GetCharacterMovement()->GravityScale = GravityScale;
-	Player->GetCharacterMovement()->SetPlaneConstraintEnabled(PlaneConstraintVal);
-	Player->GetCharacterMovement()->SetPlaneConstraintNormal(PlaneConstraintNormal);
 	Player->GetCharacterMovement()->bOrientRotationToMovement = OrientToMovement;
 	Player->bUseControllerRotationYaw = UsePawnRotation;
-	bIsWallRunning = Wallrunning;
-	AnimInstance->SetIsWallrunning(Wallrunning);
-	Player->GetCapsuleComponent()->SetCapsuleRadius(CapsuleRadius);
+	Context.GetState<FWallRunMechanicState>().bIsWallRunning = Wallrunning;
+	Context.AnimInstance->SetIsWallrunning(Wallrunning);
+	Player->GetParkourMovement()->RequestCapsuleRadius(CapsuleRadius);
 }
 
-void UWallRunMechanic::EndWallrun()
+void UWallRunMechanic::EndWallrun(const FMechanicContext& Context) const
 {
 	//if (bCanWallRun)
 	//{
 	//	return;
 	//}
 
-	SetWallRunOptions(1.25f, false, FVector(0,0,0), true, false, Player->GetCapsuleFull().X, true); // make grav scale a variable in player
+	FWallRunMechanicState& State = Context.GetState<FWallRunMechanicState>();
+
+	Context.Character->GetParkourMovement()->StopWallRun();
+	SetWallRunOptions(Context, 1.25f, true, false, Context.Character->GetCapsuleFull().X, true); // make grav scale a variable in player
 	
-	bCanWallRun = true;
+	State.bCanWallRun = true;
 	
 	
-	bForwardTrace = false;
+	State.bForwardTrace = false;
 
 	// Reset Variables - Maybe not needed
-	WallRunHandIK_Location = FVector(0,0,0);
-	WallRunHandIK_LeftAlpha = 0.f;
-	WallRunHandIK_RightLocation = FVector(0,0,0);
-	WallRunHandIK_RightAlpha = 0.f;
-	AnimInstance->ResetIK();
+	State.HandIK = FWallRunHandIK();
+	Context.AnimInstance->ResetIK();
 
 	// Stop Arcing Timeline
-	WallRunningTimeline.Stop();
+	State.ArcTimeline.Stop();
+
+	State.GeneratedWall = nullptr;
 
-	GetOwningComponent()->GetActiveTags().RemoveTags(WallRunningTags);
+	Context.Component->RemoveActiveTags(State.WallRunningTagMask);
 }
 
 // Maybe not needed - can move to tick or something?
-void UWallRunMechanic::TimelineArcUpdate(float Value)
+void UWallRunMechanic::TimelineArcUpdate(const FMechanicContext& Context, float Value) const
 {
-	// Add actor world offset
-	Player->AddActorWorldOffset(FVector(0,0,Value));
+	// Rise along the arc, applied in the wall run mode's next move
+	Context.Character->GetParkourMovement()->AddWallRunRise(Value);
 
 	// Lerp speed to slow down over time.
-	Player->GetCharacterMovement()->MaxWalkSpeed = FMath::Lerp(600, 500, Value); // make variable for speeds (in player perhaps).
-}
-
-void UWallRunMechanic::TimelineArcComplete(float Value)
-{
-	if (bApplyGravity) // if gravity is to be applied
-	{
-		return;
-	}
-}
-
-void UWallRunMechanic::GravityUpdate(float Value)
-{
-	Player->AddActorWorldOffset(FVector(0,0,-1));
-}
-
-void UWallRunMechanic::ShouldForwardTrace()
-{
-	bForwardTrace = true;
+	Context.Character->GetCharacterMovement()->MaxWalkSpeed = FMath::Lerp(600, 500, Value); // make variable for speeds (in player perhaps).
 }
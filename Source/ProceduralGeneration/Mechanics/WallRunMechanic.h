@@ -6,13 +6,59 @@
 #include "ProceduralGeneration/Mechanics/BaseMechanic.h"
 #include <GameFramework/CharacterMovementComponent.h>
 
-#include "Components/TimelineComponent.h"
+#include "Engine/OverlapResult.h"
 #include "ProceduralGeneration/AnimationInstance/PAnimInstance.h"
 #include "ProceduralGeneration/PGameTags.h"
+#include "Procedural Generation/GeneratedGeometry.h"
+#include "ProceduralGeneration/MechanicComponents/ParkourProbeSchedule.h"
 #include "WallRunMechanic.generated.h"
 
 class AParkourCharacter;
 
+// One character's wall run, the definition holds the tunables, curves and montages
+USTRUCT()
+struct PROCEDURALGENERATION_API FWallRunMechanicState
+{
+	GENERATED_BODY()
+
+	FMechanicTagMask WallRunningTagMask;
+
+	// Looked up when the mechanic is added, lives as long as the character's world
+	UGeneratedGeometrySubsystem* GeneratedGeometry = nullptr;
+
+	// Generated wall the current run started on, null for walls placed by hand
+	const AActor* GeneratedWall = nullptr;
+	bool bProbeGeneratedGeometry = false;
+
+	FParkourProbeSchedule ProbeSchedule;
+
+	// Kept between frames so gathering doesn't allocate, components are only used by the tick that gathered them
+	TArray<FOverlapResult> WallProbeOverlaps;
+	TArray<UPrimitiveComponent*> WallProbeComponents;
+
+	bool bIsWallRunning = false;
+	bool bCanWallRun = true;
+
+	FVector WallRunNormal = FVector::ZeroVector;
+
+	// Plane and extents of whichever wall we are running along, updated by the wall normal probe
+	FPlane WallPlane = FPlane(ForceInit);
+	FGeneratedBox WallBounds;
+
+	// Forward Trace
+	bool bForwardTrace = false;
+	// Seconds until the forward trace is turned on after starting, 0 when not counting down
+	float ForwardTraceDelay = 0.0f;
+
+	FWallRunHandIK HandIK;
+
+	// Wallrun arc timeline
+	FMechanicTimeline ArcTimeline;
+
+	// Direction Enum
+	TEnumAsByte<EDirection> WallRunDirection = EDirection::Left;
+};
+
 /**
  * 
  */
@@ -24,81 +70,75 @@ class PROCEDURALGENERATION_API UWallRunMechanic : public UBaseMechanic
 public:
 	UWallRunMechanic();
 	
-	virtual void OnMechanicAdded_Implementation(AActor* Actor) override;
-	virtual void OnMechanicRemoved_Implementation(AActor* Actor) override;
+	virtual void OnMechanicAdded(const FMechanicContext& Context) const override;
 
-	//virtual void Tick_Implementation
-	UFUNCTION() void OnCapsuleComponentHit(UPrimitiveComponent* HitComponent, AActor* OtherActor,UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+	// Starts a wall run when the character hits a wall while falling
+	virtual void OnOwnerHit(const FMechanicContext& Context, AActor* OtherActor, UPrimitiveComponent* OtherComp, const FHitResult& Hit) const override;
 
-	virtual void StartMechanic_Implementation(AActor* Actor) override;
-	virtual void StopMechanic_Implementation(AActor* Actor) override;
-	virtual void TickMechanic_Implementation(float DeltaTime) override;
-	virtual bool CanStart_Implementation(AActor* Actor) override;
+	virtual void StartMechanic(const FMechanicContext& Context) const override;
+	virtual void StopMechanic(const FMechanicContext& Context) const override;
+	virtual void TickStates(FMechanicStateBatch& Batch, TConstArrayView<int32> Indices) const override;
+	virtual bool CanStart(const FMechanicContext& Context) const override;
+
+	virtual const UScriptStruct* GetStateStruct() const override;
 	
-	void BeginWallrun();
-	bool ContinueWallRun();
-	void SetWallRunRotation();
-	void SetWallRunOptions(float GravityScale, bool PlaneConstraintVal, FVector PlaneConstraintNormal, bool OrientToMovement, bool Wallrunning, float CapsuleRadius, bool UsePawnRotation);
-	void EndWallrun();
+	void BeginWallrun(const FMechanicContext& Context) const;
+	bool ContinueWallRun(const FMechanicContext& Context) const;
+	void SetWallRunOptions(const FMechanicContext& Context, float GravityScale, bool OrientToMovement, bool Wallrunning, float CapsuleRadius, bool UsePawnRotation) const;
+	void EndWallrun(const FMechanicContext& Context) const;
 
 	// Timeline Update Function
-	UFUNCTION() void TimelineArcUpdate(float Value);
-	UFUNCTION() void TimelineArcComplete(float Value);
-	// Gravity
-	void GravityUpdate(float Value);
-
-	// Forward Trace
-	UFUNCTION() void ShouldForwardTrace();
+	void TimelineArcUpdate(const FMechanicContext& Context, float Value) const;
 
 protected:
-	
-	UPROPERTY() AParkourCharacter* Player;
-	UPROPERTY() UPAnimInstance* AnimInstance;
-	UPROPERTY() UMovementComponent* MovementComp;
+	// Capsule hits start a wall run without starting the mechanic, so tick for as long as one is going
+	virtual bool WantsTick(const FMechanicContext& Context) const override;
+
+	// One character's tick, TickStates runs it for each character due
+	void TickState(const FMechanicContext& Context, float DeltaTime) const;
+
+	// Feet, ground, ahead and wall normal probes, false when the wall run should end
+	bool ProbeWall(const FMechanicContext& Context) const;
+
+	// The wall run probes (feet, ground, ahead and wall normal) all fall inside one box around the
+	// character. A single overlap gathers the blocking components in it and each probe is then tested
+	// against those components only, so a wall running frame costs one scene query. On a wall the
+	// generators registered the probes are answered from the generated boxes with no scene query at all.
+	void GatherWallProbeComponents(const FMechanicContext& Context) const;
+	bool ProbeSweep(FWallRunMechanicState& State, FHitResult& OutHit, const FVector& Start, const FVector& End, const FCollisionShape& Shape) const;
+	bool ProbeOverlap(const FWallRunMechanicState& State, const FVector& Position, const FCollisionShape& Shape) const;
+	bool ProbeLine(FWallRunMechanicState& State, FHitResult& OutHit, const FVector& Start, const FVector& End, FGeneratedBox* OutWall = nullptr) const;
+
+	// Projects the wall side shoulder onto the cached wall plane and blends the hand towards it while the
+	// point is within the wall's edges
+	void UpdateHandIK(const FMechanicContext& Context, float DeltaTime) const;
+
+	// Furthest the wall normal probe reaches from the character
+	static constexpr float WallProbeReach = 200.0f;
 
 	UPROPERTY(EditDefaultsOnly, Category = "Traversal") FGameplayTagContainer WallRunningTags;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true"), Category = "WallRun Options") float WallRunGravityScale;
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true"), Category = "WallRun Options") bool bIsPlaneConstraintEnabled;
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true"), Category = "WallRun Options") FVector WallRunConstrainNormal;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true"), Category = "WallRun Options") bool bShouldPlayerOrientToMovement;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = "true"), Category = "WallRun Options") float WallRunCapsuleRadius;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "WallRun Options") bool bIsWallRunning;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "WallRun Options") bool bApplyGravity;
 
-	UPROPERTY() FVector WallRunNormal;
-	bool bCanWallRun = true;
-
 	// Variables for wall run speed, angles, forces (maybe move to custom character component
 	UPROPERTY(EditDefaultsOnly) float MinWallRunSpeed;
 	UPROPERTY(EditDefaultsOnly) float MaxWallRunSpeed;
 	UPROPERTY(EditDefaultsOnly) float WallJumpOffForce = 350.f;
-
-	// Normal of whichever wall we are running along
-	FVector WallSurfaceNormal;
 	
 	// Animations for right wall run
 	UPROPERTY(EditAnywhere, Category = "Animation") UAnimMontage* RightWallMontage;
-	
-	// Forward Trace
-	bool bForwardTrace;
-	// Timer for forward trace bool
-	UPROPERTY() FTimerHandle ForwardTraceDelay;
-
-	// Hand IK positions
-	FVector WallRunHandIK_Location;
-	float WallRunHandIK_LeftAlpha;
-	FVector WallRunHandIK_RightLocation;
-	float WallRunHandIK_RightAlpha;
-
-	// Wallrun timeline
-	UPROPERTY() FTimeline WallRunningTimeline;
+
+	// Hand IK - shoulders rather than hands are projected, the hand bones already carry last frame's IK
+	UPROPERTY(EditDefaultsOnly, Category = "Hand IK") FName LeftShoulderSocket = TEXT("upperarm_l");
+	UPROPERTY(EditDefaultsOnly, Category = "Hand IK") FName RightShoulderSocket = TEXT("upperarm_r");
+	UPROPERTY(EditDefaultsOnly, Category = "Hand IK") float HandWallOffset = 5.f;
+	UPROPERTY(EditDefaultsOnly, Category = "Hand IK") float HandIKReach = 80.f;
+	UPROPERTY(EditDefaultsOnly, Category = "Hand IK") float HandIKBlendSpeed = 10.f;
+
 	UPROPERTY(EditAnywhere, Category = "Timeline Float") UCurveFloat* WallRunArcCurve;
-	// Gravity Scale Timeline
-	UPROPERTY() FTimeline GravityScaleTimeline;
 	UPROPERTY(EditAnywhere, Category = "Timeline Float") UCurveFloat* WallRunGravityCurve;
-
-	// Direction Enum
-	UPROPERTY() TEnumAsByte<EDirection> WallRunDirection;
 };
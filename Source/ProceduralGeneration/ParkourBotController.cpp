@@ -0,0 +1,424 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourBotController.h"
+#include "ParkourCharacter.h"
+#include "ProcGenTrace.h"
+#include "ParkourQueries.h"
+#include "MechanicComponents/MechanicsComponent.h"
+#include "MechanicComponents/ParkourProbeSchedule.h"
+#include "Procedural Generation/GrammarGenerator.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "InputActionValue.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "RenderCore.h"
+
+CSV_DEFINE_CATEGORY(ParkourBot, true);
+
+AParkourBotController::AParkourBotController()
+{
+	PrimaryActorTick.bCanEverTick = true;
+}
+
+void AParkourBotController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Generator = Cast<AGrammarGenerator>(UGameplayStatics::GetActorOfClass(this, AGrammarGenerator::StaticClass()));
+	if (!Generator)
+	{
+		UE_LOG(LogProcGen, Warning, TEXT("Parkour bot found no grammar generator to follow"));
+	}
+}
+
+void AParkourBotController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Keep what the run got through if it's cut short
+	if (!bFinished && PlatformIndex != INDEX_NONE)
+	{
+		EndSegment(false);
+		WriteSegments();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AParkourBotController::OnPossess(APawn* InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	ParkourCharacter = Cast<AParkourCharacter>(InPawn);
+	if (!ParkourCharacter)
+	{
+		UE_LOG(LogProcGen, Warning, TEXT("Parkour bot can only drive a parkour character"));
+		return;
+	}
+
+	ParkourCharacter->MechanicComponent->OnMechanicStarted.AddUObject(this, &AParkourBotController::OnMechanicStarted);
+}
+
+void AParkourBotController::OnUnPossess()
+{
+	if (ParkourCharacter)
+	{
+		ParkourCharacter->MechanicComponent->OnMechanicStarted.RemoveAll(this);
+		ParkourCharacter = nullptr;
+	}
+
+	Super::OnUnPossess();
+}
+
+void AParkourBotController::OnMechanicStarted(FGameplayTag MechanicTag)
+{
+	++Current.MechanicStarts;
+}
+
+void AParkourBotController::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (bFinished || !ParkourCharacter || !Generator)
+	{
+		return;
+	}
+
+	// The generator may not have built its level on the first frame
+	if (PlatformIndex == INDEX_NONE)
+	{
+		RefreshPlatforms();
+		if (Platforms.Num() < 2)
+		{
+			return;
+		}
+
+		if (MaxFrameRate > 0.0f)
+		{
+			GEngine->SetMaxFPS(MaxFrameRate);
+		}
+
+#if CSV_PROFILER
+		if (bCaptureCsv && !FCsvProfiler::Get()->IsCapturing())
+		{
+			FCsvProfiler::Get()->BeginCapture();
+			bStartedCsvCapture = true;
+		}
+#endif
+
+		UE_LOG(LogProcGen, Log, TEXT("Parkour bot starting a run over %d platforms (seed %d)"), Platforms.Num(), Generator->GetLastReport().Seed);
+		PlacePawnOnPlatform(0);
+		BeginSegment(0);
+		return;
+	}
+
+	const double FrameMs = FApp::GetDeltaTime() * 1000.0;
+	const uint32 FrameQueries = ParkourQueries::GetTotal() - LastFrameQueries;
+	LastFrameQueries = ParkourQueries::GetTotal();
+
+	++Current.Frames;
+	Current.Seconds += DeltaSeconds;
+	Current.FrameMsTotal += FrameMs;
+	Current.FrameMsMax = FMath::Max(Current.FrameMsMax, FrameMs);
+	Current.GameThreadMsTotal += FPlatformTime::ToMilliseconds(GGameThreadTime);
+
+	CSV_CUSTOM_STAT(ParkourBot, Segment, Current.Index, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ParkourBot, Queries, static_cast<int32>(FrameQueries), ECsvCustomStatOp::Set);
+
+	// Vaults and mantles aren't mechanics, count them off the character
+	if (ParkourCharacter->bIsPerformingAction && !bWasPerformingAction)
+	{
+		++Current.Interactions;
+	}
+	bWasPerformingAction = ParkourCharacter->bIsPerformingAction;
+
+	if (ParkourCharacter->GetActorLocation().Z < CurrentBounds.Min.Z - FallRecoverDepth)
+	{
+		++Current.Falls;
+		PlacePawnOnPlatform(PlatformIndex);
+		return;
+	}
+
+	const int32 FloorIndex = FindFloorPlatform();
+	if (FloorIndex != INDEX_NONE)
+	{
+		AdvanceTo(Platforms[FloorIndex], false);
+		return;
+	}
+
+	if (Current.Seconds > SegmentTimeout)
+	{
+		AActor* Target = Platforms[PlatformIndex + 1];
+		UE_LOG(LogProcGen, Log, TEXT("Parkour bot timed out on segment %d, skipping ahead"), Current.Index);
+		AdvanceTo(Target, true);
+		if (!bFinished)
+		{
+			PlacePawnOnPlatform(PlatformIndex);
+		}
+		return;
+	}
+
+	DriveInput(DeltaSeconds);
+}
+
+void AParkourBotController::DriveInput(float DeltaSeconds)
+{
+	UCharacterMovementComponent* Movement = ParkourCharacter->GetCharacterMovement();
+	const FVector Location = ParkourCharacter->GetActorLocation();
+	const FVector TargetPoint(TargetBounds.GetCenter().X, TargetBounds.GetCenter().Y, TargetBounds.Max.Z);
+
+	FVector ToTarget = TargetPoint - Location;
+	ToTarget.Z = 0.0;
+	const double Distance = ToTarget.Size();
+	const FVector Direction = ToTarget.GetSafeNormal();
+
+	// Move reads the control rotation, so face the target and push forward like a stick would
+	SetControlRotation(FRotator(0.0, Direction.Rotation().Yaw, 0.0));
+	ParkourCharacter->Move(FInputActionValue(FVector2D(0.0, 1.0)));
+
+	if (!ParkourCharacter->GetSprinting())
+	{
+		ParkourCharacter->StartSprint();
+	}
+
+	const bool bOnGround = Movement->IsMovingOnGround();
+
+	// Releasing the jump is what ends a wall run
+	if (bJumpHeld && bOnGround)
+	{
+		ParkourCharacter->StopJumpCheck();
+		bJumpHeld = false;
+	}
+
+	if (SlideTimeRemaining > 0.0f)
+	{
+		SlideTimeRemaining -= DeltaSeconds;
+		if (SlideTimeRemaining <= 0.0f)
+		{
+			ParkourCharacter->StopCrouch();
+		}
+	}
+
+	const FVector Ahead = Location + Direction * JumpLookahead;
+	const bool bLeavingPlatform = !CurrentBounds.IsInsideXY(Ahead) && !TargetBounds.IsInsideXY(Ahead);
+
+	if (bOnGround && !bJumpHeld && bLeavingPlatform)
+	{
+		if (SlideTimeRemaining > 0.0f)
+		{
+			SlideTimeRemaining = 0.0f;
+			ParkourCharacter->StopCrouch();
+		}
+
+		// Same as pressing jump, which also tries to start a wall run
+		ParkourCharacter->Jump();
+		ParkourCharacter->StartJumpCheck();
+		bJumpHeld = true;
+		++Current.Jumps;
+	}
+	else if (bOnGround && !bSlidThisSegment && SlideMinDistance > 0.0f && Distance > SlideMinDistance && CurrentBounds.IsInsideXY(Ahead))
+	{
+		ParkourCharacter->StartCrouch();
+		SlideTimeRemaining = SlideDuration;
+		bSlidThisSegment = true;
+	}
+
+	InteractCooldown -= DeltaSeconds;
+	const double TargetHeight = TargetBounds.Max.Z - Movement->GetActorFeetLocation().Z;
+	if (InteractCooldown <= 0.0f && TargetHeight > InteractHeight && Distance < InteractDistance)
+	{
+		ParkourCharacter->Interact();
+		InteractCooldown = InteractInterval;
+	}
+}
+
+void AParkourBotController::RefreshPlatforms()
+{
+	AActor* CurrentPlatform = Platforms.IsValidIndex(PlatformIndex) ? Platforms[PlatformIndex] : nullptr;
+
+	Platforms = Generator->GetPlacedPlatforms();
+
+	// Endless runs recycle the front of the window, so find where we are again
+	if (CurrentPlatform)
+	{
+		PlatformIndex = Platforms.IndexOfByKey(CurrentPlatform);
+	}
+}
+
+int32 AParkourBotController::FindFloorPlatform() const
+{
+	const UCharacterMovementComponent* Movement = ParkourCharacter->GetCharacterMovement();
+	if (!Movement->IsMovingOnGround())
+	{
+		return INDEX_NONE;
+	}
+
+	const AActor* Floor = Movement->CurrentFloor.HitResult.GetActor();
+	if (!Floor)
+	{
+		return INDEX_NONE;
+	}
+
+	// Only count progress, standing back on an earlier platform doesn't restart its segment
+	for (int32 Index = PlatformIndex + 1; Index < Platforms.Num(); ++Index)
+	{
+		if (Platforms[Index] == Floor)
+		{
+			return Index;
+		}
+	}
+	return INDEX_NONE;
+}
+
+void AParkourBotController::BeginSegment(int32 Index)
+{
+	PlatformIndex = Index;
+
+	FVector Origin;
+	FVector Extent;
+	Platforms[Index]->GetActorBounds(true, Origin, Extent);
+	CurrentBounds = FBox::BuildAABB(Origin, Extent);
+	Platforms[Index + 1]->GetActorBounds(true, Origin, Extent);
+	TargetBounds = FBox::BuildAABB(Origin, Extent);
+
+	Current = FParkourBotSegment();
+	Current.Index = Segments.Num();
+	SegmentStartQueries = ParkourQueries::GetTotal();
+	LastFrameQueries = SegmentStartQueries;
+	bSlidThisSegment = false;
+
+	CSV_EVENT(ParkourBot, TEXT("Segment %d"), Current.Index);
+	PROCGEN_TRACE_BOOKMARK(TEXT("Bot segment %d"), Current.Index);
+}
+
+void AParkourBotController::EndSegment(bool bSkipped)
+{
+	Current.bSkipped = bSkipped;
+	Current.Queries = ParkourQueries::GetTotal() - SegmentStartQueries;
+	Segments.Add(Current);
+
+	UE_LOG(LogProcGen, Verbose, TEXT("Bot segment %d: %.2fs, %.2fms avg frame, %u queries (%.0f/s), %d mechanic starts%s"),
+		Current.Index, Current.Seconds, Current.Frames > 0 ? Current.FrameMsTotal / Current.Frames : 0.0,
+		Current.Queries, Current.Seconds > 0.0 ? Current.Queries / Current.Seconds : 0.0, Current.MechanicStarts,
+		bSkipped ? TEXT(", skipped") : TEXT(""));
+}
+
+void AParkourBotController::AdvanceTo(AActor* Platform, bool bSkipped)
+{
+	EndSegment(bSkipped);
+
+	// Endless chains grow and recycle as the pawn moves, so take a fresh copy once per segment
+	RefreshPlatforms();
+
+	const int32 Index = Platforms.IndexOfByKey(Platform);
+	if (Index == INDEX_NONE || Index + 1 >= Platforms.Num() || Segments.Num() >= MaxSegments)
+	{
+		PlatformIndex = Index;
+		FinishRun();
+		return;
+	}
+
+	BeginSegment(Index);
+}
+
+void AParkourBotController::PlacePawnOnPlatform(int32 Index)
+{
+	FVector Origin;
+	FVector Extent;
+	Platforms[Index]->GetActorBounds(true, Origin, Extent);
+
+	ParkourCharacter->GetCharacterMovement()->StopMovementImmediately();
+	ParkourCharacter->SetActorLocation(FVector(Origin.X, Origin.Y, Origin.Z + Extent.Z + 100.0), false, nullptr, ETeleportType::ResetPhysics);
+}
+
+void AParkourBotController::FinishRun()
+{
+	bFinished = true;
+
+	if (bJumpHeld)
+	{
+		ParkourCharacter->StopJumpCheck();
+		bJumpHeld = false;
+	}
+	if (SlideTimeRemaining > 0.0f)
+	{
+		ParkourCharacter->StopCrouch();
+		SlideTimeRemaining = 0.0f;
+	}
+	ParkourCharacter->StopSprint();
+
+	double Seconds = 0.0;
+	int32 Frames = 0;
+	double FrameMsTotal = 0.0;
+	uint64 Queries = 0;
+	int32 Skipped = 0;
+	for (const FParkourBotSegment& Segment : Segments)
+	{
+		Seconds += Segment.Seconds;
+		Frames += Segment.Frames;
+		FrameMsTotal += Segment.FrameMsTotal;
+		Queries += Segment.Queries;
+		Skipped += Segment.bSkipped ? 1 : 0;
+	}
+
+	UE_LOG(LogProcGen, Log, TEXT("Parkour bot finished: %d segments (%d skipped) in %.1fs, %.2fms avg frame"),
+		Segments.Num(), Skipped, Seconds, Frames > 0 ? FrameMsTotal / Frames : 0.0);
+
+	// The probe rate comparison, run again with a different -ParkourBotFPS or p.Parkour.ProbeRate
+	const float ProbeInterval = FParkourProbeSchedule::GetInterval();
+	UE_LOG(LogProcGen, Log, TEXT("Parkour bot queries: %.0f/s at %.0f fps, probe rate %s"),
+		Seconds > 0.0 ? Queries / Seconds : 0.0, Seconds > 0.0 ? Frames / Seconds : 0.0,
+		ProbeInterval > 0.0f ? *FString::Printf(TEXT("%.0f Hz"), 1.0f / ProbeInterval) : TEXT("every frame"));
+
+	if (MaxFrameRate > 0.0f)
+	{
+		GEngine->SetMaxFPS(0.0f);
+	}
+
+	WriteSegments();
+
+#if CSV_PROFILER
+	if (bStartedCsvCapture)
+	{
+		FCsvProfiler::Get()->EndCapture();
+		bStartedCsvCapture = false;
+	}
+#endif
+
+	if (bExitWhenFinished)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+bool AParkourBotController::WriteSegments(const FString& Filename) const
+{
+	FString Path = Filename;
+	if (Path.IsEmpty())
+	{
+		const int32 Seed = Generator ? Generator->GetLastReport().Seed : 0;
+		Path = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ProcGen"),
+			FString::Printf(TEXT("ParkourBot_%d_%s.csv"), Seed, *FDateTime::Now().ToString()));
+	}
+
+	FString Csv = TEXT("Segment,Seconds,Frames,AvgFrameMs,MaxFrameMs,AvgGameThreadMs,Queries,QueriesPerSecond,MechanicStarts,Interactions,Jumps,Falls,Skipped\n");
+	for (const FParkourBotSegment& Segment : Segments)
+	{
+		const double Frames = FMath::Max(Segment.Frames, 1);
+		Csv += FString::Printf(TEXT("%d,%.3f,%d,%.3f,%.3f,%.3f,%u,%.1f,%d,%d,%d,%d,%d\n"),
+			Segment.Index, Segment.Seconds, Segment.Frames, Segment.FrameMsTotal / Frames, Segment.FrameMsMax,
+			Segment.GameThreadMsTotal / Frames, Segment.Queries, Segment.Seconds > 0.0 ? Segment.Queries / Segment.Seconds : 0.0,
+			Segment.MechanicStarts, Segment.Interactions, Segment.Jumps, Segment.Falls, Segment.bSkipped ? 1 : 0);
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *Path))
+	{
+		UE_LOG(LogProcGen, Warning, TEXT("Failed to write bot capture %s"), *Path);
+		return false;
+	}
+
+	UE_LOG(LogProcGen, Log, TEXT("Wrote bot capture %s"), *Path);
+	return true;
+}
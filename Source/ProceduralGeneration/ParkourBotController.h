@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "GameplayTagContainer.h"
+#include "ParkourBotController.generated.h"
+
+class AGrammarGenerator;
+class AParkourCharacter;
+
+// Performance numbers for one platform to platform segment of a bot run
+struct FParkourBotSegment
+{
+	int32 Index = 0;
+	double Seconds = 0.0;
+	int32 Frames = 0;
+	double FrameMsTotal = 0.0;
+	double FrameMsMax = 0.0;
+	double GameThreadMsTotal = 0.0;
+	uint32 Queries = 0;
+	int32 MechanicStarts = 0;
+	int32 Interactions = 0;
+	int32 Jumps = 0;
+	int32 Falls = 0;
+	bool bSkipped = false;
+};
+
+/**
+ * Plays through the grammar generator's platform chain with the character's own input handlers, so
+ * movement, jumping, wall running, sliding and vault/mantle all run the same code a player hits.
+ * Each platform to platform segment records frame time, game thread time, collision queries and
+ * mechanic activations, written to Saved/ProcGen as CSV when the run ends.
+ *
+ * The game mode possesses the player's pawn with this when the game is started with -ParkourBot, e.g.
+ *   -game -nullrhi -ParkourBot -csvCapture -trace=cpu,frame,bookmark,ProcGen
+ * Each segment is also marked in the CSV profiler capture. Add -ParkourBotFPS=144 and
+ * -ini:Engine:[ConsoleVariables]:p.Parkour.ProbeRate=30 to measure queries per second at a given frame rate.
+ */
+UCLASS()
+class PROCEDURALGENERATION_API AParkourBotController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+	AParkourBotController();
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	FORCEINLINE const TArray<FParkourBotSegment>& GetSegments() const { return Segments; }
+
+	// Writes the per segment CSV, an empty filename uses Saved/ProcGen/ParkourBot_<Seed>_<Timestamp>.csv
+	bool WriteSegments(const FString& Filename = FString()) const;
+
+	// Start jumping this far before running off the current platform
+	UPROPERTY(EditAnywhere, Category = "Bot") float JumpLookahead = 150.0f;
+
+	// Try to vault or mantle when the next platform's top is this far above the feet
+	UPROPERTY(EditAnywhere, Category = "Bot") float InteractHeight = 60.0f;
+	UPROPERTY(EditAnywhere, Category = "Bot") float InteractDistance = 250.0f;
+
+	// Slide on segments longer than this, 0 disables sliding
+	UPROPERTY(EditAnywhere, Category = "Bot") float SlideMinDistance = 1200.0f;
+	UPROPERTY(EditAnywhere, Category = "Bot") float SlideDuration = 0.75f;
+
+	// Put the pawn back on the current platform after dropping this far below it
+	UPROPERTY(EditAnywhere, Category = "Bot") float FallRecoverDepth = 1500.0f;
+
+	// Skip to the next platform when a segment takes longer than this
+	UPROPERTY(EditAnywhere, Category = "Bot") float SegmentTimeout = 20.0f;
+
+	// Endless runs stop after this many segments
+	UPROPERTY(EditAnywhere, Category = "Bot") int32 MaxSegments = 200;
+
+	// Seconds between vault/mantle attempts, each one runs the full trace set
+	UPROPERTY(EditAnywhere, Category = "Bot") float InteractInterval = 0.25f;
+
+	// Quit once the run is done, set when started from the command line
+	UPROPERTY(EditAnywhere, Category = "Bot") bool bExitWhenFinished = false;
+
+	// Start a CSV profiler capture for the run if one isn't already going
+	UPROPERTY(EditAnywhere, Category = "Bot") bool bCaptureCsv = false;
+
+	// Caps the frame rate for the run when above 0, so queries per second can be compared across frame
+	// rates and p.Parkour.ProbeRate settings. Set with -ParkourBotFPS=<rate> from the command line.
+	UPROPERTY(EditAnywhere, Category = "Bot") float MaxFrameRate = 0.0f;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void OnPossess(APawn* InPawn) override;
+	virtual void OnUnPossess() override;
+
+	void OnMechanicStarted(FGameplayTag MechanicTag);
+
+	void RefreshPlatforms();
+	void BeginSegment(int32 Index);
+	void EndSegment(bool bSkipped);
+	void AdvanceTo(AActor* Platform, bool bSkipped);
+	void FinishRun();
+
+	void PlacePawnOnPlatform(int32 Index);
+	int32 FindFloorPlatform() const;
+	void DriveInput(float DeltaSeconds);
+
+	UPROPERTY() AGrammarGenerator* Generator;
+	UPROPERTY() AParkourCharacter* ParkourCharacter;
+
+	// Copy of the generator's chain, refreshed once per segment
+	UPROPERTY() TArray<AActor*> Platforms;
+
+	TArray<FParkourBotSegment> Segments;
+	FParkourBotSegment Current;
+	FBox CurrentBounds = FBox(ForceInit);
+	FBox TargetBounds = FBox(ForceInit);
+
+	// Index into Platforms of the platform the segment starts from
+	int32 PlatformIndex = INDEX_NONE;
+	uint32 SegmentStartQueries = 0;
+	uint32 LastFrameQueries = 0;
+	float SlideTimeRemaining = 0.0f;
+	float InteractCooldown = 0.0f;
+	bool bSlidThisSegment = false;
+	bool bJumpHeld = false;
+	bool bWasPerformingAction = false;
+	bool bStartedCsvCapture = false;
+	bool bFinished = false;
+};
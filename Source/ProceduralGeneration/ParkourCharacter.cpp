@@ -9,6 +9,12 @@
 #include "GameplayTagContainer.h"
 
 #include "ProceduralGeneration/MechanicComponents/MechanicsComponent.h"
+#include "ProceduralGeneration/MechanicComponents/ParkourMovementComponent.h"
+#include "ProceduralGeneration/MechanicComponents/ParkourSensingComponent.h"
+#include "ProceduralGeneration/Mechanics/SlideMechanic.h"
+#include "ProceduralGeneration/ProcGenMemory.h"
+#include "ProceduralGeneration/ProcGenTrace.h"
+#include "ProceduralGeneration/ProcGen_GameModeBase.h"
 
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
@@ -20,9 +26,18 @@
 #include "MotionWarpingComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 
+static TAutoConsoleVariable<bool> CVarParkourDebugDraw(
+	TEXT("p.Parkour.DebugDraw"),
+	false,
+	TEXT("Draws the vault, mantle and wall run traces"),
+	ECVF_Cheat);
+
 // Sets default values
-AParkourCharacter::AParkourCharacter()
+AParkourCharacter::AParkourCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UParkourMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
+	ParkourMovement = Cast<UParkourMovementComponent>(GetCharacterMovement());
+
 	// assign capsule variables
 	FullCapsule = FVector2f(42.f, 96.0f);
 	HalfCapsule = FVector2f(FullCapsule.X / 2, FullCapsule.Y / 2);
@@ -58,6 +73,8 @@ AParkourCharacter::AParkourCharacter()
 
 	MechanicComponent = CreateDefaultSubobject<UMechanicsComponent>(TEXT("Mechanic Component"));
 
+	ParkourSensing = CreateDefaultSubobject<UParkourSensingComponent>(TEXT("Parkour Sensing"));
+
 	// speed setting
 	WalkSpeed = 300.f;
 	RunSpeed = 600.f;
@@ -81,6 +98,7 @@ void AParkourCharacter::BeginPlay()
 	Super::BeginPlay();
 
 	AnimInstance = Cast<UPAnimInstance>(GetMesh()->GetAnimInstance());
+	MotionWarping = FindComponentByClass<UMotionWarpingComponent>();
 	
 	//Add Input Mapping Context
 	if (APlayerController* PlayerController = Cast<APlayerController>(Controller))
@@ -99,7 +117,22 @@ void AParkourCharacter::BeginPlay()
 	}
 
 	Delegate.BindUFunction(this, "Interact"); 
-	GetWorld()->GetTimerManager().SetTimer(TimerHandle_Parkour, Delegate, 0.1f, true);
+	GetWorld()->GetTimerManager().SetTimer(TimerHandle_Parkour, Delegate, ParkourProbeInterval, true);
+
+	// The starting mechanics were added by the component's BeginPlay
+	MechanicComponent->OnMechanicsChanged.AddUObject(this, &AParkourCharacter::CacheMechanics);
+	CacheMechanics();
+}
+
+void AParkourCharacter::CacheMechanics()
+{
+	SlideMechanic = MechanicComponent->FindMechanic(SlideMechanicTag);
+	WallRunMechanic = MechanicComponent->FindMechanic(WallRunMechanicTag);
+}
+
+USlideMechanic* AParkourCharacter::GetSlideMechanic() const
+{
+	return Cast<USlideMechanic>(SlideMechanic);
 }
 
 void AParkourCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
@@ -165,6 +198,23 @@ void AParkourCharacter::Landed(const FHitResult& Hit)
 	CheckForFall();
 	
 	Super::Landed(Hit);
+
+	if (AProcGen_GameModeBase* GameMode = GetWorld()->GetAuthGameMode<AProcGen_GameModeBase>())
+	{
+		GameMode->NotifyPawnLanded(this, Hit);
+	}
+}
+
+void AParkourCharacter::FellOutOfWorld(const UDamageType& DmgType)
+{
+	// Back onto a checkpoint instead of being destroyed
+	AProcGen_GameModeBase* GameMode = GetWorld()->GetAuthGameMode<AProcGen_GameModeBase>();
+	if (GameMode && GameMode->RespawnFallenPawn(this))
+	{
+		return;
+	}
+
+	Super::FellOutOfWorld(DmgType);
 }
 
 void AParkourCharacter::OnFallMontageEnded(UAnimMontage* Montage, bool bInterrupted)
@@ -187,6 +237,9 @@ void AParkourCharacter::OnFallMontageEnded(UAnimMontage* Montage, bool bInterrup
 
 void AParkourCharacter::Move(const FInputActionValue& Value)
 {
+	LLM_SCOPE_BYTAG(ProcGen_Character);
+	PROCGEN_ALLOC_AUDIT_SCOPE(AParkourCharacter_Move);
+
 	// input is a Vector2D
 	CurrentMoveVector = Value.Get<FVector2D>();
 
@@ -205,12 +258,6 @@ void AParkourCharacter::Move(const FInputActionValue& Value)
 		// add movement 
 		AddMovementInput(ForwardDirection, CurrentMoveVector.Y);
 
-		// Log the tags to the screen (on top of the game view)
-		FString ActiveTagsString = MechanicComponent->GetActiveTags().ToString();
-
-		// Display the active tags on screen for 5 seconds
-		//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Green, FString::Printf(TEXT("Active Tags: %s"), *ActiveTagsString));
-		
 		if (MechanicComponent->GetActiveTags().HasTag(WallRunMechanicTag))
 		{
 			AddMovementInput(GetActorForwardVector(), CurrentMoveVector.X);
@@ -228,6 +275,9 @@ void AParkourCharacter::Move(const FInputActionValue& Value)
 
 void AParkourCharacter::Look(const FInputActionValue& Value)
 {
+	LLM_SCOPE_BYTAG(ProcGen_Character);
+	PROCGEN_ALLOC_AUDIT_SCOPE(AParkourCharacter_Look);
+
 	// input is a Vector2D
 	FVector2D LookAxisVector = Value.Get<FVector2D>();
 
@@ -281,12 +331,12 @@ FRotator AParkourCharacter::GetInputDirection()
 
 void AParkourCharacter::StartJumpCheck()
 {
-	MechanicComponent->StartMechanic(this, WallRunMechanicTag);
+	MechanicComponent->StartMechanicInstance(this, WallRunMechanic);
 }
 
 void AParkourCharacter::StopJumpCheck()
 {
-	MechanicComponent->StopMechanic(this, WallRunMechanicTag);
+	MechanicComponent->StopMechanicInstance(this, WallRunMechanic);
 }
 
 void AParkourCharacter::StartCrouch()
@@ -295,7 +345,7 @@ void AParkourCharacter::StartCrouch()
 
 	if (MechanicComponent)
 	{
-		if (!MechanicComponent->StartMechanic(this, SlideMechanicTag))
+		if (!MechanicComponent->StartMechanicInstance(this, SlideMechanic))
 		{
 			UE_LOG(LogTemp, Warning, TEXT("Can't Start Crouching/Sliding"));
 		}
@@ -308,7 +358,7 @@ void AParkourCharacter::StopCrouch()
 
 	if (MechanicComponent)
 	{
-		if (!MechanicComponent->StopMechanic(this, SlideMechanicTag))
+		if (!MechanicComponent->StopMechanicInstance(this, SlideMechanic))
 		{
 			UE_LOG(LogTemp, Warning, TEXT("Can't Start Crouching/Sliding"));
 		}
@@ -325,16 +375,20 @@ void AParkourCharacter::Interact()
 	{
 		return;
 	}
+
+	// Found ahead of time by the sensing component, so the montage starts on this frame
+	const FSensedParkourActions* Sensed = ParkourSensing->GetSensedActions();
 	
 	// Check if player is moving fast enough to vault AND not falling.
 	if (GetCharacterMovement()->Velocity.Length() > WalkSpeed && !GetCharacterMovement()->IsFalling())
 	{
 		//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Interacting"));
-		VaultTrace();
+		ReadSensedVault(Sensed);
 
 		if (bCanVault)
 		{
 			bIsPerformingAction = true;
+			ParkourSensing->ConsumeSensedActions();
 			bCanVault = false;
 			GetCharacterMovement()->SetMovementMode(MOVE_Flying);
 			//GetCharacterMovement()->Velocity = FVector::ZeroVector;
@@ -364,10 +418,11 @@ void AParkourCharacter::Interact()
 		}
 		else // Jump OR MANTLE
 		{
-			MantleTrace();
+			ReadSensedMantle(Sensed);
 			if(bCanMantle)
 			{
 				bIsPerformingAction = true;
+				ParkourSensing->ConsumeSensedActions();
 			
 				// Set Actor Collision
 				SetActorEnableCollision(false);
@@ -393,10 +448,11 @@ void AParkourCharacter::Interact()
 	}
 	else // Try to Mantle
 	{
-		MantleTrace();
+		ReadSensedMantle(Sensed);
 		if(bCanMantle)
 		{
 			bIsPerformingAction = true;
+			ParkourSensing->ConsumeSensedActions();
 			
 			// Set Actor Collision
 			SetActorEnableCollision(false);
@@ -426,8 +482,7 @@ void AParkourCharacter::Interact()
 
 void AParkourCharacter::ApplyMotionWarping(FName WarpName, FVector WarpLocation)
 {
-	// get motion component
-	if(UMotionWarpingComponent* WarpComponent = FindComponentByClass<UMotionWarpingComponent>())
+	if(MotionWarping)
 	{
 		FMotionWarpingTarget WarpTarget;
 
@@ -440,14 +495,13 @@ void AParkourCharacter::ApplyMotionWarping(FName WarpName, FVector WarpLocation)
 		// Log the warping locations
 		//GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, FString::Printf(TEXT("VaultStart: %s"), *WarpLocation.ToString()));
 				
-		WarpComponent->AddOrUpdateWarpTarget(WarpTarget);
+		MotionWarping->AddOrUpdateWarpTarget(WarpTarget);
 	}
 }
 
 void AParkourCharacter::ApplyMantleMotionWarping(FName WarpName, FVector WarpLocation, float Offset)
 {
-	// get motion component
-	if(UMotionWarpingComponent* WarpComponent = FindComponentByClass<UMotionWarpingComponent>())
+	if(MotionWarping)
 	{
 		FMotionWarpingTarget WarpTarget;
 
@@ -460,7 +514,7 @@ void AParkourCharacter::ApplyMantleMotionWarping(FName WarpName, FVector WarpLoc
 		// Log the warping locations
 		//GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, FString::Printf(TEXT("MantleStart: %s"), *WarpLocation.ToString()));
 				
-		WarpComponent->AddOrUpdateWarpTarget(WarpTarget);
+		MotionWarping->AddOrUpdateWarpTarget(WarpTarget);
 	}
 }
 
@@ -507,219 +561,36 @@ void AParkourCharacter::OnVaultMontageEnded(UAnimMontage* Montage, bool bInterru
 	//SetActorLocation(VaultLand);
 }
 
-void AParkourCharacter::MantleTrace()
+void AParkourCharacter::ReadSensedMantle(const FSensedParkourActions* Sensed)
 {
-	bCanMantle = false;
-
-	//Re-initialize hit info
-	FHitResult OutHit;
-
-	FVector Start = GetActorLocation();
-	Start += FVector(0,0,25.f);
-	FVector End = Start + (GetActorForwardVector() * MantleInitialTraceLength);
-
-	//DrawDebugLine(GetWorld(), Start, End, FColor::Blue, false, 5.0f, 0, 2.0f);
-
-	// Trace to check for a mantle-able object
-	if (GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility))
-	{
-		//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Found Mantle Object"));
-		
-		float SphereRadius = 10.f;
-
-		float offset = MantleSecondaryTraceZOffset * (GetCharacterMovement()->IsFalling() ? MantleFallHeightMultiplier : 1.0f);
-		Start = OutHit.Location + FVector(0,0,offset);
-		End = OutHit.Location;
-
-		FHitResult SphereHitResult;
-		FCollisionQueryParams CollisionParams;
-
-		// Draw debug sphere for each trace in the loop
-		DrawDebugSphere(GetWorld(), Start, SphereRadius, 12, FColor::Yellow, false, 5.0f);
-		DrawDebugSphere(GetWorld(), End, SphereRadius, 12, FColor::Yellow, false, 5.0f);
-			
-		// Sphere trace for object height, if player is falling them max height is reduced.
-		if (GetWorld()->SweepSingleByChannel(SphereHitResult, Start, End, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(SphereRadius), CollisionParams))
-		{
-			
-			// Set motion warp positions if there is a collision
-			MantlePosition1 = SphereHitResult.ImpactPoint + (GetActorForwardVector() * -50.f);
-			MantlePosition2 = SphereHitResult.ImpactPoint + (GetActorForwardVector() * 120.f);
-
-			//GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, FString::Printf(TEXT("MantlePosition1: %s"), *MantlePosition1.ToString()));
-			//GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Yellow, FString::Printf(TEXT("MantlePosition2: %s"), *MantlePosition2.ToString()));
-			
-			DrawDebugSphere(GetWorld(), MantlePosition1, SphereRadius, 12, FColor::Orange, false, 5.0f);
-			DrawDebugSphere(GetWorld(), MantlePosition2, SphereRadius, 12, FColor::Red, false, 5.0f);
-
-			bCanMantle = true;
-			
-			FHitResult InnerSphereHitResult;
-			Start = MantlePosition2 + FVector(0,0,20);
-			DrawDebugSphere(GetWorld(), Start, SphereRadius, 12, FColor::Blue, false, 5.0f);
-			// Sphere trace to check if player has enough space to climb up
-			if (GetWorld()->SweepSingleByChannel(InnerSphereHitResult, Start, Start, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(SphereRadius), CollisionParams))
-			{
-				bCanMantle = false;
-				//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Not enough space for player"));
-			}
-			else
-			{
-				MantlePosition2 = SphereHitResult.ImpactPoint + (GetActorForwardVector() * 50);
-				if(MantlePosition1.IsZero() || MantlePosition2.IsZero())
-				{
-					bCanMantle = false;
-					//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Position 1 and 2 are 0,0,0"));
-				}
-				else
-				{
-					float ZOffset = MantlePosition2.Z + 100;
-					Start = FVector(MantlePosition1.X, MantlePosition1.Y, ZOffset);
-					End = MantlePosition2 + FVector(0,0, 120);
-
-					DrawDebugLine(GetWorld(), Start, End, FColor::Purple, false, 5.0f, 0, 2.0f);
-					DrawDebugSphere(GetWorld(), MantlePosition1, SphereRadius, 12, FColor::Black, false, 5.0f);
-					DrawDebugSphere(GetWorld(), MantlePosition2, SphereRadius, 12, FColor::White, false, 5.0f);
-					
-					// Final check to see if mantle spot is clear
-					if (GetWorld()->SweepSingleByChannel(SphereHitResult, Start, End, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(SphereRadius), CollisionParams))
-					{
-						bCanMantle = false;
-						//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Can't Mantle at End"));
-					}
-					else
-					{
-						//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("Can Mantle"));
-					}
-				}
-			}
-		}
-	}
-	else
+	bCanMantle = Sensed && Sensed->bCanMantle;
+	if (bCanMantle)
 	{
-		bCanMantle = false;
+		MantlePosition1 = Sensed->MantlePosition1;
+		MantlePosition2 = Sensed->MantlePosition2;
 	}
 }
 
-/// <summary>
-/// InitialTraceLength - How close do you need to be to vault
-/// SecondaryTraceOffset - Check for how tall the object you want to vault is 
-/// SecondaryTraceGap - Determines distance in between traces
-/// LnadingPositionForwardOffset - Landing position offset to make it look more accurate
-/// </summary>
-void AParkourCharacter::VaultTrace()
+void AParkourCharacter::ReadSensedVault(const FSensedParkourActions* Sensed)
 {
-	// local variables
-
-	//Re-initialize hit info
-	FHitResult OutHit;
-
-	FVector Start = GetActorLocation() + FVector(0,0,-15);
-	FVector End = (Start + GetActorForwardVector() * InitialTraceLength) + FVector(0,0,-15);
-
-	//DrawDebugLine(GetWorld(), Start, End, FColor::Blue, false, 5.0f, 0, 2.0f);
-	
-	// Line trace for an object to vault over, if object is found it will find vault target locations
-	if (GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility))
+	bCanVault = Sensed && Sensed->bCanVault;
+	if (bCanVault)
 	{
-		//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("HIT LINE TRACE"));
-		
-		VaultDistance = 0;
-
-		float SphereRadius = 10.f;
-
-		for (int i = 0; i < 14; i++)
-		{
-			VaultDistance++;
-
-			FVector Middle = GetActorForwardVector() * i * SecondaryTraceGap;
-
-			Start = OutHit.Location + Middle;
-			End = Start;
-			Start.Z += SecondaryTraceZOffset;
-			
-
-			FHitResult SphereHitResult;
-			FCollisionQueryParams CollisionParams;
-
-			// Draw debug sphere for each trace in the loop
-			DrawDebugSphere(GetWorld(), Start, SphereRadius, 12, FColor::Yellow, false, 5.0f);
-			//DrawDebugSphere(GetWorld(), End, SphereRadius, 12, FColor::Green, false, 5.0f);
-			
-			// Sphere trace to determine length and height of object
-			if (GetWorld()->SweepSingleByChannel(SphereHitResult, Start, End, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(SphereRadius), CollisionParams))
-			{
-				if (i == 0) // set start location of vault if it is the first trace. Sphere trace checks for any blocking that prevents vaulting
-				{
-					//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("VAULT START LOCATION"));
-					VaultStart = SphereHitResult.ImpactPoint;
-
-					DrawDebugLine(GetWorld(), Start, VaultStart, FColor::Green, false, 5.0f, 0, 2.0f);
-					
-					// another sphere trace for end
-					if (GetWorld()->SweepSingleByChannel(SphereHitResult, FVector(VaultStart.X, VaultStart.Y, VaultStart.Z + 50), FVector(VaultStart.X, VaultStart.Y, VaultStart.Z + 20), FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(SphereRadius), CollisionParams))
-					{
-						//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("VAULT START SPHERE TRIGGER"));
-						bCanVault = false;
-						DrawDebugLine(GetWorld(), VaultStart, FVector(VaultStart.X, VaultStart.Y, VaultStart.Z + 20), FColor::Red, false, 5.0f, 0, 2.0f);
-						break;
-					}
-				}
-				else // if the trace is not the first then this will determine the middle / height location
-				{
-					//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("VAULT MIDDLE LOCATION"));
-					VaultMiddle = SphereHitResult.ImpactPoint;
-
-					DrawDebugLine(GetWorld(), Start, VaultMiddle, FColor::Green, false, 5.0f, 0, 2.0f);
-					
-					// Another trace for end
-					if (GetWorld()->SweepSingleByChannel(SphereHitResult, SphereHitResult.TraceStart, SphereHitResult.TraceStart, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(SphereRadius), CollisionParams))
-					{
-						bCanVault = false;
-						DrawDebugLine(GetWorld(), SphereHitResult.TraceStart, SphereHitResult.TraceEnd, FColor::Red, false, 5.0f, 0, 2.0f);
-					}
-				}
-				//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("HIT SPHERE TRACE"));
-			}
-			else // find landing location by doing a line trace down from an offset
-			{
-				bCanVault = true;
-
-				Middle = GetActorForwardVector() * LandingPositionForwardOffset;
-				Start = OutHit.TraceEnd + Middle;
-				End = Start + FVector(0, 0, -100);
-
-				DrawDebugLine(GetWorld(), Start, End, FColor::Purple, false, 5.0f, 0, 2.0f);
-				
-				if(GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility))
-				{
-					//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("LAND LINE TRACE HIT"));
-					DrawDebugSphere(GetWorld(), End, 20, 12, FColor::Red, false, 5.0f);
-					if(GetWorld()->SweepSingleByChannel(SphereHitResult, Start, Start, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(SphereRadius), CollisionParams))
-					{
-						bCanVault = false;
-						DrawDebugLine(GetWorld(), Start, Start, FColor::Purple, false, 5.0f, 0, 2.0f);
-						//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("CAN'T VAULT"));
-					}
-					else
-					{
-						VaultLand = OutHit.Location +FVector(0,0,-20.f);
-						//GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, TEXT("VAULT LAND LOCATION"));
-						DrawDebugSphere(GetWorld(), VaultLand, SphereRadius, 12, FColor::Red, false, 5.0f);
-					}
-				}
-
-				break;
-			}
-		}
+		VaultStart = Sensed->VaultStart;
+		VaultMiddle = Sensed->VaultMiddle;
+		VaultLand = Sensed->VaultLand;
 	}
 }
 
 // Called every frame
 void AParkourCharacter::Tick(float DeltaTime)
 {
+	LLM_SCOPE_BYTAG(ProcGen_Character);
+
 	Super::Tick(DeltaTime);
 
+	PROCGEN_ALLOC_AUDIT_SCOPE(AParkourCharacter_Tick);
+
 	// Check if AnimInstance is crouching
 
 	// Check for Parkour
@@ -812,3 +683,8 @@ FVector2D AParkourCharacter::GetPlayerMoveValue() const
 {
 	return CurrentMoveVector;
 }
+
+bool AParkourCharacter::IsDebugDrawEnabled()
+{
+	return CVarParkourDebugDraw.GetValueOnGameThread();
+}
@@ -14,6 +14,12 @@ class USpringArmComponent;
 class UCameraComponent;
 class UInputMappingContext;
 class UMechanicsComponent;
+class UParkourMovementComponent;
+class UParkourSensingComponent;
+class UMotionWarpingComponent;
+struct FSensedParkourActions;
+class UBaseMechanic;
+class USlideMechanic;
 class UInputAction;
 struct FInputActionValue;
 
@@ -32,6 +38,13 @@ class PROCEDURALGENERATION_API AParkourCharacter : public ACharacter
 {
 	GENERATED_BODY()
 
+	// Drives the same input handlers a player would
+	friend class AParkourBotController;
+	// Reads the vault and mantle trace settings
+	friend class UParkourSensingComponent;
+	// Runs the audited input and tick paths
+	friend class FProcGenAllocationAuditTest;
+
 protected:
 	// True First Person Camera - Can See Third Person Mesh
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Camera, meta = (AllowPrivateAccess = true)) UCameraComponent* TFPSCamera;
@@ -83,12 +96,25 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Capsule", meta = (AllowPrivateAccess = "true")) FVector2f FullCapsule; 
 	UPROPERTY(EditAnywhere, Category = "Capsule", meta = (AllowPrivateAccess = "true")) FVector2f HalfCapsule;
 
+	// Character movement with the wall run and slide modes
+	UPROPERTY(Transient) UParkourMovementComponent* ParkourMovement;
+
+	// Finds vault and mantle targets in the background for Interact
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components") UParkourSensingComponent* ParkourSensing;
+
+	// Added in the blueprint, looked up once in BeginPlay
+	UPROPERTY(Transient) UMotionWarpingComponent* MotionWarping;
+
 	/** Action Component */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components") UMechanicsComponent* MechanicComponent;
 
 	// Action Tags - could make this better
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input", meta = (AllowPrivateAccess = "true")) FGameplayTag SlideMechanicTag;
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input", meta = (AllowPrivateAccess = "true")) FGameplayTag WallRunMechanicTag;
+
+	// Mechanics behind the tags above, refetched whenever the component's mechanics change
+	UPROPERTY(Transient) UBaseMechanic* SlideMechanic;
+	UPROPERTY(Transient) UBaseMechanic* WallRunMechanic;
 	
 	UPROPERTY(BlueprintReadWrite, Category = "MovementState", meta = (AllowPrivateAccess = "true"))  TEnumAsByte<EMovementState> MovementState;
 
@@ -101,12 +127,14 @@ protected:
 	FVector VaultStart;
 	FVector VaultMiddle;
 	FVector VaultLand;
-	int VaultDistance;
 
 	UPROPERTY(EditAnywhere, Category = "Animation") TArray<UAnimMontage*> VaultMontages;
 
 	// Motion Warping Component
 
+	// Seconds between vault/mantle checks, these run off a timer so they don't scale with frame rate
+	UPROPERTY(EditAnywhere, Category = "Vaulting", meta = (AllowPrivateAccess = "true")) float ParkourProbeInterval = 0.1f;
+
 	UPROPERTY(EditAnywhere, Category = "Vaulting", meta = (AllowPrivateAccess = "true")) float InitialTraceLength;
 	UPROPERTY(EditAnywhere, Category = "Vaulting", meta = (AllowPrivateAccess = "true")) float SecondaryTraceZOffset;
 	UPROPERTY(EditAnywhere, Category = "Vaulting", meta = (AllowPrivateAccess = "true")) float SecondaryTraceGap;
@@ -132,7 +160,7 @@ protected:
 	FVector2d CurrentMoveVector;
 public:
 	// Sets default values for this character's properties
-	AParkourCharacter();
+	AParkourCharacter(const FObjectInitializer& ObjectInitializer);
 
 	virtual void Jump() override;
 
@@ -142,9 +170,12 @@ protected:
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+	void CacheMechanics();
+
 	// Check for fall animations
 	void CheckForFall();
 	virtual void Landed(const FHitResult& Hit) override;
+	virtual void FellOutOfWorld(const UDamageType& DmgType) override;
 
 	UFUNCTION() void OnFallMontageEnded(UAnimMontage* Montage, bool bInterrupted);
 
@@ -164,14 +195,14 @@ protected:
 
 	// VAULTING
 	UFUNCTION(BlueprintCallable) void Interact();
-	void VaultTrace();
+	void ReadSensedVault(const FSensedParkourActions* Sensed);
 	void ApplyMotionWarping(FName WarpName, FVector WarpLocation);
 
 	UFUNCTION()
 	void OnVaultMontageEnded(UAnimMontage* Montage, bool bInterrupted);
 
 	// MANTLING
-	void MantleTrace();
+	void ReadSensedMantle(const FSensedParkourActions* Sensed);
 	void ApplyMantleMotionWarping(FName WarpName, FVector WarpLocation, float Offset);
 	UFUNCTION()
 	void OnMantleMontageEnded(UAnimMontage* Montage, bool bInterrupted);
@@ -189,6 +220,13 @@ public:
 	// Returns camera object
 	FORCEINLINE class UCameraComponent* GetTrueFirstPersonCamera() const { return TFPSCamera; }
 
+	FORCEINLINE UMechanicsComponent* GetMechanicComponent() const { return MechanicComponent; }
+
+	FORCEINLINE UParkourMovementComponent* GetParkourMovement() const { return ParkourMovement; }
+
+	// Cached, null if the slide tag isn't a USlideMechanic
+	USlideMechanic* GetSlideMechanic() const;
+
 	void SwitchMovementState(EMovementState State);
 	FORCEINLINE EMovementState GetMovementState() { return MovementState; }
 
@@ -207,5 +245,8 @@ public:
     void SetSprinting();
 
 	FVector2D GetPlayerMoveValue() const;
+
+	// p.Parkour.DebugDraw, the parkour traces only draw when it's set
+	static bool IsDebugDrawEnabled();
 	
 };
@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+
+/**
+ * Collision set up for parkour probes, the channels and profiles are declared in DefaultEngine.ini.
+ * Every vault, mantle, slide and wall run query traces ECC_Parkour instead of ECC_Visibility, so the
+ * buildings and skyline the generators decorate with drop out of the query filter. Hand placed level
+ * geometry blocks the channel by default, pawns and decoration ignore it.
+ */
+
+// Trace channel for the character's environment probes
+#define ECC_Parkour ECC_GameTraceChannel1
+
+// Object type of the platforms and obstacles the generators place
+#define ECC_ParkourGeometry ECC_GameTraceChannel2
+
+namespace ParkourCollision
+{
+	// Platforms and obstacles, blocks everything like BlockAll
+	inline const FName GeometryProfile(TEXT("ParkourGeometry"));
+
+	// Generated buildings and skyline, blocks movement but never parkour probes
+	inline const FName DecorationProfile(TEXT("ParkourDecoration"));
+}
@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourQueries.h"
+#include "ParkourCollision.h"
+#include "Procedural Generation/ProcGenStats.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+DECLARE_STATS_GROUP(TEXT("ParkourQueries"), STATGROUP_ParkourQueries, STATCAT_Advanced);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Line Traces"), STAT_ParkourQueries_Lines, STATGROUP_ParkourQueries);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sweeps"), STAT_ParkourQueries_Sweeps, STATGROUP_ParkourQueries);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Overlaps"), STAT_ParkourQueries_Overlaps, STATGROUP_ParkourQueries);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Average Per Frame"), STAT_ParkourQueries_Average, STATGROUP_ParkourQueries);
+
+CSV_DEFINE_CATEGORY(ParkourQueries, true);
+
+namespace ParkourQueries
+{
+	static TAutoConsoleVariable<int32> CVarQueryBudget(
+		TEXT("p.Parkour.QueryBudget"),
+		48,
+		TEXT("Collision queries the character and mechanics may make in one frame before a warning is logged, 0 to never warn"),
+		ECVF_Default);
+
+	// Frames the rolling averages cover, roughly a second at 60 fps
+	static constexpr float AverageFrames = 60.f;
+
+	// Only warn once a second while over budget, a long wall run would otherwise flood the log
+	static constexpr double WarningInterval = 1.0;
+
+	struct FCallerQueries
+	{
+		uint32 Frame[static_cast<int32>(EParkourQueryType::Num)] = {};
+		float Average = 0.f;
+		uint32 Peak = 0;
+
+		uint32 GetFrameTotal() const
+		{
+			uint32 Total = 0;
+			for (const uint32 Num : Frame)
+			{
+				Total += Num;
+			}
+			return Total;
+		}
+	};
+
+	// Only touched on the game thread
+	static TMap<FName, FCallerQueries> Callers;
+	static float FrameAverage = 0.f;
+	static uint32 TotalQueries = 0;
+	static double LastWarningTime = 0.0;
+	static FDelegateHandle EndFrameHandle;
+
+	static void EndFrame()
+	{
+		const int32 Budget = CVarQueryBudget.GetValueOnGameThread();
+
+		uint32 FrameTotal = 0;
+		FName TopCaller;
+		uint32 TopCallerTotal = 0;
+		for (TPair<FName, FCallerQueries>& Pair : Callers)
+		{
+			FCallerQueries& Caller = Pair.Value;
+			const uint32 CallerTotal = Caller.GetFrameTotal();
+
+			Caller.Average += (CallerTotal - Caller.Average) / AverageFrames;
+			Caller.Peak = FMath::Max(Caller.Peak, CallerTotal);
+			FrameTotal += CallerTotal;
+			if (CallerTotal > TopCallerTotal)
+			{
+				TopCaller = Pair.Key;
+				TopCallerTotal = CallerTotal;
+			}
+
+#if CSV_PROFILER
+			FCsvProfiler::RecordCustomStat(Pair.Key, CSV_CATEGORY_INDEX(ParkourQueries), static_cast<int32>(CallerTotal), ECsvCustomStatOp::Set);
+#endif
+
+			FMemory::Memzero(Caller.Frame);
+		}
+
+		FrameAverage += (FrameTotal - FrameAverage) / AverageFrames;
+		SET_FLOAT_STAT(STAT_ParkourQueries_Average, FrameAverage);
+		CSV_CUSTOM_STAT(ParkourQueries, Total, static_cast<int32>(FrameTotal), ECsvCustomStatOp::Set);
+
+		if (Budget > 0 && FrameTotal > static_cast<uint32>(Budget))
+		{
+			const double Now = FPlatformTime::Seconds();
+			if (Now - LastWarningTime >= WarningInterval)
+			{
+				LastWarningTime = Now;
+				UE_LOG(LogProcGen, Warning, TEXT("%u parkour queries this frame, budget is %d. Most from %s (%u)"),
+					FrameTotal, Budget, *TopCaller.ToString(), TopCallerTotal);
+			}
+		}
+	}
+
+	static void CountQuery(const UObject* Caller, EParkourQueryType Type, int32 Num)
+	{
+		check(IsInGameThread());
+
+		// Rolled over at the end of each frame, hooked up by the first query so nothing runs without one
+		if (!EndFrameHandle.IsValid())
+		{
+			EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&EndFrame);
+		}
+
+		const FName CallerName = Caller ? Caller->GetClass()->GetFName() : NAME_None;
+		Callers.FindOrAdd(CallerName).Frame[static_cast<int32>(Type)] += Num;
+		TotalQueries += Num;
+
+		switch (Type)
+		{
+		case EParkourQueryType::Line:
+			INC_DWORD_STAT_BY(STAT_ParkourQueries_Lines, Num);
+			break;
+		case EParkourQueryType::Sweep:
+			INC_DWORD_STAT_BY(STAT_ParkourQueries_Sweeps, Num);
+			break;
+		case EParkourQueryType::Overlap:
+			INC_DWORD_STAT_BY(STAT_ParkourQueries_Overlaps, Num);
+			break;
+		default:
+			break;
+		}
+	}
+
+	static FAutoConsoleCommand ReportCommand(
+		TEXT("p.Parkour.Queries.Report"),
+		TEXT("Prints the average and peak collision queries per frame of each caller"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			UE_LOG(LogProcGen, Display, TEXT("Parkour queries: %u total, %.1f per frame"), TotalQueries, FrameAverage);
+			for (const TPair<FName, FCallerQueries>& Pair : Callers)
+			{
+				UE_LOG(LogProcGen, Display, TEXT("  %s: %.1f per frame, peak %u"), *Pair.Key.ToString(), Pair.Value.Average, Pair.Value.Peak);
+			}
+		}));
+
+	bool LineTrace(const UObject* Caller, FHitResult& OutHit, const FVector& Start, const FVector& End, const FCollisionQueryParams& Params)
+	{
+		CountQuery(Caller, EParkourQueryType::Line, 1);
+		return Caller->GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Parkour, Params);
+	}
+
+	bool Sweep(const UObject* Caller, FHitResult& OutHit, const FVector& Start, const FVector& End, const FCollisionShape& Shape, const FCollisionQueryParams& Params)
+	{
+		CountQuery(Caller, EParkourQueryType::Sweep, 1);
+		return Caller->GetWorld()->SweepSingleByChannel(OutHit, Start, End, FQuat::Identity, ECC_Parkour, Shape, Params);
+	}
+
+	bool Overlap(const UObject* Caller, TArray<FOverlapResult>& OutOverlaps, const FVector& Position, const FCollisionShape& Shape, const FCollisionQueryParams& Params)
+	{
+		CountQuery(Caller, EParkourQueryType::Overlap, 1);
+		return Caller->GetWorld()->OverlapMultiByChannel(OutOverlaps, Position, FQuat::Identity, ECC_Parkour, Shape, Params);
+	}
+
+	FTraceHandle AsyncLineTrace(const UObject* Caller, const FVector& Start, const FVector& End)
+	{
+		CountQuery(Caller, EParkourQueryType::Line, 1);
+		return Caller->GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, ECC_Parkour);
+	}
+
+	FTraceHandle AsyncSweep(const UObject* Caller, const FVector& Start, const FVector& End, const FCollisionShape& Shape)
+	{
+		CountQuery(Caller, EParkourQueryType::Sweep, 1);
+		return Caller->GetWorld()->AsyncSweepByChannel(EAsyncTraceType::Single, Start, End, FQuat::Identity, ECC_Parkour, Shape);
+	}
+
+	void Count(const UObject* Caller, EParkourQueryType Type, int32 Num)
+	{
+		CountQuery(Caller, Type, Num);
+	}
+
+	uint32 GetTotal()
+	{
+		return TotalQueries;
+	}
+}
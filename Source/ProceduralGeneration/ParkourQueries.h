@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "CollisionShape.h"
+#include "WorldCollision.h"
+
+enum class EParkourQueryType : uint8
+{
+	Line,
+	Sweep,
+	Overlap,
+	Num
+};
+
+/**
+ * Collision queries for the character, mechanics and generators, all on the Parkour channel. Each one is
+ * counted against its caller's class and query type, so "stat ParkourQueries", a CSV capture (one column
+ * per caller) or p.Parkour.Queries.Report show what every mechanic costs per frame. Frames that go over
+ * p.Parkour.QueryBudget log a warning naming the biggest caller.
+ */
+namespace ParkourQueries
+{
+	PROCEDURALGENERATION_API bool LineTrace(const UObject* Caller, FHitResult& OutHit, const FVector& Start, const FVector& End,
+		const FCollisionQueryParams& Params = FCollisionQueryParams::DefaultQueryParam);
+
+	PROCEDURALGENERATION_API bool Sweep(const UObject* Caller, FHitResult& OutHit, const FVector& Start, const FVector& End, const FCollisionShape& Shape,
+		const FCollisionQueryParams& Params = FCollisionQueryParams::DefaultQueryParam);
+
+	PROCEDURALGENERATION_API bool Overlap(const UObject* Caller, TArray<FOverlapResult>& OutOverlaps, const FVector& Position, const FCollisionShape& Shape,
+		const FCollisionQueryParams& Params = FCollisionQueryParams::DefaultQueryParam);
+
+	// Results are read back with UWorld::QueryTraceData on the next frame
+	PROCEDURALGENERATION_API FTraceHandle AsyncLineTrace(const UObject* Caller, const FVector& Start, const FVector& End);
+	PROCEDURALGENERATION_API FTraceHandle AsyncSweep(const UObject* Caller, const FVector& Start, const FVector& End, const FCollisionShape& Shape);
+
+	// For queries made against a single component rather than through the scene
+	PROCEDURALGENERATION_API void Count(const UObject* Caller, EParkourQueryType Type, int32 Num = 1);
+
+	// Every query counted since startup, game thread only
+	PROCEDURALGENERATION_API uint32 GetTotal();
+}
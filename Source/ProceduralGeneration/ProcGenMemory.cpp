@@ -0,0 +1,229 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ProcGenMemory.h"
+#include "Procedural Generation/ProcGenStats.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/MemoryBase.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Components/ActorComponent.h"
+#include "GameFramework/Actor.h"
+
+LLM_DEFINE_TAG(ProcGen_Character);
+LLM_DEFINE_TAG(ProcGen_Mechanics);
+LLM_DEFINE_TAG(ProcGen_Planning);
+LLM_DEFINE_TAG(ProcGen_Actors);
+LLM_DEFINE_TAG(ProcGen_Decoration);
+
+uint64 FProcGenMemorySummary::GetBytesPerActor() const
+{
+	const int32 NumActors = NumPlatforms + NumObstacles + NumDecorations;
+	return NumActors > 0 ? (PlatformBytes + ObstacleBytes + DecorationBytes) / NumActors : 0;
+}
+
+uint64 ProcGenMemory::EstimateActorBytes(AActor* Actor)
+{
+	if (!Actor)
+	{
+		return 0;
+	}
+
+	// The actor's resource size already takes in its components' resources
+	uint64 Bytes = Actor->GetClass()->GetStructureSize() + Actor->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+	for (const UActorComponent* Component : Actor->GetComponents())
+	{
+		if (Component)
+		{
+			Bytes += Component->GetClass()->GetStructureSize();
+		}
+	}
+	return Bytes;
+}
+
+uint64 ProcGenMemory::EstimateActorBytes(TConstArrayView<AActor*> Actors)
+{
+	uint64 Bytes = 0;
+	for (AActor* Actor : Actors)
+	{
+		Bytes += EstimateActorBytes(Actor);
+	}
+	return Bytes;
+}
+
+#if PROCGEN_ALLOCATION_AUDIT
+
+namespace ProcGenMemory
+{
+	static TAutoConsoleVariable<int32> CVarAllocAudit(
+		TEXT("p.Parkour.AllocAudit"),
+		0,
+		TEXT("Counts heap allocations in the character and mechanics hot paths, needs -ProcGenAllocAudit on the command line.\n")
+		TEXT("0: off, 1: log the first allocating frame of each scope, 2: also ensure"),
+		ECVF_Cheat);
+
+	// Only touched on the game thread
+	static int32 AuditDepth = 0;
+	static uint64 AllocationCount = 0;
+	static uint64 FailedScopeCount = 0;
+	static TSet<const TCHAR*> ReportedScopes;
+
+	static void CountAllocation()
+	{
+		if (AuditDepth > 0 && IsInGameThread())
+		{
+			++AllocationCount;
+		}
+	}
+
+	// Forwards everything to the real allocator, counting allocations made while a scope is open
+	class FAuditMalloc final : public FMalloc
+	{
+	public:
+		explicit FAuditMalloc(FMalloc* InInner)
+			: Inner(InInner)
+		{
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+			{
+				CountAllocation();
+			}
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			if (Count > 0)
+			{
+				CountAllocation();
+			}
+			return Inner->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void MarkTLSCachesAsUsedOnCurrentThread() override { Inner->MarkTLSCachesAsUsedOnCurrentThread(); }
+		virtual void MarkTLSCachesAsUnusedOnCurrentThread() override { Inner->MarkTLSCachesAsUnusedOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void InitializeStatsMetadata() override { Inner->InitializeStatsMetadata(); }
+		virtual void UpdateStats() override { Inner->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+	private:
+		FMalloc* Inner;
+	};
+
+	// Set once at module startup and never removed, anything the real allocator handed out can still be freed through it
+	static FAuditMalloc* AuditMalloc = nullptr;
+	static bool bReportedMissingSwitch = false;
+
+	static FAutoConsoleCommand ReportCommand(
+		TEXT("p.Parkour.AllocAudit.Report"),
+		TEXT("Prints how many allocations the audited hot paths have made"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			UE_LOG(LogProcGen, Display, TEXT("Allocation audit: %llu allocations, %llu failing scopes"), AllocationCount, FailedScopeCount);
+		}));
+}
+
+FProcGenAllocationAuditScope::FProcGenAllocationAuditScope(const TCHAR* InName)
+	: Name(InName)
+	, StartCount(0)
+	, bActive(ProcGenMemory::CVarAllocAudit.GetValueOnGameThread() > 0 && IsInGameThread())
+{
+	if (bActive && !ProcGenMemory::AuditMalloc)
+	{
+		bActive = false;
+		if (!ProcGenMemory::bReportedMissingSwitch)
+		{
+			ProcGenMemory::bReportedMissingSwitch = true;
+			UE_LOG(LogProcGen, Warning, TEXT("p.Parkour.AllocAudit is set but the allocator isn't wrapped, start with -ProcGenAllocAudit"));
+		}
+	}
+
+	if (bActive)
+	{
+		++ProcGenMemory::AuditDepth;
+		StartCount = ProcGenMemory::AllocationCount;
+	}
+}
+
+FProcGenAllocationAuditScope::~FProcGenAllocationAuditScope()
+{
+	if (!bActive)
+	{
+		return;
+	}
+
+	--ProcGenMemory::AuditDepth;
+
+	const uint64 NumAllocations = ProcGenMemory::AllocationCount - StartCount;
+	if (NumAllocations == 0)
+	{
+		return;
+	}
+
+	++ProcGenMemory::FailedScopeCount;
+
+	// Reported once per scope, this runs every frame
+	bool bAlreadyReported = false;
+	ProcGenMemory::ReportedScopes.Add(Name, &bAlreadyReported);
+	if (!bAlreadyReported)
+	{
+		UE_LOG(LogProcGen, Warning, TEXT("%s made %llu heap allocations, it is expected to make none"), Name, NumAllocations);
+		ensureAlwaysMsgf(ProcGenMemory::CVarAllocAudit.GetValueOnGameThread() < 2, TEXT("%s allocated on the hot path"), Name);
+	}
+}
+
+uint64 FProcGenAllocationAuditScope::GetAllocationCount()
+{
+	return ProcGenMemory::AllocationCount;
+}
+
+uint64 FProcGenAllocationAuditScope::GetFailedScopeCount()
+{
+	return ProcGenMemory::FailedScopeCount;
+}
+
+bool FProcGenAllocationAuditScope::IsInstalled()
+{
+	return ProcGenMemory::AuditMalloc != nullptr;
+}
+
+void FProcGenAllocationAuditScope::InstallIfRequested()
+{
+	check(IsInGameThread());
+	if (ProcGenMemory::AuditMalloc || !FParse::Param(FCommandLine::Get(), TEXT("ProcGenAllocAudit")))
+	{
+		return;
+	}
+
+	// Module startup runs before the engine creates any world, so no audited scope can be open yet. Worker
+	// threads may already be allocating, they see either allocator and both hand out the same memory.
+	ProcGenMemory::AuditMalloc = new ProcGenMemory::FAuditMalloc(GMalloc);
+	FPlatformAtomics::InterlockedExchangePtr(reinterpret_cast<void**>(&GMalloc), ProcGenMemory::AuditMalloc);
+	UE_LOG(LogProcGen, Log, TEXT("Allocation audit installed"));
+}
+
+#endif
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+class AActor;
+
+// LLM tags, see "stat LLM" or -llm with -llmtagsets=Assets
+LLM_DECLARE_TAG_API(ProcGen_Character, PROCEDURALGENERATION_API);
+LLM_DECLARE_TAG_API(ProcGen_Mechanics, PROCEDURALGENERATION_API);
+// Layout records and builder scratch data
+LLM_DECLARE_TAG_API(ProcGen_Planning, PROCEDURALGENERATION_API);
+// Platform and obstacle actors with their components and render state
+LLM_DECLARE_TAG_API(ProcGen_Actors, PROCEDURALGENERATION_API);
+// Decoration layers around the level
+LLM_DECLARE_TAG_API(ProcGen_Decoration, PROCEDURALGENERATION_API);
+
+/**
+ * What a generated level costs, filled in by the generator after realising it. Actor sizes are estimates,
+ * the object and component sizes plus their exclusive resource size, shared meshes and materials aren't counted.
+ */
+struct PROCEDURALGENERATION_API FProcGenMemorySummary
+{
+	uint64 PlanningBytes = 0;
+	uint64 PlatformBytes = 0;
+	uint64 ObstacleBytes = 0;
+	uint64 DecorationBytes = 0;
+
+	int32 NumPlatforms = 0;
+	int32 NumObstacles = 0;
+	int32 NumDecorations = 0;
+
+	// Decoration layers left out to stay inside the generator's memory budget
+	int32 DroppedDecorationLayers = 0;
+
+	uint64 GetTotalBytes() const { return PlanningBytes + PlatformBytes + ObstacleBytes + DecorationBytes; }
+	uint64 GetBytesPerPlatform() const { return NumPlatforms > 0 ? PlatformBytes / NumPlatforms : 0; }
+	uint64 GetBytesPerObstacle() const { return NumObstacles > 0 ? ObstacleBytes / NumObstacles : 0; }
+
+	// Average over every realised actor, used to estimate the next level before spawning it
+	uint64 GetBytesPerActor() const;
+};
+
+namespace ProcGenMemory
+{
+	PROCEDURALGENERATION_API uint64 EstimateActorBytes(AActor* Actor);
+
+	// Sums EstimateActorBytes over the actors, skipping nulls
+	PROCEDURALGENERATION_API uint64 EstimateActorBytes(TConstArrayView<AActor*> Actors);
+}
+
+#define PROCGEN_ALLOCATION_AUDIT !UE_BUILD_SHIPPING
+
+#if PROCGEN_ALLOCATION_AUDIT
+
+/**
+ * Counts game thread heap allocations made inside audited scopes, the character input and tick paths and
+ * the mechanics tick are expected to make none. Start with -ProcGenAllocAudit so GMalloc is wrapped while
+ * the module starts up, then set p.Parkour.AllocAudit to 1 to log the first allocation in each scope, or 2
+ * to also ensure. Without the switch the scopes count nothing.
+ */
+class PROCEDURALGENERATION_API FProcGenAllocationAuditScope
+{
+public:
+	explicit FProcGenAllocationAuditScope(const TCHAR* InName);
+	~FProcGenAllocationAuditScope();
+
+	// Heap allocations made on the game thread inside any audited scope since the audit was enabled
+	static uint64 GetAllocationCount();
+
+	// Audited scopes that allocated since the audit was enabled
+	static uint64 GetFailedScopeCount();
+
+	// Whether the counting allocator was installed at startup
+	static bool IsInstalled();
+
+	// Wraps GMalloc if -ProcGenAllocAudit is on the command line, called once from module startup before any world ticks
+	static void InstallIfRequested();
+
+private:
+	const TCHAR* Name;
+	uint64 StartCount;
+	bool bActive;
+};
+
+#define PROCGEN_ALLOC_AUDIT_SCOPE(Name) FProcGenAllocationAuditScope ANONYMOUS_VARIABLE(ProcGenAllocAudit_)(TEXT(#Name))
+
+#else
+
+#define PROCGEN_ALLOC_AUDIT_SCOPE(Name)
+
+#endif
@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/MiscTrace.h"
+#include "Trace/Trace.h"
+
+/**
+ * Unreal Insights instrumentation for generation and the parkour mechanics. Everything goes through the
+ * ProcGen channel, which is off by default, so capture with e.g.
+ *   -trace=cpu,frame,bookmark,ProcGen
+ * or "Trace.Enable ProcGen" at runtime. This works headless too, so a commandlet run gives a full .utrace.
+ */
+UE_TRACE_CHANNEL_EXTERN(ProcGenChannel, PROCEDURALGENERATION_API);
+
+// Named CPU scope, Name is an identifier such as Floor_Partition
+#define PROCGEN_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Name, ProcGenChannel)
+
+// Bookmark in the Insights timeline. The arguments are only evaluated while the ProcGen channel is on.
+#define PROCGEN_TRACE_BOOKMARK(Format, ...) \
+	do \
+	{ \
+		if (UE_TRACE_CHANNELEXPR_IS_ENABLED(ProcGenChannel)) \
+		{ \
+			TRACE_BOOKMARK(Format, ##__VA_ARGS__); \
+		} \
+	} while (0)
@@ -3,36 +3,182 @@
 
 #include "ProcGen_GameModeBase.h"
 
-#include "EngineUtils.h"
+#include "Components/BoxComponent.h"
+#include "Engine/TriggerBox.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/WorldSettings.h"
 #include "Kismet/GameplayStatics.h"
+#include "Misc/CommandLine.h"
+#include "Procedural Generation/GeneratedGeometry.h"
 
-void AProcGen_GameModeBase::RestartPlayerAtPlatform(AController* PlayerController)
+bool AProcGen_GameModeBase::RespawnFallenPawn(APawn* Pawn)
 {
-	if (!PlayerController || LevelGenerator->GetPlacedPlatforms().Num() == 0) return;
+	FVector SpawnLocation;
+	if (bHumanLevel)
+	{
+		SpawnLocation = HumanStartPoint;
+	}
+	else if (!FindRespawnLocation(Pawn->GetActorLocation(), SpawnLocation))
+	{
+		return false;
+	}
+
+	if (ACharacter* PlayerCharacter = Cast<ACharacter>(Pawn))
+	{
+		PlayerCharacter->GetCharacterMovement()->StopMovementImmediately();
+	}
+	Pawn->SetActorLocation(SpawnLocation, false, nullptr, ETeleportType::ResetPhysics);
+	return true;
+}
+
+void AProcGen_GameModeBase::NotifyPawnLanded(APawn* Pawn, const FHitResult& Hit)
+{
+	AActor* Platform = Hit.GetActor();
+	const UGeneratedGeometrySubsystem* GeneratedGeometry = GetWorld()->GetSubsystem<UGeneratedGeometrySubsystem>();
+	const FGeneratedBox* Box = GeneratedGeometry && Platform ? GeneratedGeometry->FindBox(Platform) : nullptr;
+	if (!Pawn || !Box || Box->Type != EGeneratedBoxType::Platform)
+	{
+		return;
+	}
+
+	FVector Origin;
+	FVector Extent;
+	Platform->GetActorBounds(true, Origin, Extent);
+
+	FCheckpoint* Checkpoint = Checkpoints.FindByPredicate([Platform](const FCheckpoint& Existing) { return Existing.Platform == Platform; });
+	if (!Checkpoint)
+	{
+		Checkpoint = &Checkpoints.AddDefaulted_GetRef();
+		Checkpoint->Platform = Platform;
+	}
+	Checkpoint->PlatformCenter = Box->Center;
+	Checkpoint->RespawnLocation = FVector(Origin.X, Origin.Y, Origin.Z + Extent.Z + 100.0); // Offset so player is above platform
+}
+
+bool AProcGen_GameModeBase::FindRespawnLocation(const FVector& FallLocation, FVector& OutLocation)
+{
+	const UGeneratedGeometrySubsystem* GeneratedGeometry = GetWorld()->GetSubsystem<UGeneratedGeometrySubsystem>();
 
-	AActor* FirstPlatform = LevelGenerator->GetPlacedPlatforms()[0]; // Get the first platform
-	if (!FirstPlatform) return;
+	// Only the platforms the player reached are candidates, so a plain scan for the nearest is enough
+	double BestDistSq = TNumericLimits<double>::Max();
+	for (int32 Index = Checkpoints.Num() - 1; Index >= 0; --Index)
+	{
+		const FCheckpoint& Checkpoint = Checkpoints[Index];
 
-	FVector SpawnLocation = FirstPlatform->GetActorLocation() + FVector(0, 0, 100); // Offset so player is above platform
-	FRotator SpawnRotation = FRotator::ZeroRotator;
+		// Released or recycled platforms are gone for good, drop them so later respawns don't look at them again
+		const FGeneratedBox* Box = GeneratedGeometry ? GeneratedGeometry->FindBox(Checkpoint.Platform.Get()) : nullptr;
+		if (!Box || !Box->Center.Equals(Checkpoint.PlatformCenter))
+		{
+			Checkpoints.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		const double DistSq = FVector::DistSquared2D(FallLocation, Checkpoint.RespawnLocation);
+		if (DistSq < BestDistSq)
+		{
+			BestDistSq = DistSq;
+			OutLocation = Checkpoint.RespawnLocation;
+		}
+	}
 
-	// Move player to the new location
-	if (ACharacter* PlayerCharacter = Cast<ACharacter>(PlayerController->GetPawn()))
+	if (BestDistSq < TNumericLimits<double>::Max())
 	{
-		PlayerCharacter->SetActorLocation(SpawnLocation);
-		PlayerCharacter->SetActorRotation(SpawnRotation);
+		return true;
 	}
-	else
+
+	if (!LevelGenerator || LevelGenerator->GetPlacedPlatforms().IsEmpty() || !LevelGenerator->GetPlacedPlatforms()[0])
 	{
-		// If no pawn, spawn a new one
-		APawn* NewPawn = GetWorld()->SpawnActor<APawn>(DefaultPawnClass, SpawnLocation, SpawnRotation);
-		PlayerController->Possess(NewPawn);
+		return false;
 	}
+
+	OutLocation = LevelGenerator->GetPlacedPlatforms()[0]->GetActorLocation() + FVector(0, 0, 100); // Offset so player is above platform
+	return true;
+}
+
+void AProcGen_GameModeBase::HandleLevelGenerated()
+{
+	Checkpoints.Reset();
+
+	// Endless runs have no last platform to reach
+	const TArray<AActor*>& Platforms = LevelGenerator->GetPlacedPlatforms();
+	if (LevelGenerator->IsEndless() || Platforms.IsEmpty() || !Platforms.Last())
+	{
+		if (FinishTrigger)
+		{
+			FinishTrigger->SetActorEnableCollision(false);
+		}
+		return;
+	}
+
+	FVector Origin;
+	FVector Extent;
+	Platforms.Last()->GetActorBounds(true, Origin, Extent);
+
+	const float HalfHeight = FinishTriggerHeight * 0.5f;
+	PlaceFinishTrigger(FVector(Origin.X, Origin.Y, Origin.Z + Extent.Z + HalfHeight), FVector(Extent.X, Extent.Y, HalfHeight));
+}
+
+void AProcGen_GameModeBase::PlaceFinishTrigger(const FVector& Location, const FVector& Extent)
+{
+	if (!FinishTrigger)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
+		FinishTrigger = GetWorld()->SpawnActor<ATriggerBox>(Location, FRotator::ZeroRotator, SpawnParams);
+		if (!FinishTrigger)
+		{
+			return;
+		}
+		FinishTrigger->OnActorBeginOverlap.AddDynamic(this, &AProcGen_GameModeBase::OnFinishTriggerOverlap);
+	}
+
+	FinishTrigger->SetActorLocation(Location);
+	CastChecked<UBoxComponent>(FinishTrigger->GetCollisionComponent())->SetBoxExtent(Extent);
+	FinishTrigger->SetActorEnableCollision(true);
+}
+
+void AProcGen_GameModeBase::OnFinishTriggerOverlap(AActor* OverlappedActor, AActor* OtherActor)
+{
+	const APawn* Pawn = Cast<APawn>(OtherActor);
+	if (!Pawn || !Pawn->IsPlayerControlled())
+	{
+		return;
+	}
+
+	FinishTrigger->SetActorEnableCollision(false);
+	bHumanLevel = false;
+	UGameplayStatics::OpenLevel(this, FName("MainMenuLevel"), true);
+}
+
+void AProcGen_GameModeBase::StartBotRun()
+{
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+	if (!Pawn)
+	{
+		UE_LOG(LogProcGen, Warning, TEXT("-ParkourBot given but there's no player pawn to drive"));
+		return;
+	}
+
+	AParkourBotController* Bot = GetWorld()->SpawnActor<AParkourBotController>(BotControllerClass);
+	if (!Bot)
+	{
+		return;
+	}
+
+	// Headless captures quit on their own once the run is written out
+	Bot->bExitWhenFinished = true;
+	Bot->bCaptureCsv = true;
+	FParse::Value(FCommandLine::Get(), TEXT("ParkourBotFPS="), Bot->MaxFrameRate);
+
+	PlayerController->UnPossess();
+	Bot->Possess(Pawn);
 }
 
 AProcGen_GameModeBase::AProcGen_GameModeBase()
 {
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
+	BotControllerClass = AParkourBotController::StaticClass();
 }
 
 void AProcGen_GameModeBase::BeginPlay()
@@ -43,51 +189,27 @@ void AProcGen_GameModeBase::BeginPlay()
 	if(AGrammarGenerator* LevelGen = Cast<AGrammarGenerator>(UGameplayStatics::GetActorOfClass(this, AGrammarGenerator::StaticClass())))
 	{
 		LevelGenerator = LevelGen;
+		LevelGenerator->OnLevelGenerated.AddUObject(this, &AProcGen_GameModeBase::HandleLevelGenerated);
+
+		// The generator may have begun play first
+		if (!LevelGenerator->GetPlacedPlatforms().IsEmpty())
+		{
+			HandleLevelGenerated();
+		}
+	}
+	else if (bHumanLevel)
+	{
+		PlaceFinishTrigger(HumanEndPoint, FVector(HumanFinishRadius));
 	}
 
-}
+	// The movement component checks KillZ every move anyway, falling below it calls the character's FellOutOfWorld
+	if (LevelGenerator || bHumanLevel)
+	{
+		GetWorldSettings()->KillZ = FallThresholdZ;
+	}
 
-void AProcGen_GameModeBase::Tick(float DeltaSeconds)
-{
-	Super::Tick(DeltaSeconds);
-	
-	for (AController* PlayerController : TActorRange<APlayerController>(GetWorld()))
+	if (FParse::Param(FCommandLine::Get(), TEXT("ParkourBot")))
 	{
-		if (ACharacter* PlayerCharacter = Cast<ACharacter>(PlayerController->GetPawn()))
-		{
-			if(PlayerCharacter->GetActorLocation().Z < FallThresholdZ && bHumanLevel)
-			{
-				PlayerCharacter->SetActorLocation(HumanStartPoint);
-			}
-			else if (PlayerCharacter->GetActorLocation().Z < FallThresholdZ && LevelGenerator)
-			{
-				RestartPlayerAtPlatform(PlayerController);
-			}
-
-			if (PlayerCharacter && LevelGenerator && LevelGenerator->GetPlacedPlatforms().Num() > 0)
-			{
-				AActor* LastPlatform = LevelGenerator->GetPlacedPlatforms().Last();
-				if (LastPlatform)
-				{
-					float Distance = FVector::Dist(PlayerCharacter->GetActorLocation(), LastPlatform->GetActorLocation());
-					if (Distance <= 400.f)
-					{
-						UGameplayStatics::OpenLevel(this, FName("MainMenuLevel"), true);
-						return;
-					}
-				}
-			}
-			else if (PlayerCharacter && bHumanLevel)
-			{
-				float Distance = FVector::Dist(PlayerCharacter->GetActorLocation(), HumanEndPoint);
-				if (Distance <= 400.f)
-				{
-					UGameplayStatics::OpenLevel(this, FName("MainMenuLevel"), true);
-					bHumanLevel = false;
-					return;
-				}
-			}
-		}
+		StartBotRun();
 	}
-	
 }
@@ -4,34 +4,71 @@
 
 #include "CoreMinimal.h"
 #include "ParkourCharacter.h"
+#include "ParkourBotController.h"
 #include "GameFramework/GameModeBase.h"
 #include "GameFramework/PlayerStart.h"
 #include "Procedural Generation/GrammarGenerator.h"
 #include "ProcGen_GameModeBase.generated.h"
 
+class ATriggerBox;
+
 /**
- * 
+ * Nothing here ticks. The finish is a trigger volume placed on the last platform whenever the level is
+ * generated, and falls come from the world's KillZ, set to FallThresholdZ, through the character's
+ * FellOutOfWorld.
  */
 UCLASS()
 class PROCEDURALGENERATION_API AProcGen_GameModeBase : public AGameModeBase
 {
 	GENERATED_BODY()
 
-	void RestartPlayerAtPlatform(AController* PlayerController);
+	// Hands the player's pawn to a bot that plays through the level, see AParkourBotController
+	void StartBotRun();
 	
 public: 
 	AProcGen_GameModeBase();
 
+	// Puts a pawn that dropped below KillZ back on the nearest checkpoint, false if there is nowhere to put it
+	bool RespawnFallenPawn(APawn* Pawn);
+
+	// Generated platforms a pawn lands on become checkpoints
+	void NotifyPawnLanded(APawn* Pawn, const FHitResult& Hit);
+
 	UPROPERTY(EditDefaultsOnly, Category = "Game Rules")
 	float FallThresholdZ = -4000.0f;
 
+	// Height of the finish volume above the last platform, and its size around HumanEndPoint
+	UPROPERTY(EditDefaultsOnly, Category = "Game Rules") float FinishTriggerHeight = 300.0f;
+	UPROPERTY(EditDefaultsOnly, Category = "Game Rules") float HumanFinishRadius = 400.0f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Game Rules") bool bHumanLevel;
 
+	// Spawned to play the level when the game is started with -ParkourBot
+	UPROPERTY(EditDefaultsOnly, Category = "Game Rules") TSubclassOf<AParkourBotController> BotControllerClass;
+
 protected:
 	virtual void BeginPlay() override;
-	virtual void Tick(float DeltaSeconds) override;
+
+	void HandleLevelGenerated();
+	void PlaceFinishTrigger(const FVector& Location, const FVector& Extent);
+	UFUNCTION() void OnFinishTriggerOverlap(AActor* OverlappedActor, AActor* OtherActor);
+
+	// Nearest checkpoint whose platform hasn't been moved or released since, else the first platform. Checkpoints
+	// found moved or released are removed.
+	bool FindRespawnLocation(const FVector& FallLocation, FVector& OutLocation);
 	
-	AGrammarGenerator* LevelGenerator;
+	AGrammarGenerator* LevelGenerator = nullptr;
+
+	UPROPERTY() ATriggerBox* FinishTrigger = nullptr;
+
+	struct FCheckpoint
+	{
+		TWeakObjectPtr<AActor> Platform;
+		// Where the platform's box was when it was reached, endless runs move platforms to the front
+		FVector PlatformCenter;
+		FVector RespawnLocation;
+	};
+	TArray<FCheckpoint> Checkpoints;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite) FVector HumanStartPoint = FVector(8185.000000,7184.000062,-1397.999707);
 	UPROPERTY(EditAnywhere, BlueprintReadWrite) FVector HumanEndPoint = FVector(8185.000000,7184.000062,-1397.999707);
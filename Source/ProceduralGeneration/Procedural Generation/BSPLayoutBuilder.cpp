@@ -0,0 +1,530 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BSPLayoutBuilder.h"
+#include "FloorNode.h"
+#include "ProceduralGeneration/ProcGenMemory.h"
+#include "ProceduralGeneration/ProcGenTrace.h"
+#include "Hash/CityHash.h"
+
+FBSPLayoutBuilder::FBSPLayoutBuilder(const FProceduralGenerationParams& InSpawnParams, const FVector& DebugOrigin)
+	: SpawnParams(InSpawnParams)
+	, Level(DebugOrigin, InSpawnParams.MapDimensions, InSpawnParams.FloorTileSize, InSpawnParams.SplitRate, InSpawnParams.MinBounds, InSpawnParams.bUseMaxSize)
+{
+}
+
+void FBSPLayoutBuilder::Build(int32 Seed, FLevelLayout& OutLayout)
+{
+	PROCGEN_TRACE_SCOPE(BSPLayoutBuilder_Build);
+	LLM_SCOPE_BYTAG(ProcGen_Planning);
+
+	OutLayout.Reset();
+	Layout = &OutLayout;
+	PlacedPlatforms.Reset();
+
+	CurrentSeed = Seed;
+	Report.Reset(TEXT("BSP"), Seed, GetParameterHash(SpawnParams));
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ProcGen_Partition);
+		FProcGenPhaseTimer PhaseTimer(Report, TEXT("Partition"));
+		PROCGEN_TRACE_BOOKMARK(TEXT("BSP seed %d: Partition"), Seed);
+
+		Level.SetRandomSeed(Seed);
+		Level.ClearPartitionedFloor();
+		Level.Partition();
+
+		Report.AddPartitionNodes(Level.GetPartitionedFloor().Num());
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ProcGen_PlacePlatforms);
+		FProcGenPhaseTimer PhaseTimer(Report, TEXT("PlacePlatforms"));
+		PROCGEN_TRACE_BOOKMARK(TEXT("BSP seed %d: PlacePlatforms"), Seed);
+
+		PlacePlatforms();
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ProcGen_Connections);
+		FProcGenPhaseTimer PhaseTimer(Report, TEXT("Connections"));
+		PROCGEN_TRACE_BOOKMARK(TEXT("BSP seed %d: Connections"), Seed);
+
+		AnalyseParkourConnections();
+	}
+
+	Layout = nullptr;
+}
+
+uint64 FBSPLayoutBuilder::GetParameterHash(const FProceduralGenerationParams& SpawnParams)
+{
+	uint64 Hash = 0;
+	auto Mix = [&Hash](const auto& Value)
+	{
+		Hash = CityHash64WithSeed(reinterpret_cast<const char*>(&Value), sizeof(Value), Hash);
+	};
+
+	Mix(SpawnParams.MapDimensions);
+	Mix(SpawnParams.FloorTileSize);
+	Mix(SpawnParams.MinJumpDistance);
+	Mix(SpawnParams.MaxJumpDistance);
+	Mix(SpawnParams.SplitRate);
+	Mix(SpawnParams.MinBounds);
+	Mix(SpawnParams.bUseMaxSize);
+	Mix(SpawnParams.MaxBounds);
+	Mix(SpawnParams.baseHeight);
+	Mix(SpawnParams.WallRunMinHeight);
+	Mix(SpawnParams.WallRunMaxHeight);
+	Mix(SpawnParams.MantleMinHeight);
+	Mix(SpawnParams.MantleMaxHeight);
+	Mix(SpawnParams.MantleMaxDistance);
+
+	return Hash;
+}
+
+void FBSPLayoutBuilder::PlacePlatforms()
+{
+	PROCGEN_TRACE_SCOPE(BSPLayoutBuilder_PlacePlatforms);
+
+	if (Level.GetPartitionedFloor().Num() == 0) return;
+
+	const TArray<TSharedPtr<FloorNode>> PartitionedFloor = Level.GetPartitionedFloor();
+
+	// Shuffle the floor nodes for random placement order
+	FProcGenRandom OrderRandom(CurrentSeed, EProcGenStage::PlatformOrder);
+	TArray<int32> ShuffledFloors;
+	ShuffledFloors.SetNumUninitialized(PartitionedFloor.Num());
+	for (int32 i = 0; i < ShuffledFloors.Num(); ++i)
+	{
+		ShuffledFloors[i] = i;
+	}
+	for (int32 i = ShuffledFloors.Num() - 1; i >= 0; --i)
+	{
+		int32 SwapIndex = OrderRandom.RandRange(0, i);
+		ShuffledFloors.Swap(i, SwapIndex);
+	}
+
+	// Try to place each platform
+	for (const int32 FloorIndex : ShuffledFloors)
+	{
+		FCornerCoordinates Coords = PartitionedFloor[FloorIndex]->GetCornerCoordinates();
+
+		// Each cell has its own stream, so its platform doesn't depend on how many attempts earlier cells took
+		FProcGenRandom Random(CurrentSeed, EProcGenStage::PlatformPlacement, FloorIndex);
+
+		// Calculate random platform dimensions (in grid units)
+		int32 GridWidth = Random.RandRange(1, Coords.LowerRightX - Coords.UpperLeftX);
+		int32 GridLength = Random.RandRange(1, Coords.LowerRightY - Coords.UpperLeftY);
+
+		// Convert to world units
+		float Width = GridWidth * SpawnParams.FloorTileSize;
+		float Length = GridLength * SpawnParams.FloorTileSize;
+		float Height = Random.FRandRange(SpawnParams.baseHeight.X, SpawnParams.baseHeight.Y);
+
+		// Try multiple positions for each platform
+		const int32 MaxAttempts = 15;
+
+		for (int32 Attempt = 0; Attempt < MaxAttempts; ++Attempt)
+		{
+			FVector ProposedPosition = CalculatePlatformPosition(Random, Coords, Height, GridWidth, GridLength);
+
+			// Create platform data for validation
+			FPlatformData NewPlatform(ProposedPosition, FVector(Width, Length, 50.0f));
+
+			// Check if position is valid
+			bool IsValidPosition = NewPlatform.IsWithinGrid(
+				FVector2D(SpawnParams.MapDimensions.X * SpawnParams.FloorTileSize, SpawnParams.MapDimensions.Y * SpawnParams.FloorTileSize),
+				SpawnParams.FloorTileSize
+			);
+
+			if (IsValidPosition)
+			{
+				for (const FPlatformData& ExistingPlatform : PlacedPlatforms)
+				{
+					if (NewPlatform.OverlapsWith(ExistingPlatform, SpawnParams.MinJumpDistance))
+					{
+						IsValidPosition = false;
+						break;
+					}
+				}
+			}
+
+			// BSP cells have no placement category
+			Report.AddPlacementAttempt(INDEX_NONE, IsValidPosition);
+
+			if (IsValidPosition)
+			{
+				FLayoutPlatform& Platform = Layout->Platforms.AddZeroed_GetRef();
+				Platform.Location = FVector3f(ProposedPosition);
+				Platform.Scale = FVector3f(Width / 100.0f, Length / 100.0f, 50.0f);
+				Platform.Rotation = FRotator3f(180, 0, 0);
+				Platform.MeshIndex = 0;
+
+				PlacedPlatforms.Add(NewPlatform);
+				break;
+			}
+		}
+	}
+}
+
+FVector FBSPLayoutBuilder::CalculatePlatformPosition(FProcGenRandom& Random, const FCornerCoordinates& Coords, float Height, int32 PlatformWidth, int32 PlatformLength)
+{
+	// Calculate available space in the grid cell
+	int32 GridWidth = Coords.LowerRightX - Coords.UpperLeftX;
+	int32 GridHeight = Coords.LowerRightY - Coords.UpperLeftY;
+
+	// Calculate maximum allowed offset based on platform size
+	float MaxOffsetX = (GridWidth - PlatformWidth) * 0.5f * SpawnParams.FloorTileSize;
+	float MaxOffsetY = (GridHeight - PlatformLength) * 0.5f * SpawnParams.FloorTileSize;
+
+	// Add randomization within the available space
+	float RandomOffsetX = Random.FRandRange(-MaxOffsetX, MaxOffsetX);
+	float RandomOffsetY = Random.FRandRange(-MaxOffsetY, MaxOffsetY);
+
+	return FVector(
+		(Coords.UpperLeftX + (GridWidth/2.0f)) * SpawnParams.FloorTileSize + RandomOffsetX,
+		(Coords.UpperLeftY + (GridHeight/2.0f)) * SpawnParams.FloorTileSize + RandomOffsetY,
+		Height
+	);
+}
+
+void FBSPLayoutBuilder::AnalyseParkourConnections()
+{
+	PROCGEN_TRACE_SCOPE(BSPLayoutBuilder_AnalyseParkourConnections);
+
+	if (PlacedPlatforms.Num() < 2) return;
+
+	for (int32 i = 0; i < PlacedPlatforms.Num(); i++)
+	{
+		for (int32 j = i + 1; j < PlacedPlatforms.Num(); j++)
+		{
+			const FPlatformData& Platform1 = PlacedPlatforms[i];
+			const FPlatformData& Platform2 = PlacedPlatforms[j];
+
+			// Calculate horizontal distance
+			float Distance = FVector::Dist2D(
+				FVector(Platform1.Position.X, Platform1.Position.Y, 0),
+				FVector(Platform2.Position.X, Platform2.Position.Y, 0)
+			);
+
+			// Calculate height difference from the top of the lower platform to the bottom of the higher platform
+			float HeightDiff = FMath::Abs(Platform2.Position.Z - Platform1.Position.Z);
+
+			EParkourType ParkourType = DetermineParkourType(Distance, HeightDiff);
+
+			if (ParkourType == EParkourType::None)
+			{
+				continue;
+			}
+
+			const bool bAccepted = AddParkourConnection(i, j, ParkourType);
+			Report.AddConnectionCandidate(bAccepted);
+
+			if (bAccepted)
+			{
+				FLayoutConnection& Connection = Layout->Connections.AddZeroed_GetRef();
+				Connection.From = i;
+				Connection.To = j;
+				Connection.Category = static_cast<uint8>(ParkourType);
+			}
+		}
+	}
+}
+
+EParkourType FBSPLayoutBuilder::DetermineParkourType(float Distance, float HeightDiff) const
+{
+	// These values should be tweaked based on your game's mechanics
+	const float MantleMinHorizontalDistance = 500.0f;
+	const float MantleMinHeight = 800.0f;
+	const float MantleMaxHeight = 2000.0f;
+
+	const float WallRunMinDistance = 2000.0f;
+	const float WallRunMaxDistance = 5000.0f;
+
+	if (HeightDiff > MantleMinHeight
+		&& HeightDiff < MantleMaxHeight
+		&& Distance > MantleMinHorizontalDistance
+		&& Distance < SpawnParams.MantleMaxDistance)
+	{
+		return EParkourType::Mantle;
+	}
+
+	// Check for Wall Run
+	if (Distance > WallRunMinDistance &&
+		Distance < WallRunMaxDistance &&
+		FMath::Abs(HeightDiff) < SpawnParams.WallRunMaxHeight)
+	{
+		return EParkourType::WallRun;
+	}
+
+	return EParkourType::None;
+}
+
+bool FBSPLayoutBuilder::AddParkourConnection(int32 StartIndex, int32 EndIndex, EParkourType Type)
+{
+	switch(Type)
+	{
+		case EParkourType::Mantle:
+			return AddMantleIndicator(StartIndex, EndIndex);
+
+		case EParkourType::WallRun:
+			return AddWallRunSurface(StartIndex, EndIndex);
+
+		default:
+			return false;
+	}
+}
+
+bool FBSPLayoutBuilder::AddMantleIndicator(int32 StartIndex, int32 EndIndex)
+{
+	// Get all edges of both platforms
+	TArray<FPlatformEdge> StartEdges = GetPlatformEdges(PlacedPlatforms[StartIndex]);
+	TArray<FPlatformEdge> EndEdges = GetPlatformEdges(PlacedPlatforms[EndIndex]);
+
+	// Find closest edges between platforms
+	FPlatformEdge ClosestStartEdge;
+	FPlatformEdge ClosestEndEdge;
+	float MinDistance = MAX_FLT;
+
+	for (const FPlatformEdge& StartEdge : StartEdges)
+	{
+		for (const FPlatformEdge& EndEdge : EndEdges)
+		{
+			float Dist = FVector::DistSquared(StartEdge.Start, EndEdge.Start);
+			if (Dist < MinDistance)
+			{
+				MinDistance = Dist;
+				ClosestStartEdge = StartEdge;
+				ClosestEndEdge = EndEdge;
+			}
+		}
+	}
+
+	// Calculate path points along the edges
+	TArray<FVector> PathPoints;
+	// Keyed by the platform pair so each connection's jitter is independent of the others
+	FProcGenRandom Random(CurrentSeed, EProcGenStage::Connections, StartIndex * PlacedPlatforms.Num() + EndIndex);
+	GenerateEdgeFollowingPath(Random, ClosestStartEdge, ClosestEndEdge, PathPoints);
+
+	// Add mantle points along the path
+	for (int32 i = 0; i < PathPoints.Num(); ++i)
+	{
+		// Adjust scale based on position in sequence
+		float ScaleMultiplier = (i == 0 || i == PathPoints.Num() - 1) ? 1.0f : 1.25f;
+		AddObstacle(ELayoutObstacleType::Mantle, StartIndex, PathPoints[i], FVector(4.0, 4.5, 2.0f) * ScaleMultiplier, FRotator(180, 0, 0));
+	}
+
+	return true;
+}
+
+TArray<FPlatformEdge> FBSPLayoutBuilder::GetPlatformEdges(const FPlatformData& Platform) const
+{
+	TArray<FPlatformEdge> Edges;
+	FVector Extents = Platform.Dimensions * 0.5f;
+	FVector Center = Platform.Position;
+
+	TArray<FVector> Corners;
+	for (int32 i = 0; i < 8; ++i)
+	{
+		Corners.Add(FVector(
+			Center.X + (i & 1 ? Extents.X : -Extents.X),
+			Center.Y + (i & 2 ? Extents.Y : -Extents.Y),
+			Center.Z + (i & 4 ? Extents.Z : -Extents.Z)
+		));
+	}
+
+	for (int32 i = 0; i < 4; ++i)
+	{
+		FVector Normal = FVector::CrossProduct(
+			Corners[(i+1)%4] - Corners[i],
+			Corners[i+4] - Corners[i]
+		).GetSafeNormal();
+
+		Edges.Add(FPlatformEdge(Corners[i], Corners[i+4], Normal));
+	}
+
+	return Edges;
+}
+
+void FBSPLayoutBuilder::GenerateEdgeFollowingPath(FProcGenRandom& Random, const FPlatformEdge& StartEdge, const FPlatformEdge& EndEdge, TArray<FVector>& OutPoints)
+{
+	// Clear output array
+	OutPoints.Empty();
+
+	// Calculate total path length and height difference
+	float TotalDist = FVector::Dist(StartEdge.Start, EndEdge.End);
+	float HeightDiff = EndEdge.Start.Z - StartEdge.Start.Z;
+
+	// Calculate number of points based on distance
+	int32 NumPoints = FMath::Max(3, FMath::CeilToInt(TotalDist / 300.0f));
+
+	for (int32 i = 0; i < NumPoints; ++i)
+	{
+		float Alpha = static_cast<float>(i) / (NumPoints - 1);
+
+		// Interpolate position along the main direction
+		FVector Point = FMath::Lerp(StartEdge.Start, EndEdge.End, Alpha);
+
+		// Ensure points move upwards in a smooth arc
+		float HeightAlpha = FMath::InterpEaseInOut(0.0f, 1.0f, Alpha, 2.0f);
+		Point.Z = StartEdge.Start.Z + HeightDiff * HeightAlpha;
+
+		Point += FVector(
+			Random.FRandRange(-5.0f, 5.0f),
+			Random.FRandRange(-5.0f, 5.0f),
+			0.0f
+		);
+
+		OutPoints.Add(Point);
+	}
+}
+
+bool FBSPLayoutBuilder::AddWallRunSurface(int32 StartIndex, int32 EndIndex)
+{
+	const FPlatformData& Start = PlacedPlatforms[StartIndex];
+	const FPlatformData& End = PlacedPlatforms[EndIndex];
+
+	// Check if platforms are too far apart
+	float Distance = GetPlatformEdgeDistance(Start, End);
+	if (Distance < SpawnParams.MinJumpDistance)
+	{
+		return false;
+	}
+
+	// Check height difference is appropriate for wall running
+	float HeightDiff = FMath::Abs(Start.Position.Z - End.Position.Z);
+	if (HeightDiff > SpawnParams.WallRunMaxHeight)
+	{
+		return false;
+	}
+
+	// Check if path is clear of obstacles
+	if (!IsPathClear(StartIndex, EndIndex))
+	{
+		return false;
+	}
+
+	// Get actual edge points for wall placement
+	FVector StartPoint, EndPoint;
+	GetClosestPlatformPoints(Start, End, StartPoint, EndPoint);
+
+	// Check for platforms between Start and End
+	FVector Direction = (End.Position - Start.Position).GetSafeNormal();
+	for (int32 Index = 0; Index < PlacedPlatforms.Num(); ++Index)
+	{
+		if (Index == StartIndex || Index == EndIndex)
+			continue;
+
+		const FPlatformData& Platform = PlacedPlatforms[Index];
+
+		// Project platform onto line between edge points
+		FVector StartToPlat = Platform.Position - StartPoint;
+		float Projection = FVector::DotProduct(StartToPlat, Direction);
+
+		if (Projection > 0 && Projection < Distance)
+		{
+			FVector ClosestPoint = StartPoint + Direction * Projection;
+			float DistToLine = FVector::Dist(Platform.Position, ClosestPoint);
+
+			// Increased clearance check using platform dimensions
+			float MinClearance = Platform.Dimensions.GetMax();
+			if (DistToLine < MinClearance)
+				return false;
+		}
+	}
+
+	// Calculate wall position using edge points
+	FVector MidPoint = (StartPoint + EndPoint) * 0.5f;
+
+	// Adjust height to be centered between platforms
+	float AverageHeight = (Start.Position.Z + End.Position.Z) * 0.25f;
+	MidPoint.Z = AverageHeight;
+
+	// Adjust wall dimensions based on edge distance
+	float Length = Distance * 0.8f; // Slightly shorter than full distance
+	float Height = FMath::Min(350.0f, SpawnParams.WallRunMaxHeight); // Cap the height
+	float Thickness = 50.0f;
+
+	AddObstacle(ELayoutObstacleType::WallRun, StartIndex, MidPoint, FVector(Length / 100.0f, Thickness / 100.0f, Height / 100.0f), Direction.Rotation());
+	return true;
+}
+
+bool FBSPLayoutBuilder::IsPathClear(int32 StartIndex, int32 EndIndex) const
+{
+	// Get points on platform edges that would be used for movement
+	FVector StartPoint, EndPoint;
+	GetClosestPlatformPoints(PlacedPlatforms[StartIndex], PlacedPlatforms[EndIndex], StartPoint, EndPoint);
+
+	const FVector Segment = EndPoint - StartPoint;
+	const FVector InvSegment(
+		Segment.X != 0.0 ? 1.0 / Segment.X : 0.0,
+		Segment.Y != 0.0 ? 1.0 / Segment.Y : 0.0,
+		Segment.Z != 0.0 ? 1.0 / Segment.Z : 0.0);
+
+	// Check if any other platform is blocking the path
+	for (int32 Index = 0; Index < PlacedPlatforms.Num(); ++Index)
+	{
+		if (Index == StartIndex || Index == EndIndex)
+		{
+			continue;
+		}
+
+		const FPlatformData& Platform = PlacedPlatforms[Index];
+		const FBox PlatformBox = FBox::BuildAABB(Platform.Position, Platform.Dimensions * 0.5f);
+		if (FMath::LineBoxIntersection(PlatformBox, StartPoint, EndPoint, Segment, InvSegment))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FBSPLayoutBuilder::GetClosestPlatformPoints(const FPlatformData& Start, const FPlatformData& End, FVector& OutStartPoint, FVector& OutEndPoint) const
+{
+	// Get direction vector between platforms
+	FVector Direction = (End.Position - Start.Position).GetSafeNormal();
+
+	// Calculate the half-dimensions of each platform
+	FVector StartHalfDim = Start.Dimensions * 0.5f;
+	FVector EndHalfDim = End.Dimensions * 0.5f;
+
+	// Start platform edge point
+	OutStartPoint = Start.Position + FVector(
+		Direction.X * StartHalfDim.X,
+		Direction.Y * StartHalfDim.Y,
+		0.0f  // Keep Z at platform position
+	);
+
+	// End platform edge point
+	OutEndPoint = End.Position - FVector(
+		Direction.X * EndHalfDim.X,
+		Direction.Y * EndHalfDim.Y,
+		0.0f  // Keep Z at platform position
+	);
+}
+
+float FBSPLayoutBuilder::GetPlatformEdgeDistance(const FPlatformData& Start, const FPlatformData& End) const
+{
+	FVector StartPoint, EndPoint;
+	GetClosestPlatformPoints(Start, End, StartPoint, EndPoint);
+
+	// Calculate actual edge-to-edge distance
+	float HorizontalDist = FVector::Dist2D(StartPoint, EndPoint);
+	float VerticalDist = FMath::Abs(Start.Position.Z - End.Position.Z);
+
+	// Return true 3D distance between edges
+	return FMath::Sqrt(HorizontalDist * HorizontalDist + VerticalDist * VerticalDist);
+}
+
+void FBSPLayoutBuilder::AddObstacle(ELayoutObstacleType Type, int32 PlatformIndex, const FVector& Location, const FVector& Scale, const FRotator& Rotation)
+{
+	FLayoutObstacle& Obstacle = Layout->Obstacles.AddZeroed_GetRef();
+	Obstacle.Location = FVector3f(Location);
+	Obstacle.Scale = FVector3f(Scale);
+	Obstacle.Rotation = FRotator3f(Rotation);
+	Obstacle.MeshIndex = INDEX_NONE;
+	Obstacle.PlatformIndex = PlatformIndex;
+	Obstacle.Type = Type;
+
+	Report.AddObstacle(Type);
+}
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Floor.h"
+#include "LevelGenerator.h"
+#include "LevelLayout.h"
+#include "ProcGenRandom.h"
+#include "ProcGenStats.h"
+
+/**
+ * Data-only half of the BSP level generator. Partitions the floor, places platforms and works out the
+ * parkour connections between them without a world, so it can run on any thread.
+ */
+class PROCEDURALGENERATION_API FBSPLayoutBuilder
+{
+public:
+	FBSPLayoutBuilder(const FProceduralGenerationParams& InSpawnParams, const FVector& DebugOrigin = FVector::ZeroVector);
+
+	// Builds the full level for the given seed. Positions are relative to the generator.
+	void Build(int32 Seed, FLevelLayout& OutLayout);
+
+	// Hash of every parameter that changes the generated layout, used as the level pack key
+	static uint64 GetParameterHash(const FProceduralGenerationParams& SpawnParams);
+
+	// Partitioned floor from the last Build, for debug drawing
+	Floor& GetFloor() { return Level; }
+
+	// Counts and phase times of the last Build
+	const FProcGenReport& GetReport() const { return Report; }
+
+protected:
+	void PlacePlatforms();
+
+	FVector CalculatePlatformPosition(FProcGenRandom& Random, const FCornerCoordinates& Coords, float Height, int32 PlatformWidth, int32 PlatformLength);
+
+	void AnalyseParkourConnections();
+	EParkourType DetermineParkourType(float Distance, float HeightDiff) const;
+	bool AddParkourConnection(int32 StartIndex, int32 EndIndex, EParkourType Type);
+
+	// Mantle
+	bool AddMantleIndicator(int32 StartIndex, int32 EndIndex);
+	void GenerateEdgeFollowingPath(FProcGenRandom& Random, const FPlatformEdge& StartEdge, const FPlatformEdge& EndEdge, TArray<FVector>& OutPoints);
+	TArray<FPlatformEdge> GetPlatformEdges(const FPlatformData& Platform) const;
+
+	// Wallrun
+	bool AddWallRunSurface(int32 StartIndex, int32 EndIndex);
+
+	// Check the straight path between two platforms doesn't pass through another platform
+	bool IsPathClear(int32 StartIndex, int32 EndIndex) const;
+
+	// Get the closest points between two platforms
+	void GetClosestPlatformPoints(const FPlatformData& Start, const FPlatformData& End, FVector& OutStartPoint, FVector& OutEndPoint) const;
+
+	// Calculate edge-to-edge distance between platforms
+	float GetPlatformEdgeDistance(const FPlatformData& Start, const FPlatformData& End) const;
+
+	void AddObstacle(ELayoutObstacleType Type, int32 PlatformIndex, const FVector& Location, const FVector& Scale, const FRotator& Rotation);
+
+private:
+	FProceduralGenerationParams SpawnParams;
+
+	Floor Level;
+
+	// Seed of the current Build call, every stage keys its own FProcGenRandom streams from it
+	int32 CurrentSeed = 0;
+
+	TArray<FPlatformData> PlacedPlatforms;
+
+	// Layout being written by the current Build call
+	FLevelLayout* Layout = nullptr;
+
+	FProcGenReport Report;
+};
@@ -1,6 +1,8 @@
 #include "Floor.h"
 
 #include "FloorNode.h"
+#include "ProcGenStats.h"
+#include "ProceduralGeneration/ProcGenTrace.h"
 #include "DrawDebugHelpers.h"
 
 Floor::Floor()
@@ -55,6 +57,7 @@ void Floor::Reinitialise(FVector Origin_, FVector2D GridSize, float FloorSize, f
 
 void Floor::Partition()
 {
+	PROCGEN_TRACE_SCOPE(Floor_Partition);
 	
 	FCornerCoordinates CornerCoordinatesA = {0,0, FloorGridSizeX, FloorGridSizeY};
 	
@@ -76,7 +79,7 @@ void Floor::Partition()
 
 				if (Width > RoomMaxX || Height > RoomMaxY)
 				{
-					UE_LOG(LogTemp, Warning, TEXT("Too Big"));
+					UE_LOG(LogProcGen, VeryVerbose, TEXT("Too Big"));
 					FloorNodeStack.Push(A); // Push back to be split again
 					continue;
 				}
@@ -100,7 +103,7 @@ void Floor::Partition()
 // This function will decide if the node SHOULD split
 int32 Floor::SelectOrientation()
 {
-	return FMath::RandRange(0,1); // horizontal (0) or vertical (1)
+	return RandomStream.RandRange(0,1); // horizontal (0) or vertical (1)
 }
 
 // Will always return true if the node is larger than the minimum size (1x1)
@@ -115,7 +118,7 @@ bool Floor::ShouldSplitNode(TSharedPtr<FloorNode> InNode, ESplitOrientation Orie
 
 		SplitChance *= SplitRate;
 		
-		float ShouldSplit = FMath::RandRange(0,1);
+		float ShouldSplit = RandomStream.RandRange(0,1);
 		if (ShouldSplit > SplitChance)
 		{
 			return false;
@@ -133,7 +136,7 @@ bool Floor::ShouldSplitNode(TSharedPtr<FloorNode> InNode, ESplitOrientation Orie
 
 		SplitChance *= SplitRate;
 		
-		float ShouldSplit = FMath::RandRange(0,1);
+		float ShouldSplit = RandomStream.RandRange(0,1);
 		if (ShouldSplit > SplitChance)
 		{
 			return false;
@@ -145,7 +148,7 @@ bool Floor::ShouldSplitNode(TSharedPtr<FloorNode> InNode, ESplitOrientation Orie
 		}
 	}
 	
-	UE_LOG(LogTemp, Warning, TEXT("False in ShouldSplit"));
+	UE_LOG(LogProcGen, VeryVerbose, TEXT("False in ShouldSplit"));
 	return false;
 }
 
@@ -195,14 +198,14 @@ bool Floor::SplitAttempt(TSharedPtr<FloorNode> InNode)
 		}
 	}
 
-	UE_LOG(LogTemp, Warning, TEXT("False in SplitAttempt"));
+	UE_LOG(LogProcGen, VeryVerbose, TEXT("False in SplitAttempt"));
 	return false;
 }
 
 void Floor::SplitHorizontal(TSharedPtr<FloorNode> InA, TSharedPtr<FloorNode> InB, TSharedPtr<FloorNode> InC)
 {
 	// add room min to not split on the edge!
-	int32 SplitPointY = FMath::RandRange(InA->GetCornerCoordinates().UpperLeftY + RoomMinY, InA->GetCornerCoordinates().LowerRightY - RoomMinY);
+	int32 SplitPointY = RandomStream.RandRange(InA->GetCornerCoordinates().UpperLeftY + RoomMinY, InA->GetCornerCoordinates().LowerRightY - RoomMinY);
 
 	FCornerCoordinates CornerCoordinatesB;
 	CornerCoordinatesB.UpperLeftX = InA->GetCornerCoordinates().UpperLeftX;
@@ -225,7 +228,7 @@ void Floor::SplitHorizontal(TSharedPtr<FloorNode> InA, TSharedPtr<FloorNode> InB
 
 void Floor::SplitVertical(TSharedPtr<FloorNode> InA, TSharedPtr<FloorNode> InB, TSharedPtr<FloorNode> InC)
 {
-	int32 SplitPointX = FMath::RandRange(InA->GetCornerCoordinates().UpperLeftX + RoomMinX, InA->GetCornerCoordinates().LowerRightX - RoomMinX);
+	int32 SplitPointX = RandomStream.RandRange(InA->GetCornerCoordinates().UpperLeftX + RoomMinX, InA->GetCornerCoordinates().LowerRightX - RoomMinX);
 
 	// UpperLeftX and Y are unchanged but the LowerRight X changes as the split is vertical.
 	
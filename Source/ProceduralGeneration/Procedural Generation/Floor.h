@@ -1,5 +1,6 @@
 #pragma once
 #include "FloorNode.h"
+#include "ProcGenRandom.h"
 
 // scoped Enum
 enum class ESplitOrientation
@@ -19,6 +20,9 @@ public:
 
 	void Reinitialise(FVector Origin, FVector2D, float, float, FVector2D, bool);
 
+	// Partitions are driven by this stream so the same seed always gives the same floor
+	FORCEINLINE void SetRandomSeed(int32 Seed) { RandomStream = FProcGenRandom(Seed, EProcGenStage::FloorPartition); }
+
 	void Partition();
 	int32 SelectOrientation();
 	bool ShouldSplitNode(TSharedPtr<class FloorNode> InNode, ESplitOrientation Orientation);
@@ -54,4 +58,6 @@ private:
 	FVector Origin;
 
 	bool bShouldCheckMax;
+
+	FProcGenRandom RandomStream;
 };
@@ -1,25 +1,27 @@
 #include "FloorNode.h"
+#include "ProcGenStats.h"
 
-int32 FloorNode::NodeCount = 0;
+std::atomic<int32> FloorNode::NodeCount = 0;
 
 FloorNode::FloorNode()
 {
 	++NodeCount;
-	UE_LOG(LogTemp, Warning, TEXT("Create Floor Node"));
+	UE_LOG(LogProcGen, VeryVerbose, TEXT("Create Floor Node"));
 }
 
 FloorNode::FloorNode(const FCornerCoordinates& Coordinates)
 {
+	++NodeCount;
 	CornerCoordinates.UpperLeftX = Coordinates.UpperLeftX;
 	CornerCoordinates.UpperLeftY = Coordinates.UpperLeftY;
 	CornerCoordinates.LowerRightX = Coordinates.LowerRightX;
 	CornerCoordinates.LowerRightY = Coordinates.LowerRightY;
 
-	UE_LOG(LogTemp, Warning, TEXT("Create Floor Node"));
+	UE_LOG(LogProcGen, VeryVerbose, TEXT("Create Floor Node"));
 }
 
 FloorNode::~FloorNode()
 {
 	--NodeCount;
-	UE_LOG(LogTemp, Warning, TEXT("Destroy Floor Node"));
+	UE_LOG(LogProcGen, VeryVerbose, TEXT("Destroy Floor Node"));
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 struct FCornerCoordinates
 {
 	int32 UpperLeftX;
@@ -18,9 +20,10 @@ public:
 	FORCEINLINE FCornerCoordinates GetCornerCoordinates() const { return CornerCoordinates; }
 	FORCEINLINE void SetCornerCoordinates(FCornerCoordinates Coordinates) { CornerCoordinates = Coordinates; }
 
-	FORCEINLINE static int32 GetNodeCount() { return NodeCount; }
+	FORCEINLINE static int32 GetNodeCount() { return NodeCount.load(); }
 private:
 	FCornerCoordinates CornerCoordinates;
 
-	static int32 NodeCount;
+	// Floors are partitioned on worker threads when building layouts offline
+	static std::atomic<int32> NodeCount;
 };
@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GeneratedActorPool.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/World.h"
+
+AStaticMeshActor* FGeneratedActorPool::Acquire(UWorld* World, UStaticMesh* Mesh, const FTransform& Transform, TSubclassOf<AStaticMeshActor> Class)
+{
+	FGeneratedActorBucket& Bucket = Buckets.FindOrAdd(FGeneratedActorKey{ Class, Mesh });
+
+	// Skip anything that was deleted from outside the generator
+	while (Bucket.NumInUse < Bucket.Actors.Num() && !IsValid(Bucket.Actors[Bucket.NumInUse]))
+	{
+		PooledActors.Remove(Bucket.Actors[Bucket.NumInUse].Get());
+		Bucket.Actors.RemoveAtSwap(Bucket.NumInUse);
+	}
+
+	if (Bucket.NumInUse < Bucket.Actors.Num())
+	{
+		AStaticMeshActor* Actor = Bucket.Actors[Bucket.NumInUse++];
+		UStaticMeshComponent* MeshComp = Actor->GetStaticMeshComponent();
+
+		MeshComp->SetMobility(EComponentMobility::Movable);
+		Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+		MeshComp->EmptyOverrideMaterials();
+		Actor->Tags.Reset();
+		Actor->SetActorHiddenInGame(false);
+		Actor->SetActorEnableCollision(true);
+		return Actor;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	AStaticMeshActor* Actor = World->SpawnActor<AStaticMeshActor>(Class, Transform, SpawnParams);
+	if (!Actor)
+	{
+		return nullptr;
+	}
+
+	UStaticMeshComponent* MeshComp = Actor->GetStaticMeshComponent();
+	MeshComp->SetMobility(EComponentMobility::Movable);
+	MeshComp->SetStaticMesh(Mesh);
+
+	Bucket.Actors.Add(Actor);
+	Bucket.NumInUse = Bucket.Actors.Num();
+	PooledActors.Add(Actor);
+	return Actor;
+}
+
+void FGeneratedActorPool::ReleaseAll()
+{
+	for (TPair<FGeneratedActorKey, FGeneratedActorBucket>& Pair : Buckets)
+	{
+		Pair.Value.NumInUse = 0;
+	}
+}
+
+void FGeneratedActorPool::Release(AStaticMeshActor* Actor)
+{
+	if (!IsValid(Actor))
+	{
+		return;
+	}
+
+	FGeneratedActorBucket* Bucket = Buckets.Find(FGeneratedActorKey{ Actor->GetClass(), Actor->GetStaticMeshComponent()->GetStaticMesh() });
+	if (!Bucket)
+	{
+		return;
+	}
+
+	// Swap it to the end of the in-use range so it is the next one handed out
+	const int32 Index = Bucket->Actors.Find(Actor);
+	if (Index == INDEX_NONE || Index >= Bucket->NumInUse)
+	{
+		return;
+	}
+	Bucket->Actors.Swap(Index, --Bucket->NumInUse);
+
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->Tags.Reset();
+}
+
+void FGeneratedActorPool::HideUnused()
+{
+	for (TPair<FGeneratedActorKey, FGeneratedActorBucket>& Pair : Buckets)
+	{
+		FGeneratedActorBucket& Bucket = Pair.Value;
+		for (int32 Index = Bucket.NumInUse; Index < Bucket.Actors.Num(); ++Index)
+		{
+			if (AStaticMeshActor* Actor = Bucket.Actors[Index]; IsValid(Actor) && !Actor->IsHidden())
+			{
+				Actor->SetActorHiddenInGame(true);
+				Actor->SetActorEnableCollision(false);
+				// Tag lookups shouldn't find hidden actors
+				Actor->Tags.Reset();
+			}
+		}
+	}
+}
+
+void FGeneratedActorPool::DestroyUnused()
+{
+	for (TPair<FGeneratedActorKey, FGeneratedActorBucket>& Pair : Buckets)
+	{
+		FGeneratedActorBucket& Bucket = Pair.Value;
+		for (int32 Index = Bucket.NumInUse; Index < Bucket.Actors.Num(); ++Index)
+		{
+			PooledActors.Remove(Bucket.Actors[Index].Get());
+			if (AStaticMeshActor* Actor = Bucket.Actors[Index]; IsValid(Actor))
+			{
+				Actor->Destroy();
+			}
+		}
+		Bucket.Actors.SetNum(Bucket.NumInUse);
+	}
+}
+
+bool FGeneratedActorPool::Adopt(AStaticMeshActor* Actor)
+{
+	if (PooledActors.Contains(Actor))
+	{
+		return true;
+	}
+
+	UStaticMesh* Mesh = Actor ? Actor->GetStaticMeshComponent()->GetStaticMesh() : nullptr;
+	if (!Mesh)
+	{
+		return false;
+	}
+
+	Buckets.FindOrAdd(FGeneratedActorKey{ Actor->GetClass(), Mesh }).Actors.Add(Actor);
+	PooledActors.Add(Actor);
+	return true;
+}
+
+void FGeneratedActorPool::Empty()
+{
+	for (TPair<FGeneratedActorKey, FGeneratedActorBucket>& Pair : Buckets)
+	{
+		for (AStaticMeshActor* Actor : Pair.Value.Actors)
+		{
+			if (IsValid(Actor))
+			{
+				Actor->Destroy();
+			}
+		}
+	}
+	Buckets.Empty();
+	PooledActors.Empty();
+}
+
+int32 FGeneratedActorPool::Num() const
+{
+	int32 Total = 0;
+	for (const TPair<FGeneratedActorKey, FGeneratedActorBucket>& Pair : Buckets)
+	{
+		Total += Pair.Value.Actors.Num();
+	}
+	return Total;
+}
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StaticMeshActor.h"
+#include "GeneratedActorPool.generated.h"
+
+USTRUCT()
+struct FGeneratedActorKey
+{
+	GENERATED_BODY()
+
+	UPROPERTY() TSubclassOf<AStaticMeshActor> Class;
+	UPROPERTY() TObjectPtr<UStaticMesh> Mesh;
+
+	bool operator==(const FGeneratedActorKey& Other) const { return Class == Other.Class && Mesh == Other.Mesh; }
+
+	friend uint32 GetTypeHash(const FGeneratedActorKey& Key)
+	{
+		return HashCombine(GetTypeHash(Key.Class.Get()), GetTypeHash(Key.Mesh));
+	}
+};
+
+USTRUCT()
+struct FGeneratedActorBucket
+{
+	GENERATED_BODY()
+
+	UPROPERTY() TArray<TObjectPtr<AStaticMeshActor>> Actors;
+
+	// Actors [0, NumInUse) are handed out for the current level
+	int32 NumInUse = 0;
+};
+
+/**
+ * Static mesh actors kept around between generations, bucketed by class and mesh so a reused actor
+ * never needs a new mesh. Releasing a level keeps the actors alive, and anything not acquired again
+ * is hidden instead of destroyed, so regenerating with a warm pool creates no UObjects.
+ */
+USTRUCT()
+struct PROCEDURALGENERATION_API FGeneratedActorPool
+{
+	GENERATED_BODY()
+
+	// Returns a visible actor at the transform with its materials and tags reset, spawning only if the bucket is exhausted
+	AStaticMeshActor* Acquire(UWorld* World, UStaticMesh* Mesh, const FTransform& Transform, TSubclassOf<AStaticMeshActor> Class = AStaticMeshActor::StaticClass());
+
+	// Marks every actor as free without touching it, the next level reacquires them in the same order
+	void ReleaseAll();
+
+	// Hands a single actor back and hides it straight away, the next Acquire for its mesh reuses it
+	void Release(AStaticMeshActor* Actor);
+
+	// Hides and disables collision on every actor that wasn't acquired since the last ReleaseAll
+	void HideUnused();
+
+	// Destroys every actor that wasn't acquired since the last ReleaseAll, for worlds that get saved
+	void DestroyUnused();
+
+	// Takes in an actor the pool didn't spawn, such as one loaded with the level or duplicated for PIE, as a free
+	// actor. Actors already in the pool are left where they are. Returns false if there is no mesh to bucket it by.
+	bool Adopt(AStaticMeshActor* Actor);
+
+	// Destroys every pooled actor
+	void Empty();
+
+	int32 Num() const;
+
+private:
+	UPROPERTY(Transient) TMap<FGeneratedActorKey, FGeneratedActorBucket> Buckets;
+
+	// Every actor in the buckets, so adopting a level's worth of actors doesn't search them
+	TSet<TObjectKey<AStaticMeshActor>> PooledActors;
+};
@@ -0,0 +1,372 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GeneratedGeometry.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Components/StaticMeshComponent.h"
+
+// Around a platform's size, so most boxes sit in one to four cells and a probe looks at a few
+static constexpr float BoxCellSize = 1000.0f;
+
+bool FGeneratedBox::Raycast(const FVector& Start, const FVector& End, float Radius, float& OutTime, FVector& OutNormal) const
+{
+	// Slab test in the box's space, growing the box by the radius is close enough for the small probe spheres
+	const FVector LocalStart = Rotation.UnrotateVector(Start - Center);
+	const FVector LocalDelta = Rotation.UnrotateVector(End - Start);
+	const FVector GrownExtent = Extent + FVector(Radius);
+
+	float EnterTime = 0.0f;
+	float ExitTime = 1.0f;
+	int32 EnterAxis = INDEX_NONE;
+	float EnterSign = 0.0f;
+
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		if (FMath::Abs(LocalDelta[Axis]) < UE_SMALL_NUMBER)
+		{
+			if (FMath::Abs(LocalStart[Axis]) > GrownExtent[Axis])
+			{
+				return false;
+			}
+			continue;
+		}
+
+		const float InvDelta = 1.0f / LocalDelta[Axis];
+		const float Sign = LocalDelta[Axis] > 0.0f ? -1.0f : 1.0f;
+		const float NearTime = (Sign * GrownExtent[Axis] - LocalStart[Axis]) * InvDelta;
+		const float FarTime = (-Sign * GrownExtent[Axis] - LocalStart[Axis]) * InvDelta;
+
+		if (NearTime > EnterTime)
+		{
+			EnterTime = NearTime;
+			EnterAxis = Axis;
+			EnterSign = Sign;
+		}
+		ExitTime = FMath::Min(ExitTime, FarTime);
+
+		if (EnterTime > ExitTime)
+		{
+			return false;
+		}
+	}
+
+	OutTime = EnterTime;
+	if (EnterAxis == INDEX_NONE)
+	{
+		OutNormal = GetFaceNormal(Start);
+	}
+	else
+	{
+		FVector LocalNormal = FVector::ZeroVector;
+		LocalNormal[EnterAxis] = EnterSign;
+		OutNormal = Rotation.RotateVector(LocalNormal);
+	}
+	return true;
+}
+
+bool FGeneratedBox::OverlapsSphere(const FVector& Position, float Radius) const
+{
+	const FVector Local = Rotation.UnrotateVector(Position - Center);
+	const FVector Closest = Local.BoundToBox(-Extent, Extent);
+	return FVector::DistSquared(Local, Closest) <= FMath::Square(Radius);
+}
+
+bool FGeneratedBox::OverlapsCapsule(const FVector& Position, float Radius, float HalfHeight) const
+{
+	const FVector Axis(0.0f, 0.0f, FMath::Max(HalfHeight - Radius, 0.0f));
+	const FVector LocalA = Rotation.UnrotateVector(Position - Axis - Center);
+	const FVector LocalB = Rotation.UnrotateVector(Position + Axis - Center);
+
+	// Alternate between the closest point on the box and on the segment, both are convex so a few steps settle
+	FVector OnSegment = FMath::ClosestPointOnSegment(FVector::ZeroVector, LocalA, LocalB);
+	FVector OnBox = OnSegment.BoundToBox(-Extent, Extent);
+	for (int32 Step = 0; Step < 4; ++Step)
+	{
+		OnSegment = FMath::ClosestPointOnSegment(OnBox, LocalA, LocalB);
+		OnBox = OnSegment.BoundToBox(-Extent, Extent);
+	}
+
+	return FVector::DistSquared(OnSegment, OnBox) <= FMath::Square(Radius);
+}
+
+FVector FGeneratedBox::GetFaceNormal(const FVector& Point) const
+{
+	const FVector Local = Rotation.UnrotateVector(Point - Center);
+
+	int32 FaceAxis = 0;
+	float FaceRatio = -1.0f;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const float Ratio = Extent[Axis] > UE_SMALL_NUMBER ? FMath::Abs(Local[Axis]) / Extent[Axis] : 0.0f;
+		if (Ratio > FaceRatio)
+		{
+			FaceRatio = Ratio;
+			FaceAxis = Axis;
+		}
+	}
+
+	FVector LocalNormal = FVector::ZeroVector;
+	LocalNormal[FaceAxis] = Local[FaceAxis] >= 0.0f ? 1.0f : -1.0f;
+	return Rotation.RotateVector(LocalNormal);
+}
+
+bool FGeneratedBox::IsWithinFace(const FVector& Point, const FVector& FaceNormal) const
+{
+	const FVector Local = Rotation.UnrotateVector(Point - Center);
+	const FVector LocalNormal = Rotation.UnrotateVector(FaceNormal);
+
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		// Only the axes across the face, the depth axis is the one the normal points along
+		if (FMath::Abs(LocalNormal[Axis]) < 0.5f && FMath::Abs(Local[Axis]) > Extent[Axis])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+FGeneratedBox FGeneratedBox::FromLocalBounds(const FBox& LocalBounds, const FTransform& Transform, EGeneratedBoxType Type, const AActor* Actor)
+{
+	FGeneratedBox Box;
+	Box.Center = Transform.TransformPosition(LocalBounds.GetCenter());
+	Box.Rotation = Transform.GetRotation();
+	Box.Extent = LocalBounds.GetExtent() * Transform.GetScale3D().GetAbs();
+	Box.BoundingRadius = Box.Extent.Size();
+	Box.Type = Type;
+	Box.Actor = Actor;
+	return Box;
+}
+
+FGeneratedBox FGeneratedBox::FromComponent(const UPrimitiveComponent* Component, EGeneratedBoxType Type, const AActor* Actor)
+{
+	// Bounds worked out with no transform are the component's own, the world bounds would be axis aligned
+	const FBoxSphereBounds LocalBounds = Component->CalcBounds(FTransform::Identity);
+	return FromLocalBounds(LocalBounds.GetBox(), Component->GetComponentTransform(), Type, Actor);
+}
+
+void UGeneratedGeometrySubsystem::RegisterActor(AStaticMeshActor* Actor, EGeneratedBoxType Type)
+{
+	UStaticMeshComponent* MeshComp = Actor ? Actor->GetStaticMeshComponent() : nullptr;
+	UStaticMesh* Mesh = MeshComp ? MeshComp->GetStaticMesh() : nullptr;
+	if (!Mesh)
+	{
+		return;
+	}
+
+	const FBox LocalBounds = Mesh->GetBoundingBox();
+	const FTransform& Transform = MeshComp->GetComponentTransform();
+
+	int32& Index = BoxIndices.FindOrAdd(Actor, INDEX_NONE);
+	if (Index == INDEX_NONE)
+	{
+		Index = Boxes.AddDefaulted();
+	}
+	else
+	{
+		// Moved actors are re-bucketed from scratch
+		RemoveFromCells(Index);
+	}
+
+	FGeneratedBox& Box = Boxes[Index];
+	Box = FGeneratedBox::FromLocalBounds(LocalBounds, Transform, Type, Actor);
+
+	AddToCells(Index);
+	Ledges.AddBox(Box);
+}
+
+void UGeneratedGeometrySubsystem::UnregisterActor(const AActor* Actor)
+{
+	int32 Index = INDEX_NONE;
+	if (!BoxIndices.RemoveAndCopyValue(Actor, Index))
+	{
+		return;
+	}
+
+	Ledges.RemoveActor(Actor);
+
+	// The last box moves into the freed slot, so its cells have to point at the new index
+	RemoveFromCells(Index);
+	const int32 LastIndex = Boxes.Num() - 1;
+	if (Index != LastIndex)
+	{
+		RemoveFromCells(LastIndex);
+	}
+
+	Boxes.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	if (Boxes.IsValidIndex(Index))
+	{
+		BoxIndices.Add(Boxes[Index].Actor, Index);
+		AddToCells(Index);
+	}
+}
+
+FIntRect UGeneratedGeometrySubsystem::GetCellRange(const FVector& Center, float Radius)
+{
+	return FIntRect(
+		FMath::FloorToInt32((Center.X - Radius) / BoxCellSize), FMath::FloorToInt32((Center.Y - Radius) / BoxCellSize),
+		FMath::FloorToInt32((Center.X + Radius) / BoxCellSize), FMath::FloorToInt32((Center.Y + Radius) / BoxCellSize));
+}
+
+void UGeneratedGeometrySubsystem::AddToCells(int32 Index)
+{
+	const FGeneratedBox& Box = Boxes[Index];
+	const FIntRect Range = GetCellRange(Box.Center, Box.BoundingRadius);
+	for (int32 X = Range.Min.X; X <= Range.Max.X; ++X)
+	{
+		for (int32 Y = Range.Min.Y; Y <= Range.Max.Y; ++Y)
+		{
+			Cells.FindOrAdd(FIntPoint(X, Y)).Add(Index);
+		}
+	}
+}
+
+void UGeneratedGeometrySubsystem::RemoveFromCells(int32 Index)
+{
+	const FGeneratedBox& Box = Boxes[Index];
+	const FIntRect Range = GetCellRange(Box.Center, Box.BoundingRadius);
+	for (int32 X = Range.Min.X; X <= Range.Max.X; ++X)
+	{
+		for (int32 Y = Range.Min.Y; Y <= Range.Max.Y; ++Y)
+		{
+			const FIntPoint Cell(X, Y);
+			if (TArray<int32>* CellBoxes = Cells.Find(Cell))
+			{
+				CellBoxes->RemoveSingleSwap(Index, EAllowShrinking::No);
+				if (CellBoxes->IsEmpty())
+				{
+					Cells.Remove(Cell);
+				}
+			}
+		}
+	}
+}
+
+template <typename VisitorType>
+void UGeneratedGeometrySubsystem::ForEachBoxNear(const FVector& Center, float Radius, VisitorType&& Visitor) const
+{
+	const FIntRect Range = GetCellRange(Center, Radius);
+	for (int32 X = Range.Min.X; X <= Range.Max.X; ++X)
+	{
+		for (int32 Y = Range.Min.Y; Y <= Range.Max.Y; ++Y)
+		{
+			if (const TArray<int32>* CellBoxes = Cells.Find(FIntPoint(X, Y)))
+			{
+				for (const int32 Index : *CellBoxes)
+				{
+					if (!Visitor(Boxes[Index]))
+					{
+						return;
+					}
+				}
+			}
+		}
+	}
+}
+
+bool UGeneratedGeometrySubsystem::FindLedge(const FVector& Location, const FVector& Direction, float MaxDistance, float MinHeight, float MaxHeight, float HalfWidth, FGeneratedLedge& OutLedge, FVector& OutPoint) const
+{
+	if (!Ledges.FindLedge(Location, Direction, MaxDistance, MinHeight, MaxHeight, HalfWidth, OutLedge, OutPoint))
+	{
+		return false;
+	}
+
+	// Stop just short of the ledge's own face, anything hit before it is in the way
+	const FVector Forward = Direction.GetSafeNormal2D();
+	const FVector Start = Location + FVector(0.0f, 0.0f, MinHeight);
+	const float Distance = FVector::DotProduct(OutPoint - Location, Forward) - 1.0f;
+
+	FHitResult Hit;
+	const FGeneratedBox* Blocker = nullptr;
+	if (Distance > 0.0f && Raycast(Start, Start + Forward * Distance, 0.0f, Hit, &Blocker) && Blocker->Actor != OutLedge.Actor)
+	{
+		return false;
+	}
+	return true;
+}
+
+const FGeneratedBox* UGeneratedGeometrySubsystem::FindBox(const AActor* Actor) const
+{
+	const int32* Index = BoxIndices.Find(Actor);
+	return Index ? &Boxes[*Index] : nullptr;
+}
+
+template <typename FilterType>
+bool UGeneratedGeometrySubsystem::RaycastBoxes(const FVector& Start, const FVector& End, float Radius, FHitResult& OutHit, const FGeneratedBox** OutBox, FilterType&& Filter) const
+{
+	float BestTime = 2.0f;
+	FVector BestNormal = FVector::ZeroVector;
+	const FGeneratedBox* BestBox = nullptr;
+
+	// The sphere around the whole segment, probes are short so this stays a handful of cells
+	const FVector Middle = (Start + End) * 0.5f;
+	ForEachBoxNear(Middle, FVector::Dist(Start, End) * 0.5f + Radius, [&](const FGeneratedBox& Box)
+	{
+		if (!Filter(Box) || FMath::PointDistToSegmentSquared(Box.Center, Start, End) > FMath::Square(Box.BoundingRadius + Radius))
+		{
+			return true;
+		}
+
+		float Time;
+		FVector Normal;
+		if (Box.Raycast(Start, End, Radius, Time, Normal) && Time < BestTime)
+		{
+			BestTime = Time;
+			BestNormal = Normal;
+			BestBox = &Box;
+		}
+		return true;
+	});
+
+	if (BestTime > 1.0f)
+	{
+		return false;
+	}
+
+	OutHit = FHitResult(Start, End);
+	OutHit.bBlockingHit = true;
+	OutHit.bStartPenetrating = BestTime == 0.0f;
+	OutHit.Time = BestTime;
+	OutHit.Distance = (End - Start).Size() * BestTime;
+	OutHit.Location = Start + (End - Start) * BestTime;
+	OutHit.ImpactPoint = OutHit.Location - BestNormal * Radius;
+	OutHit.Normal = BestNormal;
+	OutHit.ImpactNormal = BestNormal;
+	if (OutBox)
+	{
+		*OutBox = BestBox;
+	}
+	return true;
+}
+
+bool UGeneratedGeometrySubsystem::Raycast(const FVector& Start, const FVector& End, float Radius, FHitResult& OutHit, const FGeneratedBox** OutBox) const
+{
+	return RaycastBoxes(Start, End, Radius, OutHit, OutBox, [](const FGeneratedBox&) { return true; });
+}
+
+bool UGeneratedGeometrySubsystem::Raycast(const FVector& Start, const FVector& End, float Radius, EGeneratedBoxType Type, FHitResult& OutHit, const FGeneratedBox** OutBox) const
+{
+	return RaycastBoxes(Start, End, Radius, OutHit, OutBox, [Type](const FGeneratedBox& Box) { return Box.Type == Type; });
+}
+
+bool UGeneratedGeometrySubsystem::OverlapSphere(const FVector& Position, float Radius) const
+{
+	bool bOverlaps = false;
+	ForEachBoxNear(Position, Radius, [&](const FGeneratedBox& Box)
+	{
+		bOverlaps = Box.IsNear(Position, Radius) && Box.OverlapsSphere(Position, Radius);
+		return !bOverlaps;
+	});
+	return bOverlaps;
+}
+
+bool UGeneratedGeometrySubsystem::OverlapCapsule(const FVector& Position, float Radius, float HalfHeight) const
+{
+	bool bOverlaps = false;
+	ForEachBoxNear(Position, HalfHeight, [&](const FGeneratedBox& Box)
+	{
+		bOverlaps = Box.IsNear(Position, HalfHeight) && Box.OverlapsCapsule(Position, Radius, HalfHeight);
+		return !bOverlaps;
+	});
+	return bOverlaps;
+}
@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "LedgeGraph.h"
+#include "GeneratedGeometry.generated.h"
+
+class AStaticMeshActor;
+class UPrimitiveComponent;
+
+enum class EGeneratedBoxType : uint8
+{
+	Platform,
+	WallRun,
+	Obstacle
+};
+
+/**
+ * Oriented box around a generated mesh, taken from the mesh bounds and the actor's transform when the
+ * generator places it. Queries are plain box maths so nothing goes through the physics scene.
+ */
+struct PROCEDURALGENERATION_API FGeneratedBox
+{
+	FVector Center = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FVector Extent = FVector::ZeroVector;
+
+	// Culls the box before any of the tests below
+	float BoundingRadius = 0.0f;
+
+	EGeneratedBoxType Type = EGeneratedBoxType::Platform;
+
+	// Only used to find the box again, the generator unregisters the actor before it goes away
+	const AActor* Actor = nullptr;
+
+	// Segment against the box grown by Radius. A start inside the box hits at time 0.
+	bool Raycast(const FVector& Start, const FVector& End, float Radius, float& OutTime, FVector& OutNormal) const;
+
+	bool OverlapsSphere(const FVector& Position, float Radius) const;
+
+	// Vertical capsule, HalfHeight includes the caps like FCollisionShape
+	bool OverlapsCapsule(const FVector& Position, float Radius, float HalfHeight) const;
+
+	// Normal of the face closest to a point on or near the box
+	FVector GetFaceNormal(const FVector& Point) const;
+
+	// Whether a point lies within the edges of the face with the given normal, ignoring its depth
+	bool IsWithinFace(const FVector& Point, const FVector& FaceNormal) const;
+
+	// Box around local space bounds placed by a transform, the way the generators register their meshes
+	static FGeneratedBox FromLocalBounds(const FBox& LocalBounds, const FTransform& Transform, EGeneratedBoxType Type, const AActor* Actor);
+
+	// Oriented box from a component's local bounds, for geometry the generators didn't register
+	static FGeneratedBox FromComponent(const UPrimitiveComponent* Component, EGeneratedBoxType Type, const AActor* Actor);
+
+	FORCEINLINE bool IsNear(const FVector& Point, float Distance) const
+	{
+		return FVector::DistSquared(Point, Center) <= FMath::Square(BoundingRadius + Distance);
+	}
+};
+
+/**
+ * Registry of the boxes the generators spawn, so the wall run can test generated walls, platforms and
+ * obstacles without physics traces. Generators register actors as they place them and unregister them
+ * when they are released or destroyed. Boxes are bucketed in a flat grid hash so queries only test the ones
+ * near them. The ledges around the box tops are kept alongside for vault and mantle sensing.
+ */
+UCLASS()
+class PROCEDURALGENERATION_API UGeneratedGeometrySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Adds or updates the actor's box, actors without a static mesh are skipped
+	void RegisterActor(AStaticMeshActor* Actor, EGeneratedBoxType Type);
+	void UnregisterActor(const AActor* Actor);
+
+	const FGeneratedBox* FindBox(const AActor* Actor) const;
+
+	// Nearest hit of the segment, grown by Radius, against the registered boxes
+	bool Raycast(const FVector& Start, const FVector& End, float Radius, FHitResult& OutHit, const FGeneratedBox** OutBox = nullptr) const;
+
+	// Same, but only against boxes of the given type
+	bool Raycast(const FVector& Start, const FVector& End, float Radius, EGeneratedBoxType Type, FHitResult& OutHit, const FGeneratedBox** OutBox = nullptr) const;
+
+	bool OverlapSphere(const FVector& Position, float Radius) const;
+	bool OverlapCapsule(const FVector& Position, float Radius, float HalfHeight) const;
+
+	FORCEINLINE int32 Num() const { return Boxes.Num(); }
+
+	FORCEINLINE const FLedgeGraph& GetLedges() const { return Ledges; }
+
+	// FLedgeGraph::FindLedge, but a ledge behind another box standing across the reach line at MinHeight is
+	// out of reach, the same as a trace at that height stopping on the nearer box
+	bool FindLedge(const FVector& Location, const FVector& Direction, float MaxDistance, float MinHeight, float MaxHeight, float HalfWidth, FGeneratedLedge& OutLedge, FVector& OutPoint) const;
+
+private:
+	// Cells covered by a sphere, or a box's bounding sphere, flattened onto the grid
+	static FIntRect GetCellRange(const FVector& Center, float Radius);
+
+	void AddToCells(int32 Index);
+	void RemoveFromCells(int32 Index);
+
+	// Calls Visitor for each box in the cells around the sphere, a box spanning several cells can come up more than once
+	template <typename VisitorType>
+	void ForEachBoxNear(const FVector& Center, float Radius, VisitorType&& Visitor) const;
+
+	// Raycast against the boxes Filter accepts
+	template <typename FilterType>
+	bool RaycastBoxes(const FVector& Start, const FVector& End, float Radius, FHitResult& OutHit, const FGeneratedBox** OutBox, FilterType&& Filter) const;
+
+	TArray<FGeneratedBox> Boxes;
+	TMap<const AActor*, int32> BoxIndices;
+
+	// Indices into Boxes by grid cell
+	TMap<FIntPoint, TArray<int32>> Cells;
+
+	FLedgeGraph Ledges;
+};
@@ -1,13 +1,23 @@
 #include "GrammarGenerator.h"
+#include "GeneratedGeometry.h"
+#include "GrammarLayoutBuilder.h"
+#include "LevelPack.h"
+#include "ProceduralGeneration/ParkourCollision.h"
+#include "ProceduralGeneration/ProcGenMemory.h"
+#include "ProceduralGeneration/ProcGenTrace.h"
 #include "Engine/World.h"
 #include "DrawDebugHelpers.h"
 #include "Engine/StaticMeshActor.h"
 #include "GameFramework/Actor.h"
-#include "Kismet/KismetMathLibrary.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/Paths.h"
 
 AGrammarGenerator::AGrammarGenerator()
 {
-    PrimaryActorTick.bCanEverTick = false;
+    // Only endless runs tick, and they only need to check the player's progress a few times a second
+    PrimaryActorTick.bCanEverTick = true;
+    PrimaryActorTick.bStartWithTickEnabled = false;
+    PrimaryActorTick.TickInterval = 0.2f;
 }
 
 void AGrammarGenerator::BeginPlay()
@@ -19,979 +29,509 @@ void AGrammarGenerator::BeginPlay()
 void AGrammarGenerator::Tick(float DeltaTime)
 {
     Super::Tick(DeltaTime);
-}
-
-void AGrammarGenerator::ClearLevel()
-{
-    // Clear Debug Messages
-    FlushPersistentDebugLines(GetWorld());
-    FlushDebugStrings(GetWorld());
 
-    // Clear all arrays of information
-    PlacedLocations.Empty();
-    PlacedScales.Empty();
-    if (!PlacedPlatforms.IsEmpty())
+    const APawn* Player = UGameplayStatics::GetPlayerPawn(this, 0);
+    if (!EndlessBuilder || !Player || Layout.Platforms.IsEmpty())
     {
-        for(auto Platform : PlacedPlatforms)
-        {
-            Platform->Destroy();
-        }
-        PlacedPlatforms.Empty();
+        return;
     }
-    
-    if (!PlacedObstacles.IsEmpty())
+
+    // Find the platform the player is closest to, the window is small enough to just scan it
+    const FVector3f PlayerLocation(Player->GetActorLocation() - GetActorLocation());
+    int32 ClosestIndex = 0;
+    float ClosestDistSq = MAX_flt;
+    for (int32 Index = 0; Index < Layout.Platforms.Num(); ++Index)
     {
-        for(auto Obstacle : PlacedObstacles)
+        const float DistSq = FVector3f::DistSquared(PlayerLocation, Layout.Platforms[Index].Location);
+        if (DistSq < ClosestDistSq)
         {
-            Obstacle->Destroy();
+            ClosestDistSq = DistSq;
+            ClosestIndex = Index;
         }
-        PlacedObstacles.Empty();
     }
 
-    if (!PlacedBuildings.IsEmpty())
+    if (Layout.Platforms.Num() - 1 - ClosestIndex < EndlessLookAhead)
     {
-        for(auto Building : PlacedBuildings)
-        {
-            Building->Destroy();
-        }
-        PlacedBuildings.Empty();
+        ExtendEndlessRun(EndlessExtendStep);
     }
-    
-}
-
-void AGrammarGenerator::GenerateLevel()
-{
-    ClearLevel();
-    
-    GeneratePlatformChain();
-
-    PopulateWorld();
 }
 
-EPlacementDirection AGrammarGenerator::GetOppositeDirection(EPlacementDirection Dir)
+void AGrammarGenerator::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-    switch (Dir)
-    {
-    case EPlacementDirection::Forward:  return EPlacementDirection::Backward;
-    case EPlacementDirection::Backward: return EPlacementDirection::Forward;
-    case EPlacementDirection::Left:     return EPlacementDirection::Right;
-    case EPlacementDirection::Right:    return EPlacementDirection::Left;
-    default: return Dir;
-    }
+    ActorPool.Empty();
+    Super::EndPlay(EndPlayReason);
 }
 
-void AGrammarGenerator::GeneratePlatformChain()
+void AGrammarGenerator::ClearLevel()
 {
-    LastPlatformLocation = GetActorLocation();
-    LastPlatformScale = FVector(FMath::RandRange(FSpawnParams.PlatformScale.X, FSpawnParams.PlatformScale.Y), FMath::RandRange(FSpawnParams.PlatformScale.X, FSpawnParams.PlatformScale.Y), FSpawnParams.PlatformScale.Z);
-    FRotator InitialRotation = FRotator(180.f, 0.f, 0.f); // Use identity rotation for proper alignment
-    LastPlatformRotation = InitialRotation;
-    FPlatformEdges LastPlatformEdges = CalculatePlatformEdges(LastPlatformLocation, LastPlatformScale, InitialRotation);
-    
-    SpawnPlatform(LastPlatformLocation, LastPlatformScale, InitialRotation, TEXT("Platform: 1 : Start"));
-    //DrawDebugLabel(TEXT("Platform: 1 : Start"), LastPlatformLocation);
-
-    // Debug spheres for corners
-    //DrawDebugSphere(GetWorld(), LastPlatformEdges.TopLeftCoord, 50.f, 12, FColor::Red, true, 30.f);
-    //DrawDebugSphere(GetWorld(), LastPlatformEdges.BottomLeftCoord, 50.f, 12, FColor::Orange, true, 30.f);
-    //DrawDebugSphere(GetWorld(), LastPlatformEdges.TopRightCoord, 50.f, 12, FColor::Yellow, true, 30.f);
-    //DrawDebugSphere(GetWorld(), LastPlatformEdges.BottomRightCoord, 50.f, 12, FColor::Blue, true, 30.f);
-
-    ExpandRule("StartRule", FSpawnParams.NumPlatforms - 1);
+    ReleaseLevel();
+    TrimActorPool();
 }
 
-void AGrammarGenerator::PopulateWorld()
+void AGrammarGenerator::TrimActorPool()
 {
-    FBox ParkourBounds(ForceInit);
-
-    for (const FVector& Loc : PlacedLocations)
+    if (GetWorld()->IsGameWorld())
     {
-        ParkourBounds += Loc;
+        ActorPool.HideUnused();
     }
-
-    FVector Min = ParkourBounds.Min - FVector(FDecorateRules.BufferDistance, FDecorateRules.BufferDistance, 0.f);
-    FVector Max = ParkourBounds.Max + FVector(FDecorateRules.BufferDistance, FDecorateRules.BufferDistance, 0.f);
-
-    float BuildingSpacing = 2200.f;
-
-    for (int32 Layer = 0; Layer < FDecorateRules.NumLayers; ++Layer)
+    else
     {
-        float Offset = Layer * FDecorateRules.LayerSpacing;
+        ActorPool.DestroyUnused();
+    }
+}
 
-        for (float X = Min.X; X <= Max.X; X += BuildingSpacing)
+void AGrammarGenerator::AdoptPlacedActors(const TArray<AActor*>& Actors)
+{
+    for (AActor* Actor : Actors)
+    {
+        if (!IsValid(Actor))
         {
-            // Bottom edge
-            SpawnBuilding(FVector(X, Min.Y - BuildingSpacing - Offset, 0.f));
-            // Top edge
-            SpawnBuilding(FVector(X, Max.Y + BuildingSpacing + Offset, 0.f));
+            continue;
         }
 
-        for (float Y = Min.Y; Y <= Max.Y; Y += BuildingSpacing)
+        if (!ActorPool.Adopt(Cast<AStaticMeshActor>(Actor)))
         {
-            // Left edge
-            SpawnBuilding(FVector(Min.X - BuildingSpacing - Offset, Y, 0.f));
-
-            // Right edge
-            SpawnBuilding(FVector(Max.X + BuildingSpacing + Offset, Y, 0.f));
+            Actor->Destroy();
         }
     }
 }
 
-void AGrammarGenerator::SpawnBuilding(const FVector& Location)
+void AGrammarGenerator::ReleaseLevel()
 {
-    if (FSpawnParams.PlatformMesh.Num() == 0) return;
-
-    int32 RandomIndex = FMath::RandRange(0, FSpawnParams.PlatformMesh.Num() - 1);
-    UStaticMesh* MeshToSpawn = FSpawnParams.PlatformMesh[RandomIndex];
-
-    FVector SpawnLocation = Location;
-    SpawnLocation.Z = FMath::RandRange((-FDecorateRules.SpawnHeight * 2), (FDecorateRules.SpawnHeight * 2));
+    // Clear Debug Messages
+    FlushPersistentDebugLines(GetWorld());
+    FlushDebugStrings(GetWorld());
 
-    AStaticMeshActor* Building = GetWorld()->SpawnActor<AStaticMeshActor>(SpawnLocation, FRotator(180.f, FMath::FRandRange(0.f, 360.f), 0.f));
-    if (Building)
+    if (UGeneratedGeometrySubsystem* GeneratedGeometry = GetWorld()->GetSubsystem<UGeneratedGeometrySubsystem>())
     {
-        Building->SetMobility(EComponentMobility::Movable);
-        
-        Building->GetStaticMeshComponent()->SetStaticMesh(MeshToSpawn);
+        for (AActor* Actor : PlacedPlatforms)
+        {
+            GeneratedGeometry->UnregisterActor(Actor);
+        }
+        for (AActor* Actor : PlacedObstacles)
+        {
+            GeneratedGeometry->UnregisterActor(Actor);
+        }
+    }
 
-        
-        float RandomHeightScale = FMath::FRandRange(FDecorateRules.SpawnScale.X, FDecorateRules.SpawnScale.Y); // taller or shorter
-        Building->GetStaticMeshComponent()->SetWorldScale3D(FVector(FMath::FRandRange(1.0f, 6.0f), FMath::FRandRange(1.0f, 6.0f), RandomHeightScale));
-        
-        Building->SetMobility(EComponentMobility::Static);
+    AdoptPlacedActors(PlacedPlatforms);
+    AdoptPlacedActors(PlacedObstacles);
+    AdoptPlacedActors(PlacedBuildings);
 
-        PlacedBuildings.Add(Building);
-    }
-}
+    // Clear all arrays of information, the actors themselves stay in the pool
+    Layout.Reset();
+    PlacedPlatforms.Reset();
+    PlacedObstacles.Reset();
+    PlacedBuildings.Reset();
 
-FString AGrammarGenerator::PickNextRule(EPlatformPlacementCategory Category)
-{
-    TArray<FString> PossibleNextRules;
-        switch (Category)
-        {
-        case EPlatformPlacementCategory::HorizontalForward:
-        case EPlatformPlacementCategory::HorizontalLeft:
-        case EPlatformPlacementCategory::HorizontalRight:
-        case EPlatformPlacementCategory::HorizontalBack:
-            PossibleNextRules = { "BesideRule", "SmallJumpRule", "AboveRule", "BelowRule", "FarRule", "VeryHighRule", "VeryLowRule" };
-            break;
-        case EPlatformPlacementCategory::LongJumpForward:
-        case EPlatformPlacementCategory::LongJumpBack:
-        case EPlatformPlacementCategory::LongJumpLeft:
-        case EPlatformPlacementCategory::LongJumpRight:
-            PossibleNextRules = { "SmallJumpRule", "AboveRule", "BelowRule", "BesideRule" };
-            break;
-        case EPlatformPlacementCategory::AboveForward:
-        case EPlatformPlacementCategory::AboveBack:
-        case EPlatformPlacementCategory::AboveLeft:
-        case EPlatformPlacementCategory::AboveRight:
-            PossibleNextRules = { "FarRule", "SmallJumpRule", "BesideRule" };
-            break;
-        case EPlatformPlacementCategory::BelowForward:
-        case EPlatformPlacementCategory::BelowBack:
-        case EPlatformPlacementCategory::BelowLeft:
-        case EPlatformPlacementCategory::BelowRight:
-            PossibleNextRules = { "FarRule", "BesideRule", "SmallJumpRule"};
-            break;
-        case EPlatformPlacementCategory::SmallJumpForward:
-        case EPlatformPlacementCategory::SmallJumpBack:
-        case EPlatformPlacementCategory::SmallJumpLeft:
-        case EPlatformPlacementCategory::SmallJumpRight:
-            PossibleNextRules = { "VeryHighRule", "VeryLowRule", "BesideRule", "FarRule", "AboveRule", "BelowRule" };
-            break;
-        case EPlatformPlacementCategory::VeryHighPoint:
-            PossibleNextRules = {"BesideRule" };
-            break;
-        case EPlatformPlacementCategory::VeryLowPoint:
-            PossibleNextRules = {"BesideRule" };
-            break;
-        default:
-            PossibleNextRules = { "BesideRule" };
-            break;
-        }
-        FString NextRule = PossibleNextRules[FMath::RandRange(0, PossibleNextRules.Num() - 1)];
+    EndlessBuilder.Reset();
+    EndlessSegments.Reset();
+    EndlessHead = 0;
 
-    return NextRule;
+    ActorPool.ReleaseAll();
 }
 
-void AGrammarGenerator::ExpandRule(const FString& Rule, int32 RemainingPlatforms)
+void AGrammarGenerator::GenerateLevel()
 {
-    if (RemainingPlatforms <= 0)
-    {
-        return;
-    }
+    PROCGEN_TRACE_SCOPE(GrammarGenerator_GenerateLevel);
 
-    if (!GrammarRules.Contains(Rule))
+    ReleaseLevel();
+
+    if (bRandomSeed)
     {
-        return;
+        Seed = FMath::Rand();
     }
 
-    // Pick a random expansion from the rule set.
-    const GrammarRule& SelectedRule = GrammarRules[Rule];
+    const FJumpEnvelope JumpEnvelope = FGrammarLayoutBuilder::MakeJumpEnvelope(FSpawnParams);
+    const uint64 ParameterHash = FGrammarLayoutBuilder::GetParameterHash(FSpawnParams, FDecorateRules, JumpEnvelope);
 
-    // Filter valid expansions
-    TArray<EPlatformPlacementCategory> ValidExpansions;
-    for (EPlatformPlacementCategory Category : SelectedRule.Expansions)
+    FLevelPack LevelPack;
+    FLevelLayoutView RealisedLayout;
+    if (bEndless)
     {
-        EPlacementDirection CandidateDir = ConvertToPlacementDirection(Category);
-        if (CandidateDir != GetOppositeDirection(LastPlacementDirection))
-        {
-            ValidExpansions.Add(Category);
-        }
-    }
+        StartEndlessRun();
+        Report = EndlessBuilder->GetReport();
 
-    // Pick a random category
-    EPlatformPlacementCategory NextCategory;
-    if (ValidExpansions.Num() > 0)
-    {
-        NextCategory = ValidExpansions[FMath::RandRange(0, ValidExpansions.Num() - 1)];
+        RealisedLayout = Layout.GetView();
     }
-    else
+    // Known seeds are realised straight out of the mapped pack without running the generator
+    else if (bUseLevelPack && LevelPack.Open(GetLevelPackPath()) && LevelPack.FindLayout(ParameterHash, Seed, RealisedLayout))
     {
-        // If no valid non-opposite moves, allow anything (safe fallback)
-        NextCategory = SelectedRule.Expansions[FMath::RandRange(0, SelectedRule.Expansions.Num() - 1)];
-    }
-
-    EPlacementDirection Dir = ConvertToPlacementDirection(NextCategory);
-    
-    // Generate a random scale for the new platform.
-    FVector NewScale(FMath::RandRange(FSpawnParams.PlatformScale.X, FSpawnParams.PlatformScale.Y), FMath::RandRange(FSpawnParams.PlatformScale.X, FSpawnParams.PlatformScale.Y), FSpawnParams.PlatformScale.Z);
-    
-    // Compute local offsets
-    FVector LocalBaseOffset = CalculateOffsetForDirection(Dir, LastPlatformScale, NewScale);
-    FVector LocalExtraOffset = FVector::ZeroVector;
-    if (!(NextCategory == EPlatformPlacementCategory::HorizontalForward ||
-          NextCategory == EPlatformPlacementCategory::HorizontalBack ||
-          NextCategory == EPlatformPlacementCategory::HorizontalLeft ||
-          NextCategory == EPlatformPlacementCategory::HorizontalRight))
-    {
-        LocalExtraOffset = CalculateOffsetForCategory(NextCategory);
-    }
-
-    // Rotate the local offsets by the parent's rotation
-    FVector WorldOffset = LastPlatformRotation.RotateVector(LocalBaseOffset + LocalExtraOffset);
-    FVector NewLocation = SnapToGrid(LastPlatformLocation + WorldOffset);
-    
-    // Change the way platform rotations work to fix mantle walls later :)
-    FRotator RelativeRotation = FRotator(180,0,0);//ComputeRotationForDirection(Dir);
-    FRotator NewRotation = FRotator(LastPlatformRotation.Pitch, LastPlatformRotation.Yaw + RelativeRotation.Yaw, LastPlatformRotation.Roll);
-
-    if (IsLocationValid(NewLocation, NewScale))
-    {
-        FText EnumDisplayName = StaticEnum<EPlatformPlacementCategory>()->GetDisplayNameTextByValue((int64)NextCategory);
-        SpawnPlatform(NewLocation, NewScale, NewRotation,FString::Printf(TEXT("Platform: %d : %s"), (FSpawnParams.NumPlatforms - RemainingPlatforms + 1), *EnumDisplayName.ToString()));
-        
-        //DrawDebugLabel(FString::Printf(TEXT("Platform %d (%s)"), FSpawnParams.NumPlatforms - RemainingPlatforms + 1, *UEnum::GetValueAsString(NextCategory)), NewLocation);
-
-        // Get edges of previous and current platform.
-        FPlatformEdges OldEdges = CalculatePlatformEdges(LastPlatformLocation, LastPlatformScale, LastPlatformRotation);
-        FPlatformEdges NewEdges = CalculatePlatformEdges(NewLocation, NewScale, NewRotation);
-        
-        SpawnObstaclesForCategory(NextCategory, OldEdges, NewEdges);
-        
-        FPlatformEdges NewPlatformEdges = CalculatePlatformEdges(NewLocation, NewScale, NewRotation);
-        //DrawDebugSphere(GetWorld(), NewPlatformEdges.TopLeftCoord, 50.f, 12, FColor::Red, true, 30.f);
-        //DrawDebugSphere(GetWorld(), NewPlatformEdges.BottomLeftCoord, 50.f, 12, FColor::Orange, true, 30.f);
-        //DrawDebugSphere(GetWorld(), NewPlatformEdges.TopRightCoord, 50.f, 12, FColor::Yellow, true, 30.f);
-        //DrawDebugSphere(GetWorld(), NewPlatformEdges.BottomRightCoord, 50.f, 12, FColor::Blue, true, 30.f);
-
-        // Update state.
-        LastPlatformLocation = NewLocation;
-        LastPlatformScale = NewScale;
-        LastPlatformRotation = NewRotation;
-        PlacedLocations.Add(NewLocation);
-        PlacedScales.Add(NewScale);
-        
-        // Determine the next rule to use.  
-        FString NextRule = PickNextRule(NextCategory);
-
-        LastPlacementDirection = Dir;
-        
-        // Recursively call next rule.
-        ExpandRule(NextRule, RemainingPlatforms - 1);
+        Report.Reset(TEXT("Grammar"), Seed, ParameterHash);
+        Report.bFromLevelPack = true;
+
+        ApplyMemoryBudget(RealisedLayout);
+        RealiseLayout(RealisedLayout);
     }
     else
     {
-        // Determine the next rule to use.  
-        FString NextRule = PickNextRule(NextCategory);
-        
-        // Recursive call.
-        ExpandRule(NextRule, RemainingPlatforms);
-        
-        UE_LOG(LogTemp, Warning, TEXT("No valid position: %s - Position: %d"), *UEnum::GetValueAsString(EPlatformPlacementCategory::HorizontalRight), FSpawnParams.NumPlatforms - RemainingPlatforms + 1);
+        FGrammarLayoutBuilder Builder(FSpawnParams, FDecorateRules, JumpEnvelope);
+        Builder.Build(Seed, ParameterHash, Layout);
+        Report = Builder.GetReport();
+
+        RealisedLayout = Layout.GetView();
+        ApplyMemoryBudget(RealisedLayout);
+        RealiseLayout(RealisedLayout);
     }
 
-}
+    // Anything left over from a bigger previous level is hidden rather than destroyed while playing
+    TrimActorPool();
 
-void AGrammarGenerator::CalculateClosestEdges(const FPlatformEdges& OldEdges,const FPlatformEdges& NewEdges,EPlatformPlacementCategory Category,FVector& OldStart,FVector& OldEnd,FVector& NewStart,FVector& NewEnd)
-{
-    switch (Category)
-    {
-    case EPlatformPlacementCategory::LongJumpForward:
-    case EPlatformPlacementCategory::BelowForward:
-    case EPlatformPlacementCategory::VeryLowPoint:
-        OldStart = OldEdges.BottomRightCoord;
-        OldEnd = OldEdges.TopRightCoord;
-        NewStart = NewEdges.BottomLeftCoord;
-        NewEnd = NewEdges.TopLeftCoord;
-        break;
+    SetActorTickEnabled(EndlessBuilder.IsValid());
 
-    case EPlatformPlacementCategory::LongJumpLeft:
-    case EPlatformPlacementCategory::BelowLeft:
-        OldStart = OldEdges.TopRightCoord;
-        OldEnd = OldEdges.TopLeftCoord;
-        NewStart = NewEdges.BottomRightCoord;
-        NewEnd = NewEdges.BottomLeftCoord;
-        break;
+    UpdateMemorySummary(RealisedLayout);
 
-    case EPlatformPlacementCategory::LongJumpRight:
-    case EPlatformPlacementCategory::BelowRight:
-        OldStart = OldEdges.BottomRightCoord;
-        OldEnd = OldEdges.BottomLeftCoord;
-        NewStart = NewEdges.TopRightCoord;
-        NewEnd = NewEdges.TopLeftCoord;
-        break;
+    UE_LOG(LogProcGen, Log, TEXT("Generated grammar seed %d%s in %.2fms: %d platforms, %d obstacles, %d actors spawned, %d reused, %.1fKB"),
+        Seed, Report.bFromLevelPack ? TEXT(" from level pack") : TEXT(""), Report.GetTotalTime(),
+        PlacedPlatforms.Num(), PlacedObstacles.Num(), Report.ActorsSpawned, Report.ActorsReused, Report.Memory.GetTotalBytes() / 1024.0);
 
-    default:
-        OldStart = FVector::ZeroVector;
-        OldEnd = FVector::ZeroVector;
-        NewStart = FVector::ZeroVector;
-        NewEnd = FVector::ZeroVector;
-        break;
+    if (bWriteGenerationReport)
+    {
+        Report.WriteJson(Report.GetDefaultFilename());
     }
+
+    OnLevelGenerated.Broadcast();
 }
 
-FPlatformCalculations AGrammarGenerator::CalculatePlatformProperties(const FPlatformEdges& PlatformEdges)
+void AGrammarGenerator::StartEndlessRun()
 {
-    FPlatformCalculations Properties;
-    
-    // Get bounds from PlatformEdges
-    Properties.MinBounds = PlatformEdges.BottomLeftCoord;
-    Properties.MaxBounds = PlatformEdges.TopRightCoord;
-    
-    // Calculate center of the platform at its lowest Z (ground level)
-    Properties.PlatformStart = FVector(
-        (Properties.MinBounds.X + Properties.MaxBounds.X) * 0.5f,  // Center X
-        (Properties.MinBounds.Y + Properties.MaxBounds.Y) * 0.5f,  // Center Y
-        Properties.MinBounds.Z                              // Bottom-most Z
-    );
-    
-    // Determine platform size and dimensions
-    Properties.PlatformSize = (Properties.MaxBounds - Properties.MinBounds).GetAbs();
-    Properties.PlatformWidth = Properties.PlatformSize.Y;
-    Properties.PlatformDepth = Properties.PlatformSize.X;
-    
-    // Determine the dominant axis for spawning obstacles
-    Properties.bSpawnAlongX = Properties.PlatformDepth > Properties.PlatformWidth;
-    
-    return Properties;
+    LLM_SCOPE_BYTAG(ProcGen_Actors);
+
+    // The window has to hold the look ahead plus a full extension, or the platform under the player could be recycled
+    const int32 WindowSize = FMath::Max(EndlessWindow, EndlessLookAhead + EndlessExtendStep + 2);
+    EndlessSegments.SetNum(WindowSize);
+    EndlessHead = 0;
+
+    const FJumpEnvelope JumpEnvelope = FGrammarLayoutBuilder::MakeJumpEnvelope(FSpawnParams);
+    EndlessBuilder = MakeShared<FGrammarLayoutBuilder>(FSpawnParams, FDecorateRules, JumpEnvelope);
+    EndlessBuilder->BeginChain(Seed, FGrammarLayoutBuilder::GetParameterHash(FSpawnParams, FDecorateRules, JumpEnvelope), Layout);
+
+    EndlessSegments[0].Platform = SpawnPlatform(Layout.Platforms[0]);
+    ExtendEndlessRun(WindowSize - 1);
 }
 
-FVector AGrammarGenerator::CalculateWallRunLocation(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category)
+void AGrammarGenerator::ExtendEndlessRun(int32 Count)
 {
-    FVector OldStart, OldEnd, NewStart, NewEnd;
-    
-    CalculateClosestEdges(OldEdges, NewEdges, Category, OldStart, OldEnd, NewStart, NewEnd);
+    PROCGEN_TRACE_SCOPE(GrammarGenerator_ExtendEndlessRun);
+    LLM_SCOPE_BYTAG(ProcGen_Actors);
 
-    if (OldStart.IsZero() || NewStart.IsZero())
+    const int32 WindowSize = EndlessSegments.Num();
+    const int32 ObstaclesBefore = Layout.Obstacles.Num();
+
+    SCOPE_CYCLE_COUNTER(STAT_ProcGen_Realise);
+
+    const int32 NumAdded = EndlessBuilder->ExtendChain(Count);
+    if (NumAdded == 0)
     {
-        // fallback incase something goes wrong
-        return FVector::ZeroVector; 
+        UE_LOG(LogProcGen, Warning, TEXT("Endless chain couldn't be extended"));
+        return;
     }
+    const int32 NumNewObstacles = Layout.Obstacles.Num() - ObstaclesBefore;
 
-    // Get midpoint of both platform edges
-    FVector OldMid = (OldStart + OldEnd) * 0.5f;
-    FVector NewMid = (NewStart + NewEnd) * 0.5f;
-
-    // Compute the final placement as the midpoint between the two edges
-    FVector WallRunLocation = (OldMid + NewMid) * 0.5f;
+    // Recycle the platforms that fell out the back of the window first, so the new ones reuse their actors
+    UGeneratedGeometrySubsystem* GeneratedGeometry = GetWorld()->GetSubsystem<UGeneratedGeometrySubsystem>();
+    const int32 NumExpired = FMath::Max(Layout.Platforms.Num() - WindowSize, 0);
+    for (int32 Index = 0; Index < NumExpired; ++Index)
+    {
+        FEndlessSegment& Segment = EndlessSegments[EndlessHead];
+        if (GeneratedGeometry)
+        {
+            GeneratedGeometry->UnregisterActor(Segment.Platform);
+            for (AStaticMeshActor* Obstacle : Segment.Obstacles)
+            {
+                GeneratedGeometry->UnregisterActor(Obstacle);
+            }
+        }
 
-    // Slight height adjustment to make it raised
-    WallRunLocation.Z += 100.f; 
+        ActorPool.Release(Segment.Platform);
+        for (AStaticMeshActor* Obstacle : Segment.Obstacles)
+        {
+            ActorPool.Release(Obstacle);
+        }
+        Segment.Platform = nullptr;
+        Segment.Obstacles.Reset();
 
-    return WallRunLocation;
-    
-}
+        EndlessHead = (EndlessHead + 1) % WindowSize;
+    }
+    EndlessBuilder->DropOldestPlatforms(NumExpired);
 
-FRotator AGrammarGenerator::CalculateWallRunRotation(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category)
-{
-    FVector OldStart, OldEnd, NewStart, NewEnd;
-    
-    CalculateClosestEdges(OldEdges, NewEdges, Category, OldStart, OldEnd, NewStart, NewEnd);
+    // The new records are at the end of the window
+    for (int32 Index = Layout.Platforms.Num() - NumAdded; Index < Layout.Platforms.Num(); ++Index)
+    {
+        EndlessSegments[(EndlessHead + Index) % WindowSize].Platform = SpawnPlatform(Layout.Platforms[Index]);
+    }
 
-    if (OldStart.IsZero() || NewStart.IsZero())
+    for (int32 Index = Layout.Obstacles.Num() - NumNewObstacles; Index < Layout.Obstacles.Num(); ++Index)
     {
-        // fallback incase something goes wrong
-        return FRotator::ZeroRotator; 
+        const FLayoutObstacle& Obstacle = Layout.Obstacles[Index];
+        if (AStaticMeshActor* ObstacleActor = SpawnObstacle(Obstacle))
+        {
+            EndlessSegments[(EndlessHead + Obstacle.PlatformIndex) % WindowSize].Obstacles.Add(ObstacleActor);
+        }
     }
-    
-    // calculate direction vector between platforms
-    FVector Direction = (((NewStart + NewEnd) / 2) - ((OldStart + OldEnd) / 2)).GetSafeNormal();
 
-    //DrawDebugSphere(GetWorld(), Direction, 100.f, 12, FColor::Purple, true, 30.f);
-    
-    return Direction.Rotation();
-    
+    // Keep the placed arrays in window order, respawning uses the oldest live platform
+    PlacedPlatforms.Reset();
+    PlacedObstacles.Reset();
+    for (int32 Index = 0; Index < Layout.Platforms.Num(); ++Index)
+    {
+        const FEndlessSegment& Segment = EndlessSegments[(EndlessHead + Index) % WindowSize];
+        PlacedPlatforms.Add(Segment.Platform);
+        PlacedObstacles.Append(Segment.Obstacles);
+    }
 }
 
-void AGrammarGenerator::SpawnWallRunObstacle(const FVector& Vector, const FRotator& Rotator, const float& Distance)
+void AGrammarGenerator::SaveLayoutToPack()
 {
-    // Spawn the wall run mesh
-    AStaticMeshActor* WallActor = GetWorld()->SpawnActor<AStaticMeshActor>(
-        AStaticMeshActor::StaticClass(),
-        Vector,
-        Rotator
-    );
-
-    if (WallActor)
-    {
-        UStaticMeshComponent* MeshComp = WallActor->GetStaticMeshComponent();
-        MeshComp->SetMobility(EComponentMobility::Movable);
-        MeshComp->SetStaticMesh(FSpawnParams.WallRunMesh);
-        
-        float Length = Distance * 0.8f;
-        float Height = FSpawnParams.WallRunHeight;
-        float Thickness = 50.0f;
-        
-        MeshComp->SetWorldScale3D(FVector(Length / 100.0f, Thickness / 100.0f, Height / 100.0f));
+    if (EndlessBuilder)
+    {
+        UE_LOG(LogProcGen, Warning, TEXT("Endless runs only hold a window of the chain and can't be saved to a level pack"));
+        return;
+    }
 
-        MeshComp->SetMaterial(0, FSpawnParams.ObstacleMaterial);
-        
-        WallActor->Tags.Add(FName("WallRun"));
-        PlacedObstacles.Add(WallActor);
+    if (Layout.Platforms.IsEmpty())
+    {
+        UE_LOG(LogProcGen, Warning, TEXT("No generated layout to save, generate a level first"));
+        return;
     }
-}
 
-float AGrammarGenerator::CalculateWallRunDistance(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category)
-{
-    FVector OldStart, OldEnd, NewStart, NewEnd;
-    
-    CalculateClosestEdges(OldEdges, NewEdges, Category, OldStart, OldEnd, NewStart, NewEnd);
+    const FString PackPath = GetLevelPackPath();
 
-    if (OldStart.IsZero() || NewStart.IsZero())
+    FLevelPackWriter Writer;
+    if (!Writer.Open(PackPath))
     {
-        // fallback incase something goes wrong
-        return 0; 
+        return;
     }
-    
-    return FVector::Dist(OldStart, NewStart);
-}
 
-void AGrammarGenerator::SpawnMantleObstacle(const FVector& Vector, const FRotator& Rotator)
-{
-    AStaticMeshActor* MantlePoint = GetWorld()->SpawnActor<AStaticMeshActor>(
-            AStaticMeshActor::StaticClass(),
-            Vector,
-            Rotator
-        );
-        
-    if (MantlePoint)
+    // Carry over everything already in the pack, a layout for the same key gets replaced by this one
+    FLevelPack ExistingPack;
+    if (ExistingPack.Open(PackPath))
     {
-        UStaticMeshComponent* MeshComp = MantlePoint->GetStaticMeshComponent();
-        MeshComp->SetMobility(EComponentMobility::Movable);
-        MeshComp->SetStaticMesh(FSpawnParams.MantleMesh);
-
-        MeshComp->SetWorldScale3D(FVector(.25, 20, 2.5f));
+        const bool bCopied = Writer.AddPack(ExistingPack);
+        ExistingPack.Close();
 
-        MeshComp->SetMaterial(0, FSpawnParams.ObstacleMaterial);
-        
-        MantlePoint->Tags.Add(FName("Mantle"));
-        PlacedObstacles.Add(MantlePoint);
+        // Closing now would replace the pack with a partial copy, the writer drops its temp file instead
+        if (!bCopied)
+        {
+            UE_LOG(LogProcGen, Error, TEXT("Failed copying the existing layouts of %s, seed %d wasn't saved"), *PackPath, Seed);
+            return;
+        }
     }
-}
 
-void AGrammarGenerator::SpawnMantleWalls(const FPlatformEdges& PlatformEdges)
-{
-    FVector MinBounds = PlatformEdges.BottomLeftCoord;
-    FVector MaxBounds = PlatformEdges.TopRightCoord;
-
-    // Calculate center of platform at its lowest Z (ground level)
-    FVector PlatformStart = FVector(
-        (MinBounds.X + MaxBounds.X) * 0.5f,
-        (MinBounds.Y + MaxBounds.Y) * 0.5f, 
-        MinBounds.Z                        
-    );
-
-    // Determine platform size
-    FVector PlatformSize = (MaxBounds - MinBounds).GetAbs();
-    float PlatformWidth = PlatformSize.Y;
-    float PlatformDepth = PlatformSize.X;
-    
-    FVector WallLocation = PlatformStart;
-
-    bool bSpawnAlongX = PlatformDepth > PlatformWidth;
-    FVector WallDirection = bSpawnAlongX ? FVector(1, 0, 0) : FVector(0, 1, 0);
-
-    FRotator WallRotation = FRotationMatrix::MakeFromXZ(WallDirection, FVector::UpVector).Rotator();
-
-    float Distance = bSpawnAlongX ? PlatformWidth : PlatformDepth;
-
-    WallLocation += bSpawnAlongX ? FVector(FMath::RandRange(-PlatformDepth * 0.4, PlatformDepth * 0.4), 0, 0) : FVector(0, FMath::RandRange(-PlatformWidth * 0.4, PlatformWidth * 0.4), 0);
-    
-    // Spawn the wall run mesh
-    AStaticMeshActor* MantleWallActor = GetWorld()->SpawnActor<AStaticMeshActor>(
-        AStaticMeshActor::StaticClass(),
-        WallLocation,
-        WallRotation
-    );
-
-    if (MantleWallActor)
-    {
-        UStaticMeshComponent* MeshComp = MantleWallActor->GetStaticMeshComponent();
-        MeshComp->SetMobility(EComponentMobility::Movable);
-        MeshComp->SetStaticMesh(FSpawnParams.WallRunMesh);
-        
-        MeshComp->SetWorldScale3D(FVector(.25, Distance / 100.f, 2.5));
+    const FJumpEnvelope JumpEnvelope = FGrammarLayoutBuilder::MakeJumpEnvelope(FSpawnParams);
+    if (!Writer.Add(FGrammarLayoutBuilder::GetParameterHash(FSpawnParams, FDecorateRules, JumpEnvelope), Seed, Layout.GetView()))
+    {
+        UE_LOG(LogProcGen, Error, TEXT("Failed writing seed %d to level pack %s"), Seed, *PackPath);
+        return;
+    }
 
-        MeshComp->SetMaterial(0, FSpawnParams.ObstacleMaterial);
-        
-        MantleWallActor->Tags.Add(FName("Mantle Wall"));
-        PlacedObstacles.Add(MantleWallActor);
+    if (Writer.Close())
+    {
+        UE_LOG(LogProcGen, Log, TEXT("Saved seed %d to level pack %s"), Seed, *PackPath);
     }
-    
 }
 
-void AGrammarGenerator::SpawnVaultObstacle(const FVector& Vector, const FRotator& Rotator, const float& Distance)
+void AGrammarGenerator::RealiseLayout(const FLevelLayoutView& LevelLayout)
 {
-    AStaticMeshActor* Vault = GetWorld()->SpawnActor<AStaticMeshActor>(
-            AStaticMeshActor::StaticClass(),
-            Vector,
-            Rotator
-        );
-        
-    if (Vault)
-    {
-        UStaticMeshComponent* MeshComp = Vault->GetStaticMeshComponent();
-        MeshComp->SetMobility(EComponentMobility::Movable);
-        MeshComp->SetStaticMesh(FSpawnParams.MantleMesh);
+    PROCGEN_TRACE_SCOPE(GrammarGenerator_RealiseLayout);
+    LLM_SCOPE_BYTAG(ProcGen_Actors);
 
-        float Length = Distance * 0.9f;
-        MeshComp->SetWorldScale3D(FVector(FMath::RandRange(0.15, 1.0), Length / 100, 1));
+    SCOPE_CYCLE_COUNTER(STAT_ProcGen_Realise);
+    FProcGenPhaseTimer PhaseTimer(Report, TEXT("Realise"));
+    PROCGEN_TRACE_BOOKMARK(TEXT("Grammar seed %d: Realise"), Seed);
 
-        MeshComp->SetMaterial(0, FSpawnParams.ObstacleMaterial);
+    const int32 PooledBefore = ActorPool.Num();
+    const int32 PlacedBefore = PlacedPlatforms.Num() + PlacedObstacles.Num() + PlacedBuildings.Num();
 
-        Vault->Tags.Add(FName("Vault"));
-        PlacedObstacles.Add(Vault);
+    for (const FLayoutPlatform& Platform : LevelLayout.Platforms)
+    {
+        SpawnPlatform(Platform);
+    }
 
+    for (const FLayoutObstacle& Obstacle : LevelLayout.Obstacles)
+    {
+        SpawnObstacle(Obstacle);
     }
-}
 
-void AGrammarGenerator::SpawnVaultObstacles(const FPlatformEdges& PlatformEdges)
-{
-    FPlatformCalculations Properties = CalculatePlatformProperties(PlatformEdges);
-    
-    FVector VaultStart = Properties.bSpawnAlongX ?
-        FVector(
-            (Properties.MinBounds.X - Properties.PlatformDepth),
-            (Properties.MinBounds.Y + Properties.MaxBounds.Y) / 2,
-            Properties.MinBounds.Z
-            ) :
-    FVector(
-        (Properties.MinBounds.X + Properties.MaxBounds.X) / 2,
-        (Properties.MaxBounds.Y - Properties.PlatformWidth),
-        Properties.MinBounds.Z
-        );
-    
-    FVector VaultDirection = Properties.bSpawnAlongX ? FVector(1, 0, 0) : FVector(0, 1, 0);
-    
-    VaultStart += Properties.bSpawnAlongX ? FVector(FMath::RandRange(100.f, (Properties.PlatformWidth / 3)), 0, 0)
-        : FVector(0, FMath::RandRange(100.f, Properties.PlatformDepth / 3), 0);
-
-    float Spacing = FMath::RandRange(550.f, 700.f);
-    
-    float Distance = Properties.bSpawnAlongX ? Properties.PlatformWidth : Properties.PlatformDepth;
-    
-    int NumVaults = std::min(static_cast<int>(Distance / Spacing), 7);
-    
-    UE_LOG(LogTemp, Warning, TEXT("HELP: %i"), NumVaults);
-
-    // figure out a way to spawn vaults depending on how big the platform space is. 
-    for (int i = 0; i < NumVaults; i++)
-    {
-        
-        FVector Offset = VaultDirection * (i * Spacing);
-        FVector VaultLocation = VaultStart + Offset;
-        VaultLocation.Z = Properties.MinBounds.Z;
-
-        // Ensure correct obstacle rotation
-        FRotator VaultRotation = FRotationMatrix::MakeFromXZ(VaultDirection, FVector::UpVector).Rotator();
-
-        SpawnVaultObstacle(VaultLocation, VaultRotation, Distance);
-        }
+    for (const FLayoutObstacle& Building : LevelLayout.Buildings)
+    {
+        SpawnBuilding(Building);
+    }
+
+    // The pool only grows when it had nothing free to hand out
+    const int32 NumSpawned = FMath::Max(ActorPool.Num() - PooledBefore, 0);
+    const int32 NumPlaced = PlacedPlatforms.Num() + PlacedObstacles.Num() + PlacedBuildings.Num() - PlacedBefore;
+    Report.AddActors(NumSpawned, FMath::Max(NumPlaced - NumSpawned, 0));
 }
 
-void AGrammarGenerator::SpawnMantleStaircase(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category, int32 StepCount)
+void AGrammarGenerator::ApplyMemoryBudget(FLevelLayoutView& LevelLayout)
 {
-    if (StepCount <= 1)
+    const int32 NumLayers = FDecorateRules.NumLayers;
+    if (MemoryBudgetMB <= 0.f || NumLayers <= 0 || LevelLayout.Buildings.IsEmpty())
     {
-        //GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, FString::Printf(TEXT("1 Mantle or less: %d"), StepCount));
         return;
     }
-    
-    FVector OldStart, OldEnd, NewStart, NewEnd;
-    
-    CalculateClosestEdges(OldEdges, NewEdges, Category, OldStart, OldEnd, NewStart, NewEnd);
 
-    if (OldStart.IsZero() || NewStart.IsZero())
+    const uint64 Budget = static_cast<uint64>(MemoryBudgetMB * 1024.0 * 1024.0);
+    const uint64 BytesPerActor = MeasuredBytesPerActor > 0 ? MeasuredBytesPerActor : static_cast<uint64>(FallbackBytesPerActor);
+    const uint64 GameplayBytes = LevelLayout.GetNumBytes() + (LevelLayout.Platforms.Num() + LevelLayout.Obstacles.Num()) * BytesPerActor;
+
+    // PopulateWorld adds the same number of buildings to every layer, innermost first
+    const int32 BuildingsPerLayer = LevelLayout.Buildings.Num() / NumLayers;
+
+    int32 KeptLayers = NumLayers;
+    while (KeptLayers > 0 && GameplayBytes + static_cast<uint64>(KeptLayers * BuildingsPerLayer) * BytesPerActor > Budget)
     {
-        //GEngine->AddOnScreenDebugMessage(-1, 5.0f, FColor::Red, FString::Printf(TEXT("IsZero")));
-        return;
+        --KeptLayers;
     }
 
-    // Get midpoint of both platform edges
-    FVector OldMid = (OldStart + OldEnd) * 0.5f;
-    FVector NewMid = (NewStart + NewEnd) * 0.5f;
-    
-    // Large horizontal movement and subtle vertical drop
-    /*for (int32 i = 0; i < StepCount; i++)
+    if (KeptLayers == NumLayers)
     {
-        
-        AStaticMeshActor* MantleCube = GetWorld()->SpawnActor<AStaticMeshActor>(
-            AStaticMeshActor::StaticClass(),
-            Start,
-            ForwardRotation
-        );
+        return;
+    }
 
-        if (MantleCube)
-        {
-            UStaticMeshComponent* MeshComp = MantleCube->GetStaticMeshComponent();
-            MeshComp->SetMobility(EComponentMobility::Movable);
-            MeshComp->SetStaticMesh(FSpawnParams.WallRunMesh);
-            MeshComp->SetWorldScale3D(FVector(5, 6, 2.5));
-            MeshComp->SetMaterial(0, FSpawnParams.ObstacleMaterial);
-            MantleCube->Tags.Add(FName("Mantle Wall"));
-            PlacedObstacles.Add(MantleCube);
-        }
-    }*/
-
-    AStaticMeshActor* MantleCube = GetWorld()->SpawnActor<AStaticMeshActor>(
-            AStaticMeshActor::StaticClass(),
-            NewMid,
-            FRotator::ZeroRotator
-        );
-
-    /*AStaticMeshActor* MantleCube2 = GetWorld()->SpawnActor<AStaticMeshActor>(
-            AStaticMeshActor::StaticClass(),
-            OldMid,
-            FRotator::ZeroRotator
-        );*/
-
-    if (MantleCube)
-    {
-        UStaticMeshComponent* MeshComp = MantleCube->GetStaticMeshComponent();
-        MeshComp->SetMobility(EComponentMobility::Movable);
-        MeshComp->SetStaticMesh(FSpawnParams.WallRunMesh);
-        MeshComp->SetWorldScale3D(FVector(5, 6, 2.5));
-        MeshComp->SetMaterial(0, FSpawnParams.ObstacleMaterial);
-        MantleCube->Tags.Add(FName("Mantle Wall"));
-        PlacedObstacles.Add(MantleCube);
+    LevelLayout.Buildings = LevelLayout.Buildings.Left(KeptLayers * BuildingsPerLayer);
+    Report.Memory.DroppedDecorationLayers = NumLayers - KeptLayers;
+
+    UE_LOG(LogProcGen, Log, TEXT("Dropped %d of %d decoration layers to fit the %.1fMB memory budget"), NumLayers - KeptLayers, NumLayers, MemoryBudgetMB);
 
-        /*UStaticMeshComponent* MeshComp2 = MantleCube2->GetStaticMeshComponent();
-        MeshComp2->SetMobility(EComponentMobility::Movable);
-        MeshComp2->SetStaticMesh(FSpawnParams.WallRunMesh);
-        MeshComp2->SetWorldScale3D(FVector(5, 6, 2.5));
-        MeshComp2->SetMaterial(0, FSpawnParams.StartPlatformMaterial);
-        MantleCube2->Tags.Add(FName("Mantle Wall"));
-        PlacedObstacles.Add(MantleCube2);*/
+    if (GameplayBytes > Budget)
+    {
+        UE_LOG(LogProcGen, Warning, TEXT("Grammar seed %d needs an estimated %.1fMB without decoration, over the %.1fMB budget"),
+            Seed, GameplayBytes / (1024.0 * 1024.0), MemoryBudgetMB);
     }
 }
 
-int32 AGrammarGenerator::HandleMantleSpawns(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges)
+void AGrammarGenerator::UpdateMemorySummary(const FLevelLayoutView& LevelLayout)
 {
-    // Calculate how many mantle steps to spawn
-    float HeightDifference = abs(NewEdges.Centre.Z - OldEdges.Centre.Z);
+    FProcGenMemorySummary& Memory = Report.Memory;
 
-    // Convert difference to steps, clamped to a safe range
-    int32 StepCount = FMath::Clamp(
-        FMath::CeilToInt(HeightDifference / FSpawnParams.GridUnit),
-        1,
-        10
-    );
+    // Packed layouts are read in place from the mapped file
+    Memory.PlanningBytes = Report.bFromLevelPack ? LevelLayout.GetNumBytes() : Layout.GetAllocatedSize();
 
-    return StepCount;
+    Memory.NumPlatforms = PlacedPlatforms.Num();
+    Memory.PlatformBytes = ProcGenMemory::EstimateActorBytes(PlacedPlatforms);
+    Memory.NumObstacles = PlacedObstacles.Num();
+    Memory.ObstacleBytes = ProcGenMemory::EstimateActorBytes(PlacedObstacles);
+    Memory.NumDecorations = PlacedBuildings.Num();
+    Memory.DecorationBytes = ProcGenMemory::EstimateActorBytes(PlacedBuildings);
+
+    if (Memory.GetBytesPerActor() > 0)
+    {
+        MeasuredBytesPerActor = Memory.GetBytesPerActor();
+    }
 }
 
-void AGrammarGenerator::SpawnObstaclesForCategory(EPlatformPlacementCategory Category,const FPlatformEdges& OldEdges,const FPlatformEdges& NewEdges)
+FString AGrammarGenerator::GetLevelPackPath() const
 {
-    switch (Category)
-    {
-        case EPlatformPlacementCategory::LongJumpForward:
-        case EPlatformPlacementCategory::LongJumpBack:
-        case EPlatformPlacementCategory::LongJumpLeft:
-        case EPlatformPlacementCategory::LongJumpRight:
-            {
-                FVector ObstacleLocation = CalculateWallRunLocation(OldEdges, NewEdges, Category);
-                FRotator ObstacleRotation = CalculateWallRunRotation(OldEdges, NewEdges, Category);
+    return FPaths::Combine(FPaths::ProjectContentDir(), LevelPackFile);
+}
 
-                float Distance = CalculateWallRunDistance(OldEdges, NewEdges, Category);
-                
-                SpawnWallRunObstacle(ObstacleLocation, ObstacleRotation, Distance);
-                
+void AGrammarGenerator::SpawnBuilding(const FLayoutObstacle& Building)
+{
+    LLM_SCOPE_BYTAG(ProcGen_Decoration);
 
-                SpawnMantleWalls(NewEdges);
-                break;
-            }
-        case EPlatformPlacementCategory::BelowForward:
-        case EPlatformPlacementCategory::BelowLeft:
-        case EPlatformPlacementCategory::BelowRight:
-        case EPlatformPlacementCategory::VeryLowPoint:
-            {
-                int32 StepCount = HandleMantleSpawns(OldEdges, NewEdges);
+    if (!FSpawnParams.PlatformMesh.IsValidIndex(Building.MeshIndex)) return;
 
-                SpawnMantleStaircase(OldEdges, NewEdges,Category, StepCount);
+    const FTransform Transform(FRotator(Building.Rotation), GetActorLocation() + FVector(Building.Location), FVector(Building.Scale));
 
-                SpawnVaultObstacles(NewEdges);
-                
-                break;
-            }
-        default:
-            {
-                SpawnVaultObstacles(NewEdges);
-                SpawnMantleWalls(NewEdges);
-                break;
-            }
-    }
-}
+    AStaticMeshActor* BuildingActor = ActorPool.Acquire(GetWorld(), FSpawnParams.PlatformMesh[Building.MeshIndex], Transform);
+    if (BuildingActor)
+    {
+        BuildingActor->SetMobility(EComponentMobility::Static);
+        // Pooled with the platforms that share its mesh, so the profile is set on every acquire
+        BuildingActor->GetStaticMeshComponent()->SetCollisionProfileName(ParkourCollision::DecorationProfile);
 
-EPlacementDirection AGrammarGenerator::ConvertToPlacementDirection(EPlatformPlacementCategory Category)
-{
-    switch (Category)
-    {
-    case EPlatformPlacementCategory::HorizontalForward:
-    case EPlatformPlacementCategory::SmallJumpForward:
-    case EPlatformPlacementCategory::LongJumpForward:
-    case EPlatformPlacementCategory::AboveForward:
-    case EPlatformPlacementCategory::BelowForward: 
-        return EPlacementDirection::Forward;
-    case EPlatformPlacementCategory::HorizontalLeft:
-    case EPlatformPlacementCategory::SmallJumpLeft:
-    case EPlatformPlacementCategory::LongJumpLeft:
-    case EPlatformPlacementCategory::AboveLeft:
-    case EPlatformPlacementCategory::BelowLeft: 
-        return EPlacementDirection::Left;
-    case EPlatformPlacementCategory::HorizontalRight:
-    case EPlatformPlacementCategory::SmallJumpRight:
-    case EPlatformPlacementCategory::LongJumpRight:
-    case EPlatformPlacementCategory::AboveRight:
-    case EPlatformPlacementCategory::BelowRight:
-        return EPlacementDirection::Right;
-    default:
-        return EPlacementDirection::Forward; // Default to Forward if invalid
+        PlacedBuildings.Add(BuildingActor);
     }
 }
 
-FVector AGrammarGenerator::CalculateOffsetForDirection(EPlacementDirection Direction, const FVector& CurrentScale, const FVector& NewScale) const
+AStaticMeshActor* AGrammarGenerator::SpawnObstacle(const FLayoutObstacle& Obstacle)
 {
-    // Calculate half-extents
-    FVector CurrentHalfExtents = CurrentScale * FSpawnParams.GridUnit;
-    FVector NewHalfExtents = NewScale * FSpawnParams.GridUnit;
-    FVector Offset = FVector::ZeroVector;
-
-    switch (Direction)
+    UStaticMesh* Mesh = nullptr;
+    FName Tag;
+    switch (Obstacle.Type)
     {
-    case EPlacementDirection::Forward:
-        Offset.X = CurrentHalfExtents.X + NewHalfExtents.X;
+    case ELayoutObstacleType::WallRun:
+        Mesh = FSpawnParams.WallRunMesh;
+        Tag = FName("WallRun");
         break;
-    case EPlacementDirection::Backward:
-        Offset.X = -(CurrentHalfExtents.X + NewHalfExtents.X);
+    case ELayoutObstacleType::Mantle:
+        Mesh = FSpawnParams.MantleMesh;
+        Tag = FName("Mantle");
         break;
-    case EPlacementDirection::Left:
-        Offset.Y = CurrentHalfExtents.Y + NewHalfExtents.Y;
+    case ELayoutObstacleType::MantleWall:
+        Mesh = FSpawnParams.WallRunMesh;
+        Tag = FName("Mantle Wall");
         break;
-    case EPlacementDirection::Right:
-        Offset.Y = -(CurrentHalfExtents.Y + NewHalfExtents.Y);
+    case ELayoutObstacleType::Vault:
+        Mesh = FSpawnParams.MantleMesh;
+        Tag = FName("Vault");
         break;
-    }
-    return Offset;
-}
-
-FRotator AGrammarGenerator::CalculateRotationForDirection(EPlacementDirection Direction) const
-{
-    switch (Direction)
-    {
-    case EPlacementDirection::Forward:
-        return FRotator(180.f, 0.f, 0.f);
-    case EPlacementDirection::Backward:
-        return FRotator(180.f, 180.f, 0.f);
-    case EPlacementDirection::Left:
-        return FRotator(180.f, -90.f, 0.f);
-    case EPlacementDirection::Right:
-        return FRotator(180.f, 90.f, 0.f);
     default:
-        return FRotator::ZeroRotator;
+        return nullptr;
     }
-}
 
-FVector AGrammarGenerator::CalculateOffsetForCategory(EPlatformPlacementCategory Category) const
-{
-    // Pre-calculate the Z offsets for Above and Below cases.
-    const float AboveZ = FMath::RandRange(FSpawnParams.AboveHeightMin, FSpawnParams.AboveHeightMax);
-    const float BelowZ = FMath::RandRange(FSpawnParams.BelowHeightMax, FSpawnParams.BelowHeightMin);
-
-    switch (Category)
-    {
-        // SMALL JUMPS
-        case EPlatformPlacementCategory::SmallJumpForward:
-            return FVector(FMath::RandRange(FSpawnParams.SmallJumpMinimum, FSpawnParams.SmallJumpMaximum), 
-                           0.f, 
-                           FMath::RandRange(-FSpawnParams.SmallJumpHeight, FSpawnParams.SmallJumpHeight));
-
-        case EPlatformPlacementCategory::SmallJumpLeft:
-            return FVector(0.f, 
-                           FMath::RandRange(FSpawnParams.SmallJumpMinimum, FSpawnParams.SmallJumpMaximum), 
-                           FMath::RandRange(-FSpawnParams.SmallJumpHeight, FSpawnParams.SmallJumpHeight));
-
-        case EPlatformPlacementCategory::SmallJumpRight:
-            return FVector(0.f, 
-                           -FMath::RandRange(FSpawnParams.SmallJumpMinimum, FSpawnParams.SmallJumpMaximum), 
-                           FMath::RandRange(-FSpawnParams.SmallJumpHeight, FSpawnParams.SmallJumpHeight));
-
-        // LONG JUMPS
-        case EPlatformPlacementCategory::LongJumpForward:
-            return FVector(FMath::RandRange(FSpawnParams.LongJumpMinimum, FSpawnParams.LongJumpMaximum), 
-                           0.f, 
-                           FMath::RandRange(-FSpawnParams.LongJumpHeight, FSpawnParams.LongJumpHeight));
-
-        case EPlatformPlacementCategory::LongJumpLeft:
-            return FVector(0.f, 
-                           FMath::RandRange(FSpawnParams.LongJumpMinimum, FSpawnParams.LongJumpMaximum), 
-                           FMath::RandRange(-FSpawnParams.LongJumpHeight, FSpawnParams.LongJumpHeight));
-
-        case EPlatformPlacementCategory::LongJumpRight:
-            return FVector(0.f, 
-                           -FMath::RandRange(FSpawnParams.LongJumpMinimum, FSpawnParams.LongJumpMaximum), 
-                           FMath::RandRange(-FSpawnParams.LongJumpHeight, FSpawnParams.LongJumpHeight));
-
-        // ABOVE placements
-        case EPlatformPlacementCategory::AboveForward:
-        case EPlatformPlacementCategory::AboveBack:
-        case EPlatformPlacementCategory::AboveLeft:
-        case EPlatformPlacementCategory::AboveRight:
-            return FVector(0.f, 0.f, AboveZ);
-
-        // BELOW placements
-        case EPlatformPlacementCategory::BelowForward:
-        case EPlatformPlacementCategory::BelowBack:
-        case EPlatformPlacementCategory::BelowLeft:
-        case EPlatformPlacementCategory::BelowRight:
-            return FVector(0.f, 0.f, BelowZ);
-
-        // High up / down points
-        case EPlatformPlacementCategory::VeryHighPoint:
-            return FVector(0.f, 0.f, AboveZ * 2.5f);
-
-        case EPlatformPlacementCategory::VeryLowPoint:
-            return FVector(0.f, 0.f, BelowZ * 2.5f);
-
-        default:
-            return FVector::ZeroVector;
+    const FTransform Transform(FRotator(Obstacle.Rotation), GetActorLocation() + FVector(Obstacle.Location), FVector(Obstacle.Scale));
+
+    AStaticMeshActor* ObstacleActor = ActorPool.Acquire(GetWorld(), Mesh, Transform);
+    if (ObstacleActor)
+    {
+        UStaticMeshComponent* MeshComp = ObstacleActor->GetStaticMeshComponent();
+        MeshComp->SetMaterial(0, FSpawnParams.ObstacleMaterial);
+        MeshComp->SetCollisionProfileName(ParkourCollision::GeometryProfile);
+
+        ObstacleActor->Tags.Add(Tag);
+        PlacedObstacles.Add(ObstacleActor);
+
+        if (UGeneratedGeometrySubsystem* GeneratedGeometry = GetWorld()->GetSubsystem<UGeneratedGeometrySubsystem>())
+        {
+            const bool bWallRun = Obstacle.Type == ELayoutObstacleType::WallRun || Obstacle.Type == ELayoutObstacleType::MantleWall;
+            GeneratedGeometry->RegisterActor(ObstacleActor, bWallRun ? EGeneratedBoxType::WallRun : EGeneratedBoxType::Obstacle);
+        }
     }
+
+    return ObstacleActor;
 }
 
-void AGrammarGenerator::SpawnPlatform(const FVector& Location, const FVector& Scale, const FRotator& Rotation, const FString& PlatformName)
+AStaticMeshActor* AGrammarGenerator::SpawnPlatform(const FLayoutPlatform& Platform)
 {
-    AStaticMeshActor* PlatformActor = GetWorld()->SpawnActor<AStaticMeshActor>(
-        AStaticMeshActor::StaticClass(), 
-        Location, 
-        Rotation
-    );
+    UStaticMesh* Mesh = FSpawnParams.PlatformMesh.IsValidIndex(Platform.MeshIndex) ? FSpawnParams.PlatformMesh[Platform.MeshIndex] : nullptr;
+    const FTransform Transform(FRotator(Platform.Rotation), GetActorLocation() + FVector(Platform.Location), FVector(Platform.Scale));
+
+    AStaticMeshActor* PlatformActor = ActorPool.Acquire(GetWorld(), Mesh, Transform);
 
-    if (!FSpawnParams.PlatformMesh.IsEmpty() && PlatformActor)
+    if (Mesh && PlatformActor)
     {
         UStaticMeshComponent* MeshComp = PlatformActor->GetStaticMeshComponent();
-        PlatformActor->SetMobility(EComponentMobility::Movable);
-        MeshComp->SetStaticMesh(FSpawnParams.PlatformMesh[FMath::RandRange(0, FSpawnParams.PlatformMesh.Num() - 1)]);
-        MeshComp->SetWorldScale3D(Scale);
-        //PlatformActor->SetActorLabel(PlatformName);
+        MeshComp->SetCollisionProfileName(ParkourCollision::GeometryProfile);
 
-        if(PlacedPlatforms.IsEmpty())
+        if (Platform.Flags & ELayoutPlatformFlags::Start)
         {
-            // if array is empty give this start platform material
             MeshComp->SetMaterial(0, FSpawnParams.StartPlatformMaterial);
         }
-        else if (PlacedPlatforms.Num() + 1 == FSpawnParams.NumPlatforms)
+        else if (Platform.Flags & ELayoutPlatformFlags::Finish)
         {
             MeshComp->SetMaterial(0, FSpawnParams.FinishPlatformMaterial);
             MeshComp->SetMaterial(1, FSpawnParams.FinishPlatformMaterial);
         }
     }
-    
-    // Optionally draw a debug sphere at the platform location.
-    //DrawDebugSphere(GetWorld(), Location, 100.f, 12, FColor::Cyan, true, 30.f);
 
     // add to array
     PlacedPlatforms.Add(PlatformActor);
-}
-
-FVector AGrammarGenerator::SnapToGrid(const FVector& Location) const
-{
-    return FVector(
-        FMath::RoundToInt(Location.X / FSpawnParams.GridUnit) * FSpawnParams.GridUnit,
-        FMath::RoundToInt(Location.Y / FSpawnParams.GridUnit) * FSpawnParams.GridUnit,
-        Location.Z
-    );
-}
 
-void AGrammarGenerator::DrawDebugLabel(const FString& Text, const FVector& Location) const
-{
-    if (GetWorld())
+    if (UGeneratedGeometrySubsystem* GeneratedGeometry = GetWorld()->GetSubsystem<UGeneratedGeometrySubsystem>())
     {
-        //DrawDebugString(GetWorld(), Location + FVector(0, 0, 150.f), Text, nullptr, FColor::White, 30.f);
+        GeneratedGeometry->RegisterActor(PlatformActor, EGeneratedBoxType::Platform);
     }
-}
 
-FPlatformEdges AGrammarGenerator::CalculatePlatformEdges(const FVector& Location, const FVector& Scale, const FRotator& Rotation) const
-{
-    FVector HalfExtents = Scale * FSpawnParams.GridUnit;
-    
-    FVector LocalTopLeftFront  = FVector(HalfExtents.X, -HalfExtents.Y, 0.f);
-    FVector LocalTopRightFront = FVector(HalfExtents.X, HalfExtents.Y, 0.f);
-    FVector LocalTopLeftBack   = FVector(-HalfExtents.X, -HalfExtents.Y, 0.f);
-    FVector LocalTopRightBack  = FVector(-HalfExtents.X, HalfExtents.Y, 0.f);
-
-    FVector TopLeftFront  = Location + Rotation.RotateVector(LocalTopLeftFront);
-    FVector TopRightFront = Location + Rotation.RotateVector(LocalTopRightFront);
-    FVector TopLeftBack   = Location + Rotation.RotateVector(LocalTopLeftBack);
-    FVector TopRightBack  = Location + Rotation.RotateVector(LocalTopRightBack);
-
-    return FPlatformEdges(TopLeftFront, TopRightFront, TopLeftBack, TopRightBack, Location);
+    return PlatformActor;
 }
 
-bool AGrammarGenerator::IsLocationValid(const FVector& Location, const FVector& Scale) const
+void AGrammarGenerator::DrawDebugLabel(const FString& Text, const FVector& Location) const
 {
-    // calculate bounding box for the new platform
-    FBox NewBox = CalculatePlatformBoundingBox(Location, Scale);
-
-    // Check against each placed platform
-    for (AActor* ExistingPlatform : PlacedPlatforms)
+    if (GetWorld())
     {
-        if (!IsValid(ExistingPlatform))
-        {
-            continue;
-        }
-
-        // Get the existing platform’s bounding box
-        FVector ExistingLocation = ExistingPlatform->GetActorLocation();
-        FVector ExistingScale    = ExistingPlatform->GetActorScale3D();
-        FBox ExistingBox         = CalculatePlatformBoundingBox(ExistingLocation, ExistingScale);
-        ExistingBox = ExistingBox.ExpandBy(-1.0f); // add some tolerance to allow for side by side spawns
-        
-        if (NewBox.Intersect(ExistingBox))
-        {
-            UE_LOG(LogTemp, Warning, TEXT("Intersection"));
-            
-            return false;
-        }
+        //DrawDebugString(GetWorld(), Location + FVector(0, 0, 150.f), Text, nullptr, FColor::White, 30.f);
     }
-    return true;
-}
-
-FBox AGrammarGenerator::CalculatePlatformBoundingBox(const FVector& Location, const FVector& Scale) const
-{
-    FVector BaseHalfExtents(FSpawnParams.GridUnit, FSpawnParams.GridUnit, FSpawnParams.PlatformScale.Z / 2); 
-    FVector AdjustedHalfExtents = BaseHalfExtents * Scale;  
-
-    FVector Min = Location - AdjustedHalfExtents;
-    FVector Max = Location + AdjustedHalfExtents;
-    return FBox(Min, Max);
 }
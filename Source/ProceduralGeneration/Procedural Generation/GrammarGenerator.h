@@ -2,15 +2,29 @@
 
 #include "Floor.h"               
 #include "LevelGenerator.h"
+#include "LevelLayout.h"
+#include "GeneratedActorPool.h"
+#include "ProcGenStats.h"
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "GrammarGenerator.generated.h"
 
+class ACharacter;
+
 struct GrammarRule
 {
     TArray<EPlatformPlacementCategory> Expansions;
 };
 
+class FGrammarLayoutBuilder;
+
+// Actors realised for one platform of an endless chain
+struct FEndlessSegment
+{
+    TObjectPtr<AStaticMeshActor> Platform;
+    TArray<TObjectPtr<AStaticMeshActor>> Obstacles;
+};
+
 struct FPlatformCalculations
 {
     FVector MinBounds;
@@ -186,8 +200,18 @@ struct FGrammarRules
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawn Parameters", meta = (DisplayName = "Long Jump Minimum Value")) int LongJumpMinimum = 800;
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawn Parameters", meta = (DisplayName = "Long Jump Maximum Value")) int LongJumpMaximum = 1500;
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Spawn Parameters", meta = (DisplayName = "Long Jump Height"))        int LongJumpHeight = 100;
+
+    // Reachability
+    // Placements this character can't jump to are rejected, leave empty to accept any non-overlapping placement
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Reachability") TSubclassOf<ACharacter> ReachabilityCharacter;
+    // Horizontal jump speed, 0 uses the character's MaxWalkSpeed
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Reachability") float ReachabilitySpeed = 750.f;
+    // How far above the feet a ledge can still be mantled mid-air
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Reachability") float LedgeReach = 100.f;
 };
 
+DECLARE_MULTICAST_DELEGATE(FOnLevelGenerated);
+
 UCLASS()
 class PROCEDURALGENERATION_API AGrammarGenerator : public AActor
 {
@@ -199,160 +223,76 @@ public:
     virtual void BeginPlay() override;
     virtual void Tick(float DeltaTime) override;
 
+    // Hides every generated actor, they stay pooled for the next GenerateLevel. Outside of play they are destroyed.
     void ClearLevel();
     // Called in-editor or at runtime to generate the level.
     UFUNCTION(BlueprintCallable, CallInEditor, Category = "Level Generation")
     void GenerateLevel();
 
-    EPlacementDirection GetOppositeDirection(EPlacementDirection Dir);
+    // Stores the current layout in the level pack so this seed can start without running the generator.
+    UFUNCTION(CallInEditor, Category = "Level Pack")
+    void SaveLayoutToPack();
+
+    /** Spawns the actors for a layout, either freshly built or viewed straight out of a level pack. */
+    void RealiseLayout(const FLevelLayoutView& LevelLayout);
+
+    FORCEINLINE const TArray<AActor*>& GetPlacedPlatforms() const { return PlacedPlatforms; }
+
+    // Broadcast at the end of every GenerateLevel once the new platforms are in place
+    FOnLevelGenerated OnLevelGenerated;
+
+    // Endless runs have no finish platform
+    FORCEINLINE bool IsEndless() const { return bEndless; }
+
+    FString GetLevelPackPath() const;
 
-    FPlatformCalculations CalculatePlatformProperties(const FPlatformEdges& PlatformEdges);
+    // Counts and timings of the last GenerateLevel
+    FORCEINLINE const FProcGenReport& GetLastReport() const { return Report; }
 
-    inline TArray<AActor*> GetPlacedPlatforms() { return PlacedPlatforms; };
+    // Estimated memory held by the current level, per platform and obstacle
+    FORCEINLINE const FProcGenMemorySummary& GetMemorySummary() const { return Report.Memory; }
+
+    FORCEINLINE const FGrammarRules& GetSpawnParams() const { return FSpawnParams; }
+    FORCEINLINE const FDecorateLevelRules& GetDecorateRules() const { return FDecorateRules; }
 
 protected:
-    // Grammar-based functions
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-    /** Spawns the first platform and then, using grammar rules, places subsequent platforms. */
-    void GeneratePlatformChain();
-    void PopulateWorld();
+    // Hands the generated actors back to the pool without hiding them
+    void ReleaseLevel();
 
-    // Functions for spawning in decorations
-    void SpawnBuilding(const FVector& Location);
+    // Hides pooled actors the current level doesn't use, or destroys them outside of play so they aren't saved with the map
+    void TrimActorPool();
 
-    // Chooses the next grammar rule depending on available options
-    FString PickNextRule(EPlatformPlacementCategory Category);
-    
-    // recursively calls this function to spawn platforms according to the next rule
-    void ExpandRule(const FString& Rule, int32 RemainingPlatforms);
-    
-    void CalculateClosestEdges(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category, FVector&
-                               OutOldEdgeStart, FVector& OutOldEdgeEnd, FVector& OutNewEdgeStart, FVector& OutNewEdgeEnd);
-    
-    FVector CalculateWallRunLocation(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category);
-    
-    FRotator CalculateWallRunRotation(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category);
-    
-    void SpawnWallRunObstacle(const FVector& Vector, const FRotator& Rotator, const float& Distance);
-    
-    float CalculateWallRunDistance(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category);
-    
-    void SpawnMantleObstacle(const FVector& Vector, const FRotator& Rotator);
-    
-    void SpawnMantleWalls(const FPlatformEdges& PlatformEdges);
-    
-    void SpawnVaultObstacle(const FVector& Vector, const FRotator& Rotator, const float& Distance);
-    
-    void SpawnVaultObstacles(const FPlatformEdges& PlatformEdges);
-    
-    void SpawnMantleStaircase(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category, int32 StepCount);
-    
-    int32 HandleMantleSpawns(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges);
-    
-    void SpawnObstaclesForCategory(EPlatformPlacementCategory NextCategory, const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges);
-    
-    EPlacementDirection ConvertToPlacementDirection(EPlatformPlacementCategory Category);
-    
-    auto CalculateOffsetForDirection(EPlacementDirection Direction, const FVector& CurrentScale,
-                                   const FVector& NewScale) const -> FVector;
-    
-    FRotator CalculateRotationForDirection(EPlacementDirection Direction) const;
+    // Placed actors the pool doesn't know about, left by a reloaded map or a PIE duplicate, are taken into the pool
+    // so they are reused or hidden like the rest. Anything it can't take is destroyed.
+    void AdoptPlacedActors(const TArray<AActor*>& Actors);
 
-    /** Calculate a relative offset (in world units) based on the chosen category. */
-    FVector CalculateOffsetForCategory(EPlatformPlacementCategory Category) const;
+    // Endless mode, starts a chain that fills the window and then extends as the player advances
+    void StartEndlessRun();
+    void ExtendEndlessRun(int32 Count);
 
-    /** Helper to spawn a platform at a given location. */
-    void SpawnPlatform(const FVector& Location, const FVector& Scale, const FRotator& Rotation, const FString& PlatformName);
-    
-    FVector SnapToGrid(const FVector& Location) const;
+    // Spawning functions, layout positions are relative to the generator
+    AStaticMeshActor* SpawnPlatform(const FLayoutPlatform& Platform);
+    AStaticMeshActor* SpawnObstacle(const FLayoutObstacle& Obstacle);
+    void SpawnBuilding(const FLayoutObstacle& Building);
+
+    // Drops the outer decoration layers from the view until the estimated level cost fits MemoryBudgetMB
+    void ApplyMemoryBudget(FLevelLayoutView& LevelLayout);
+    void UpdateMemorySummary(const FLevelLayoutView& LevelLayout);
 
     /** For debugging, draws a text label at a location. */
     void DrawDebugLabel(const FString& Text, const FVector& Location) const;
 
-    FPlatformEdges CalculatePlatformEdges(const FVector& Location, const FVector& Scale, const FRotator& Rotation) const;
-
-    TMap<FString, GrammarRule> GrammarRules = {
-    { "StartRule", {
-        {
-            // Forward
-            EPlatformPlacementCategory::SmallJumpForward,
-            EPlatformPlacementCategory::HorizontalForward,
-            EPlatformPlacementCategory::AboveForward,
-            EPlatformPlacementCategory::BelowForward,
-
-            EPlatformPlacementCategory::SmallJumpLeft,
-            EPlatformPlacementCategory::HorizontalLeft,
-            EPlatformPlacementCategory::AboveLeft,
-            EPlatformPlacementCategory::BelowLeft,
-
-            EPlatformPlacementCategory::SmallJumpRight,
-            EPlatformPlacementCategory::HorizontalRight,
-            EPlatformPlacementCategory::AboveRight,
-            EPlatformPlacementCategory::BelowRight,
-            EPlatformPlacementCategory::VeryHighPoint
-        } } },
-    { "BesideRule", {
-        {
-            // Forward
-            EPlatformPlacementCategory::HorizontalForward,
-            // Left
-            EPlatformPlacementCategory::HorizontalLeft,
-            // Right
-            EPlatformPlacementCategory::HorizontalRight
-        } } },
-    { "AboveRule", { {
-        // Forward
-        EPlatformPlacementCategory::AboveForward,
-        EPlatformPlacementCategory::SmallJumpForward,
-        // Left
-        EPlatformPlacementCategory::AboveLeft,
-        EPlatformPlacementCategory::SmallJumpLeft,
-        // Right
-        EPlatformPlacementCategory::AboveRight,
-        EPlatformPlacementCategory::SmallJumpRight
-    } } },
-    { "BelowRule", { {
-        // Forward
-        EPlatformPlacementCategory::BelowForward,
-        // Left
-        EPlatformPlacementCategory::BelowLeft,
-        // Right
-        EPlatformPlacementCategory::BelowRight, 
-    } } },
-    { "FarRule", { {
-        EPlatformPlacementCategory::LongJumpForward,
-        EPlatformPlacementCategory::LongJumpLeft,
-        EPlatformPlacementCategory::LongJumpRight, 
-    } } },
-    { "SmallJumpRule", { {
-        EPlatformPlacementCategory::SmallJumpForward,
-        EPlatformPlacementCategory::SmallJumpLeft,
-        EPlatformPlacementCategory::SmallJumpRight, 
-    } } },
-    { "VeryHighRule", {
-        {
-            EPlatformPlacementCategory::VeryHighPoint
-        } } },
-    { "VeryLowRule", {
-        {
-            EPlatformPlacementCategory::VeryLowPoint
-        } } }
-};
-    
 private:
-    // Track the last platform's location and scale (starting with the initial platform).
-    FVector LastPlatformLocation;
-    FVector LastPlatformScale;
-    FRotator LastPlatformRotation;
-    EPlacementDirection LastPlacementDirection;
-
-    // Helper function to check if a new platform intersects with existing platforms.
-    bool IsLocationValid(const FVector& Location, const FVector& Scale) const;
-    FBox CalculatePlatformBoundingBox(const FVector& Location, const FVector& Scale) const;
-
-    // Store placed platforms' locations and scales.
-    TArray<FVector> PlacedLocations;
-    TArray<FVector> PlacedScales;
+    // Layout built by the last GenerateLevel call, empty when the level came from the pack
+    FLevelLayout Layout;
+
+    FProcGenReport Report;
+
+    // Average actor cost of the last realised level, 0 until something has been spawned
+    uint64 MeasuredBytesPerActor = 0;
+
     // array for platforms
     UPROPERTY() TArray<AActor*> PlacedPlatforms;
     // array for obstacles
@@ -360,9 +300,60 @@ private:
     // array for Surrounding Buildings
     UPROPERTY() TArray<AActor*> PlacedBuildings;
 
-    TSet<FIntPoint> OccupiedCells;
+    // Every actor the generator has spawned, reused across regenerations. It isn't saved or duplicated, the
+    // placed arrays above are, so ReleaseLevel adopts whatever they hold that the pool doesn't.
+    UPROPERTY(Transient) FGeneratedActorPool ActorPool;
+
+    // Endless chain state. The layout holds the live window and the segments mirror it as a ring buffer,
+    // EndlessSegments[(EndlessHead + i) % EndlessSegments.Num()] being the actors for Layout.Platforms[i].
+    TSharedPtr<FGrammarLayoutBuilder> EndlessBuilder;
+    TArray<FEndlessSegment> EndlessSegments;
+    int32 EndlessHead = 0;
 
 protected:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = true, DisplayName = "Spawn Parameters")) FGrammarRules FSpawnParams;
     UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (AllowPrivateAccess = true, DisplayName = "Decoration Parameters")) FDecorateLevelRules FDecorateRules;
+
+    // Seed used for the generated layout, rolled on every generation when bRandomSeed is set
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level Generation")
+    int32 Seed = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level Generation")
+    bool bRandomSeed = true;
+
+    // Keep generating ahead of the player instead of stopping at NumPlatforms. Decorations are skipped.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Endless")
+    bool bEndless = false;
+
+    // Platforms kept alive at once, the actor count stays at this many platforms and their obstacles
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Endless", meta = (EditCondition = "bEndless", ClampMin = 4))
+    int32 EndlessWindow = 16;
+
+    // The chain is extended once the player is this many platforms from the front
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Endless", meta = (EditCondition = "bEndless", ClampMin = 2))
+    int32 EndlessLookAhead = 6;
+
+    // Platforms added per extension
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Endless", meta = (EditCondition = "bEndless", ClampMin = 1))
+    int32 EndlessExtendStep = 3;
+
+    // Look the seed up in the level pack before running the generator
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level Pack")
+    bool bUseLevelPack = true;
+
+    // Relative to the project content directory
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level Pack")
+    FString LevelPackFile = TEXT("LevelPacks/Grammar.lpk");
+
+    // Estimated memory a level may use, decoration layers are dropped from the outside in to stay under it. 0 is no limit.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Memory", meta = (ClampMin = 0, Units = "Megabytes"))
+    float MemoryBudgetMB = 0.f;
+
+    // Cost of one spawned actor for the budget until a level has been realised and measured
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Memory", meta = (ClampMin = 0))
+    int32 FallbackBytesPerActor = 16 * 1024;
+
+    // Writes the counts and phase timings of every generation to Saved/ProcGen as JSON
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug")
+    bool bWriteGenerationReport = false;
 };
\ No newline at end of file
@@ -0,0 +1,1097 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GrammarLayoutBuilder.h"
+#include "ProceduralGeneration/ProcGenMemory.h"
+#include "ProceduralGeneration/ProcGenTrace.h"
+#include "Hash/CityHash.h"
+#include "GameFramework/Character.h"
+
+FGrammarLayoutBuilder::FGrammarLayoutBuilder(const FGrammarRules& InSpawnParams, const FDecorateLevelRules& InDecorateRules, FJumpEnvelope InJumpEnvelope)
+    : SpawnParams(InSpawnParams)
+    , DecorateRules(InDecorateRules)
+    , JumpEnvelope(InJumpEnvelope)
+{
+}
+
+void FGrammarLayoutBuilder::Build(int32 Seed, uint64 ParameterHash, FLevelLayout& OutLayout)
+{
+    PROCGEN_TRACE_SCOPE(GrammarLayoutBuilder_Build);
+    LLM_SCOPE_BYTAG(ProcGen_Planning);
+
+    {
+        SCOPE_CYCLE_COUNTER(STAT_ProcGen_GrammarChain);
+        FProcGenPhaseTimer PhaseTimer(Report, TEXT("GrammarChain"));
+        PROCGEN_TRACE_BOOKMARK(TEXT("Grammar seed %d: GrammarChain"), Seed);
+
+        BeginChain(Seed, ParameterHash, OutLayout, false);
+
+        ExpandRule(PendingRule, SpawnParams.NumPlatforms - 1);
+    }
+
+    {
+        SCOPE_CYCLE_COUNTER(STAT_ProcGen_Decoration);
+        FProcGenPhaseTimer PhaseTimer(Report, TEXT("Decoration"));
+        PROCGEN_TRACE_BOOKMARK(TEXT("Grammar seed %d: Decoration"), Seed);
+
+        PopulateWorld();
+    }
+
+    Layout = nullptr;
+}
+
+void FGrammarLayoutBuilder::BeginChain(int32 Seed, uint64 ParameterHash, FLevelLayout& OutLayout, bool bInEndless)
+{
+    OutLayout.Reset();
+    Layout = &OutLayout;
+    bEndless = bInEndless;
+
+    CurrentSeed = Seed;
+    Report.Reset(TEXT("Grammar"), Seed, ParameterHash);
+    ChainRandom = FProcGenRandom(Seed, EProcGenStage::GrammarChain, 0);
+    LastPlacementDirection = EPlacementDirection::Forward;
+    FailedPlacements = 0;
+    NumPlaced = 0;
+
+    GeneratePlatformChain();
+}
+
+int32 FGrammarLayoutBuilder::ExtendChain(int32 Count)
+{
+    PROCGEN_TRACE_SCOPE(GrammarLayoutBuilder_ExtendChain);
+    LLM_SCOPE_BYTAG(ProcGen_Planning);
+
+    check(Layout);
+    SCOPE_CYCLE_COUNTER(STAT_ProcGen_GrammarChain);
+
+    const int32 PlacedBefore = NumPlaced;
+    FailedPlacements = 0;
+    ExpandRule(PendingRule, Count);
+
+    return NumPlaced - PlacedBefore;
+}
+
+void FGrammarLayoutBuilder::DropOldestPlatforms(int32 Count)
+{
+    check(Layout);
+
+    Count = FMath::Min(Count, Layout->Platforms.Num());
+    if (Count <= 0)
+    {
+        return;
+    }
+
+    // Records are kept in platform order, so everything referencing the dropped platforms is at the front
+    Layout->Platforms.RemoveAt(0, Count, EAllowShrinking::No);
+
+    Layout->Obstacles.RemoveAll([Count](const FLayoutObstacle& Obstacle) { return Obstacle.PlatformIndex < Count; });
+    for (FLayoutObstacle& Obstacle : Layout->Obstacles)
+    {
+        Obstacle.PlatformIndex -= Count;
+    }
+
+    Layout->Connections.RemoveAll([Count](const FLayoutConnection& Connection) { return Connection.From < Count || Connection.To < Count; });
+    for (FLayoutConnection& Connection : Layout->Connections)
+    {
+        Connection.From -= Count;
+        Connection.To -= Count;
+    }
+}
+
+uint64 FGrammarLayoutBuilder::GetParameterHash(const FGrammarRules& SpawnParams, const FDecorateLevelRules& DecorateRules, const FJumpEnvelope& JumpEnvelope)
+{
+    uint64 Hash = 0;
+    auto Mix = [&Hash](const auto& Value)
+    {
+        Hash = CityHash64WithSeed(reinterpret_cast<const char*>(&Value), sizeof(Value), Hash);
+    };
+
+    // Meshes and materials only matter when realising, the number of platform meshes changes the picks though
+    Mix(SpawnParams.NumPlatforms);
+    Mix(SpawnParams.PlatformScale);
+    Mix(SpawnParams.GridUnit);
+    Mix(SpawnParams.PlatformMesh.Num());
+    Mix(SpawnParams.WallRunHeight);
+    Mix(SpawnParams.AboveGapMinimum);
+    Mix(SpawnParams.AboveGapMaximum);
+    Mix(SpawnParams.AboveHeightMin);
+    Mix(SpawnParams.AboveHeightMax);
+    Mix(SpawnParams.BelowGapMinimum);
+    Mix(SpawnParams.BelowGapMaximum);
+    Mix(SpawnParams.BelowHeightMin);
+    Mix(SpawnParams.BelowHeightMax);
+    Mix(SpawnParams.SmallJumpMinimum);
+    Mix(SpawnParams.SmallJumpMaximum);
+    Mix(SpawnParams.SmallJumpHeight);
+    Mix(SpawnParams.LongJumpMinimum);
+    Mix(SpawnParams.LongJumpMaximum);
+    Mix(SpawnParams.LongJumpHeight);
+
+    Mix(DecorateRules.NumLayers);
+    Mix(DecorateRules.LayerSpacing);
+    Mix(DecorateRules.BufferDistance);
+    Mix(DecorateRules.SpawnHeight);
+    Mix(DecorateRules.SpawnScale);
+
+    // Only mixed in when validation is on, so packs built without it keep their keys
+    if (SpawnParams.ReachabilityCharacter)
+    {
+        Mix(JumpEnvelope.JumpZVelocity);
+        Mix(JumpEnvelope.Gravity);
+        Mix(JumpEnvelope.HorizontalSpeed);
+        Mix(JumpEnvelope.LedgeReach);
+    }
+
+    return Hash;
+}
+
+FJumpEnvelope FGrammarLayoutBuilder::MakeJumpEnvelope(const FGrammarRules& SpawnParams)
+{
+    check(IsInGameThread());
+
+    if (!SpawnParams.ReachabilityCharacter)
+    {
+        return FJumpEnvelope();
+    }
+    return FJumpEnvelope::FromCharacter(SpawnParams.ReachabilityCharacter.GetDefaultObject(), SpawnParams.ReachabilitySpeed, SpawnParams.LedgeReach);
+}
+
+EPlacementDirection FGrammarLayoutBuilder::GetOppositeDirection(EPlacementDirection Dir)
+{
+    switch (Dir)
+    {
+    case EPlacementDirection::Forward:  return EPlacementDirection::Backward;
+    case EPlacementDirection::Backward: return EPlacementDirection::Forward;
+    case EPlacementDirection::Left:     return EPlacementDirection::Right;
+    case EPlacementDirection::Right:    return EPlacementDirection::Left;
+    default: return Dir;
+    }
+}
+
+void FGrammarLayoutBuilder::GeneratePlatformChain()
+{
+    LastPlatformLocation = FVector::ZeroVector;
+    LastPlatformScale = FVector(ChainRandom.FRandRange(SpawnParams.PlatformScale.X, SpawnParams.PlatformScale.Y), ChainRandom.FRandRange(SpawnParams.PlatformScale.X, SpawnParams.PlatformScale.Y), SpawnParams.PlatformScale.Z);
+    FRotator InitialRotation = FRotator(180.f, 0.f, 0.f); // Use identity rotation for proper alignment
+    LastPlatformRotation = InitialRotation;
+
+    AddPlatform(LastPlatformLocation, LastPlatformScale, InitialRotation, EPlatformPlacementCategory::HorizontalForward);
+
+    PendingRule = TEXT("StartRule");
+}
+
+void FGrammarLayoutBuilder::PopulateWorld()
+{
+    PROCGEN_TRACE_SCOPE(GrammarLayoutBuilder_PopulateWorld);
+    LLM_SCOPE_BYTAG(ProcGen_Decoration);
+
+    FBox ParkourBounds(ForceInit);
+
+    for (const FLayoutPlatform& Platform : Layout->Platforms)
+    {
+        ParkourBounds += FVector(Platform.Location);
+    }
+
+    FVector Min = ParkourBounds.Min - FVector(DecorateRules.BufferDistance, DecorateRules.BufferDistance, 0.f);
+    FVector Max = ParkourBounds.Max + FVector(DecorateRules.BufferDistance, DecorateRules.BufferDistance, 0.f);
+
+    float BuildingSpacing = 2200.f;
+
+    for (int32 Layer = 0; Layer < DecorateRules.NumLayers; ++Layer)
+    {
+        float Offset = Layer * DecorateRules.LayerSpacing;
+
+        for (float X = Min.X; X <= Max.X; X += BuildingSpacing)
+        {
+            // Bottom edge
+            AddBuilding(FVector(X, Min.Y - BuildingSpacing - Offset, 0.f));
+            // Top edge
+            AddBuilding(FVector(X, Max.Y + BuildingSpacing + Offset, 0.f));
+        }
+
+        for (float Y = Min.Y; Y <= Max.Y; Y += BuildingSpacing)
+        {
+            // Left edge
+            AddBuilding(FVector(Min.X - BuildingSpacing - Offset, Y, 0.f));
+
+            // Right edge
+            AddBuilding(FVector(Max.X + BuildingSpacing + Offset, Y, 0.f));
+        }
+    }
+}
+
+void FGrammarLayoutBuilder::AddBuilding(const FVector& Location)
+{
+    if (SpawnParams.PlatformMesh.Num() == 0) return;
+
+    FProcGenRandom Random(CurrentSeed, EProcGenStage::Decoration, Layout->Buildings.Num());
+
+    int32 RandomIndex = Random.RandRange(0, SpawnParams.PlatformMesh.Num() - 1);
+
+    // Height, yaw, height scale and the two footprint scales in one batch, same values and order as drawing them one by one
+    float Fractions[5];
+    Random.FillFractions(Fractions);
+
+    FVector SpawnLocation = Location;
+    SpawnLocation.Z = FMath::Lerp(-DecorateRules.SpawnHeight * 2, DecorateRules.SpawnHeight * 2, Fractions[0]);
+
+    FRotator SpawnRotation(180.f, FMath::Lerp(0.f, 360.f, Fractions[1]), 0.f);
+
+    float RandomHeightScale = FMath::Lerp(DecorateRules.SpawnScale.X, DecorateRules.SpawnScale.Y, Fractions[2]); // taller or shorter
+    FVector SpawnScale(FMath::Lerp(1.0f, 6.0f, Fractions[3]), FMath::Lerp(1.0f, 6.0f, Fractions[4]), RandomHeightScale);
+
+    FLayoutObstacle& Building = Layout->Buildings.AddZeroed_GetRef();
+    Building.Location = FVector3f(SpawnLocation);
+    Building.Scale = FVector3f(SpawnScale);
+    Building.Rotation = FRotator3f(SpawnRotation);
+    Building.MeshIndex = RandomIndex;
+    Building.PlatformIndex = INDEX_NONE;
+    Building.Type = ELayoutObstacleType::Building;
+
+    Report.AddObstacle(ELayoutObstacleType::Building);
+}
+
+FString FGrammarLayoutBuilder::PickNextRule(EPlatformPlacementCategory Category)
+{
+    TArray<FString> PossibleNextRules;
+        switch (Category)
+        {
+        case EPlatformPlacementCategory::HorizontalForward:
+        case EPlatformPlacementCategory::HorizontalLeft:
+        case EPlatformPlacementCategory::HorizontalRight:
+        case EPlatformPlacementCategory::HorizontalBack:
+            PossibleNextRules = { "BesideRule", "SmallJumpRule", "AboveRule", "BelowRule", "FarRule", "VeryHighRule", "VeryLowRule" };
+            break;
+        case EPlatformPlacementCategory::LongJumpForward:
+        case EPlatformPlacementCategory::LongJumpBack:
+        case EPlatformPlacementCategory::LongJumpLeft:
+        case EPlatformPlacementCategory::LongJumpRight:
+            PossibleNextRules = { "SmallJumpRule", "AboveRule", "BelowRule", "BesideRule" };
+            break;
+        case EPlatformPlacementCategory::AboveForward:
+        case EPlatformPlacementCategory::AboveBack:
+        case EPlatformPlacementCategory::AboveLeft:
+        case EPlatformPlacementCategory::AboveRight:
+            PossibleNextRules = { "FarRule", "SmallJumpRule", "BesideRule" };
+            break;
+        case EPlatformPlacementCategory::BelowForward:
+        case EPlatformPlacementCategory::BelowBack:
+        case EPlatformPlacementCategory::BelowLeft:
+        case EPlatformPlacementCategory::BelowRight:
+            PossibleNextRules = { "FarRule", "BesideRule", "SmallJumpRule"};
+            break;
+        case EPlatformPlacementCategory::SmallJumpForward:
+        case EPlatformPlacementCategory::SmallJumpBack:
+        case EPlatformPlacementCategory::SmallJumpLeft:
+        case EPlatformPlacementCategory::SmallJumpRight:
+            PossibleNextRules = { "VeryHighRule", "VeryLowRule", "BesideRule", "FarRule", "AboveRule", "BelowRule" };
+            break;
+        case EPlatformPlacementCategory::VeryHighPoint:
+            PossibleNextRules = {"BesideRule" };
+            break;
+        case EPlatformPlacementCategory::VeryLowPoint:
+            PossibleNextRules = {"BesideRule" };
+            break;
+        default:
+            PossibleNextRules = { "BesideRule" };
+            break;
+        }
+        FString NextRule = PossibleNextRules[ChainRandom.RandRange(0, PossibleNextRules.Num() - 1)];
+
+    return NextRule;
+}
+
+void FGrammarLayoutBuilder::ExpandRule(const FString& StartRule, int32 RemainingPlatforms)
+{
+    PROCGEN_TRACE_SCOPE(GrammarLayoutBuilder_ExpandRule);
+
+    const TMap<FString, GrammarRule>& GrammarRules = GetGrammarRules();
+
+    // Loops rather than recursing per platform, long chains built on worker threads would otherwise run out of stack
+    FString Rule = StartRule;
+    while (RemainingPlatforms > 0)
+    {
+        const GrammarRule* SelectedRule = GrammarRules.Find(Rule);
+        if (!SelectedRule)
+        {
+            return;
+        }
+
+        // With a jump envelope a whole batch of candidates is drawn and tested at once, the first one that is both
+        // reachable and free is placed. Without one this is a single candidate, same as it always was.
+        const int32 NumCandidates = JumpEnvelope.IsValid() ? FJumpEnvelope::BatchWidth : 1;
+        FPlacementCandidate Candidates[FJumpEnvelope::BatchWidth];
+        for (int32 Index = 0; Index < NumCandidates; ++Index)
+        {
+            Candidates[Index] = MakeCandidate(*SelectedRule);
+        }
+
+        const uint32 ReachableMask = TestReachability(Candidates, NumCandidates);
+
+        int32 ChosenIndex = INDEX_NONE;
+        for (int32 Index = 0; Index < NumCandidates; ++Index)
+        {
+            const bool bAccepted = (ReachableMask & (1u << Index)) && IsLocationValid(Candidates[Index].Location, Candidates[Index].Scale);
+            Report.AddPlacementAttempt(static_cast<int32>(Candidates[Index].Category), bAccepted);
+
+            if (bAccepted)
+            {
+                ChosenIndex = Index;
+                break;
+            }
+        }
+
+        const FPlacementCandidate& Chosen = Candidates[ChosenIndex == INDEX_NONE ? 0 : ChosenIndex];
+        const EPlatformPlacementCategory NextCategory = Chosen.Category;
+        const EPlacementDirection Dir = Chosen.Direction;
+        const FVector& NewLocation = Chosen.Location;
+        const FVector& NewScale = Chosen.Scale;
+        const FRotator& NewRotation = Chosen.Rotation;
+
+        if (ChosenIndex != INDEX_NONE)
+        {
+            AddPlatform(NewLocation, NewScale, NewRotation, NextCategory);
+
+            // Get edges of previous and current platform.
+            FPlatformEdges OldEdges = CalculatePlatformEdges(LastPlatformLocation, LastPlatformScale, LastPlatformRotation);
+            FPlatformEdges NewEdges = CalculatePlatformEdges(NewLocation, NewScale, NewRotation);
+
+            AddObstaclesForCategory(NextCategory, OldEdges, NewEdges);
+
+            // Update state.
+            FailedPlacements = 0;
+            LastPlatformLocation = NewLocation;
+            LastPlatformScale = NewScale;
+            LastPlatformRotation = NewRotation;
+
+            // Determine the next rule to use, kept so an endless chain can carry on from here.
+            Rule = PickNextRule(NextCategory);
+            PendingRule = Rule;
+
+            LastPlacementDirection = Dir;
+
+            --RemainingPlatforms;
+        }
+        else
+        {
+            // Some seeds paint themselves into a corner, give up rather than retrying forever
+            if (++FailedPlacements > MaxFailedPlacements)
+            {
+                UE_LOG(LogProcGen, Warning, TEXT("Gave up placing platform %d after %d attempts"), NumPlaced + 1, MaxFailedPlacements);
+                return;
+            }
+
+            UE_LOG(LogProcGen, Verbose, TEXT("No valid position: %s - Position: %d"), *UEnum::GetValueAsString(NextCategory), NumPlaced + 1);
+
+            // Retry the same platform with a new rule.
+            Rule = PickNextRule(NextCategory);
+        }
+    }
+}
+
+FGrammarLayoutBuilder::FPlacementCandidate FGrammarLayoutBuilder::MakeCandidate(const GrammarRule& SelectedRule)
+{
+    FPlacementCandidate Candidate;
+
+    // Filter valid expansions
+    TArray<EPlatformPlacementCategory, TInlineAllocator<8>> ValidExpansions;
+    for (EPlatformPlacementCategory Category : SelectedRule.Expansions)
+    {
+        EPlacementDirection CandidateDir = ConvertToPlacementDirection(Category);
+        if (CandidateDir != GetOppositeDirection(LastPlacementDirection))
+        {
+            ValidExpansions.Add(Category);
+        }
+    }
+
+    // Pick a random category
+    if (ValidExpansions.Num() > 0)
+    {
+        Candidate.Category = ValidExpansions[ChainRandom.RandRange(0, ValidExpansions.Num() - 1)];
+    }
+    else
+    {
+        // If no valid non-opposite moves, allow anything (safe fallback)
+        Candidate.Category = SelectedRule.Expansions[ChainRandom.RandRange(0, SelectedRule.Expansions.Num() - 1)];
+    }
+
+    Candidate.Direction = ConvertToPlacementDirection(Candidate.Category);
+
+    // Generate a random scale for the new platform.
+    Candidate.Scale = FVector(ChainRandom.FRandRange(SpawnParams.PlatformScale.X, SpawnParams.PlatformScale.Y), ChainRandom.FRandRange(SpawnParams.PlatformScale.X, SpawnParams.PlatformScale.Y), SpawnParams.PlatformScale.Z);
+
+    // Compute local offsets
+    FVector LocalBaseOffset = CalculateOffsetForDirection(Candidate.Direction, LastPlatformScale, Candidate.Scale);
+    FVector LocalExtraOffset = FVector::ZeroVector;
+    if (!(Candidate.Category == EPlatformPlacementCategory::HorizontalForward ||
+          Candidate.Category == EPlatformPlacementCategory::HorizontalBack ||
+          Candidate.Category == EPlatformPlacementCategory::HorizontalLeft ||
+          Candidate.Category == EPlatformPlacementCategory::HorizontalRight))
+    {
+        LocalExtraOffset = CalculateOffsetForCategory(Candidate.Category);
+    }
+
+    // Rotate the local offsets by the parent's rotation
+    FVector WorldOffset = LastPlatformRotation.RotateVector(LocalBaseOffset + LocalExtraOffset);
+    Candidate.Location = SnapToGrid(LastPlatformLocation + WorldOffset);
+
+    // Change the way platform rotations work to fix mantle walls later :)
+    FRotator RelativeRotation = FRotator(180,0,0);//ComputeRotationForDirection(Dir);
+    Candidate.Rotation = FRotator(LastPlatformRotation.Pitch, LastPlatformRotation.Yaw + RelativeRotation.Yaw, LastPlatformRotation.Roll);
+
+    return Candidate;
+}
+
+uint32 FGrammarLayoutBuilder::TestReachability(const FPlacementCandidate* Candidates, int32 NumCandidates) const
+{
+    const uint32 AllCandidates = (1u << NumCandidates) - 1;
+    if (!JumpEnvelope.IsValid())
+    {
+        return AllCandidates;
+    }
+
+    const FBox LastBox = CalculatePlatformBoundingBox(LastPlatformLocation, LastPlatformScale);
+
+    // Unused lanes get an impossible jump so they never report as reachable
+    alignas(16) float Gaps[FJumpEnvelope::BatchWidth] = { MAX_flt, MAX_flt, MAX_flt, MAX_flt };
+    alignas(16) float HeightDeltas[FJumpEnvelope::BatchWidth] = { MAX_flt, MAX_flt, MAX_flt, MAX_flt };
+    uint32 AssistedMask = 0;
+
+    for (int32 Index = 0; Index < NumCandidates; ++Index)
+    {
+        const FBox NewBox = CalculatePlatformBoundingBox(Candidates[Index].Location, Candidates[Index].Scale);
+
+        // Edge to edge distance on the ground plane
+        const double GapX = FMath::Max3(0.0, NewBox.Min.X - LastBox.Max.X, LastBox.Min.X - NewBox.Max.X);
+        const double GapY = FMath::Max3(0.0, NewBox.Min.Y - LastBox.Max.Y, LastBox.Min.Y - NewBox.Max.Y);
+
+        Gaps[Index] = static_cast<float>(FMath::Sqrt(GapX * GapX + GapY * GapY));
+        HeightDeltas[Index] = static_cast<float>(NewBox.Max.Z - LastBox.Max.Z);
+
+        // Long jumps always get a wall run to cross them
+        switch (Candidates[Index].Category)
+        {
+        case EPlatformPlacementCategory::LongJumpForward:
+        case EPlatformPlacementCategory::LongJumpBack:
+        case EPlatformPlacementCategory::LongJumpLeft:
+        case EPlatformPlacementCategory::LongJumpRight:
+            AssistedMask |= 1u << Index;
+            break;
+        default:
+            break;
+        }
+    }
+
+    return (JumpEnvelope.TestBatch(Gaps, HeightDeltas) | AssistedMask) & AllCandidates;
+}
+
+void FGrammarLayoutBuilder::CalculateClosestEdges(const FPlatformEdges& OldEdges,const FPlatformEdges& NewEdges,EPlatformPlacementCategory Category,FVector& OldStart,FVector& OldEnd,FVector& NewStart,FVector& NewEnd) const
+{
+    switch (Category)
+    {
+    case EPlatformPlacementCategory::LongJumpForward:
+    case EPlatformPlacementCategory::BelowForward:
+    case EPlatformPlacementCategory::VeryLowPoint:
+        OldStart = OldEdges.BottomRightCoord;
+        OldEnd = OldEdges.TopRightCoord;
+        NewStart = NewEdges.BottomLeftCoord;
+        NewEnd = NewEdges.TopLeftCoord;
+        break;
+
+    case EPlatformPlacementCategory::LongJumpLeft:
+    case EPlatformPlacementCategory::BelowLeft:
+        OldStart = OldEdges.TopRightCoord;
+        OldEnd = OldEdges.TopLeftCoord;
+        NewStart = NewEdges.BottomRightCoord;
+        NewEnd = NewEdges.BottomLeftCoord;
+        break;
+
+    case EPlatformPlacementCategory::LongJumpRight:
+    case EPlatformPlacementCategory::BelowRight:
+        OldStart = OldEdges.BottomRightCoord;
+        OldEnd = OldEdges.BottomLeftCoord;
+        NewStart = NewEdges.TopRightCoord;
+        NewEnd = NewEdges.TopLeftCoord;
+        break;
+
+    default:
+        OldStart = FVector::ZeroVector;
+        OldEnd = FVector::ZeroVector;
+        NewStart = FVector::ZeroVector;
+        NewEnd = FVector::ZeroVector;
+        break;
+    }
+}
+
+FPlatformCalculations FGrammarLayoutBuilder::CalculatePlatformProperties(const FPlatformEdges& PlatformEdges)
+{
+    FPlatformCalculations Properties;
+
+    // Get bounds from PlatformEdges
+    Properties.MinBounds = PlatformEdges.BottomLeftCoord;
+    Properties.MaxBounds = PlatformEdges.TopRightCoord;
+
+    // Calculate center of the platform at its lowest Z (ground level)
+    Properties.PlatformStart = FVector(
+        (Properties.MinBounds.X + Properties.MaxBounds.X) * 0.5f,  // Center X
+        (Properties.MinBounds.Y + Properties.MaxBounds.Y) * 0.5f,  // Center Y
+        Properties.MinBounds.Z                              // Bottom-most Z
+    );
+
+    // Determine platform size and dimensions
+    Properties.PlatformSize = (Properties.MaxBounds - Properties.MinBounds).GetAbs();
+    Properties.PlatformWidth = Properties.PlatformSize.Y;
+    Properties.PlatformDepth = Properties.PlatformSize.X;
+
+    // Determine the dominant axis for spawning obstacles
+    Properties.bSpawnAlongX = Properties.PlatformDepth > Properties.PlatformWidth;
+
+    return Properties;
+}
+
+FVector FGrammarLayoutBuilder::CalculateWallRunLocation(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category) const
+{
+    FVector OldStart, OldEnd, NewStart, NewEnd;
+
+    CalculateClosestEdges(OldEdges, NewEdges, Category, OldStart, OldEnd, NewStart, NewEnd);
+
+    if (OldStart.IsZero() || NewStart.IsZero())
+    {
+        // fallback incase something goes wrong
+        return FVector::ZeroVector;
+    }
+
+    // Get midpoint of both platform edges
+    FVector OldMid = (OldStart + OldEnd) * 0.5f;
+    FVector NewMid = (NewStart + NewEnd) * 0.5f;
+
+    // Compute the final placement as the midpoint between the two edges
+    FVector WallRunLocation = (OldMid + NewMid) * 0.5f;
+
+    // Slight height adjustment to make it raised
+    WallRunLocation.Z += 100.f;
+
+    return WallRunLocation;
+
+}
+
+FRotator FGrammarLayoutBuilder::CalculateWallRunRotation(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category) const
+{
+    FVector OldStart, OldEnd, NewStart, NewEnd;
+
+    CalculateClosestEdges(OldEdges, NewEdges, Category, OldStart, OldEnd, NewStart, NewEnd);
+
+    if (OldStart.IsZero() || NewStart.IsZero())
+    {
+        // fallback incase something goes wrong
+        return FRotator::ZeroRotator;
+    }
+
+    // calculate direction vector between platforms
+    FVector Direction = (((NewStart + NewEnd) / 2) - ((OldStart + OldEnd) / 2)).GetSafeNormal();
+
+    return Direction.Rotation();
+
+}
+
+void FGrammarLayoutBuilder::AddWallRunObstacle(const FVector& Vector, const FRotator& Rotator, const float& Distance)
+{
+    float Length = Distance * 0.8f;
+    float Height = SpawnParams.WallRunHeight;
+    float Thickness = 50.0f;
+
+    AddObstacle(ELayoutObstacleType::WallRun, Vector, FVector(Length / 100.0f, Thickness / 100.0f, Height / 100.0f), Rotator);
+}
+
+float FGrammarLayoutBuilder::CalculateWallRunDistance(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category) const
+{
+    FVector OldStart, OldEnd, NewStart, NewEnd;
+
+    CalculateClosestEdges(OldEdges, NewEdges, Category, OldStart, OldEnd, NewStart, NewEnd);
+
+    if (OldStart.IsZero() || NewStart.IsZero())
+    {
+        // fallback incase something goes wrong
+        return 0;
+    }
+
+    return FVector::Dist(OldStart, NewStart);
+}
+
+void FGrammarLayoutBuilder::AddMantleObstacle(const FVector& Vector, const FRotator& Rotator)
+{
+    AddObstacle(ELayoutObstacleType::Mantle, Vector, FVector(.25, 20, 2.5f), Rotator);
+}
+
+void FGrammarLayoutBuilder::AddMantleWalls(const FPlatformEdges& PlatformEdges)
+{
+    FVector MinBounds = PlatformEdges.BottomLeftCoord;
+    FVector MaxBounds = PlatformEdges.TopRightCoord;
+
+    // Calculate center of platform at its lowest Z (ground level)
+    FVector PlatformStart = FVector(
+        (MinBounds.X + MaxBounds.X) * 0.5f,
+        (MinBounds.Y + MaxBounds.Y) * 0.5f,
+        MinBounds.Z
+    );
+
+    // Determine platform size
+    FVector PlatformSize = (MaxBounds - MinBounds).GetAbs();
+    float PlatformWidth = PlatformSize.Y;
+    float PlatformDepth = PlatformSize.X;
+
+    FVector WallLocation = PlatformStart;
+
+    bool bSpawnAlongX = PlatformDepth > PlatformWidth;
+    FVector WallDirection = bSpawnAlongX ? FVector(1, 0, 0) : FVector(0, 1, 0);
+
+    FRotator WallRotation = FRotationMatrix::MakeFromXZ(WallDirection, FVector::UpVector).Rotator();
+
+    float Distance = bSpawnAlongX ? PlatformWidth : PlatformDepth;
+
+    WallLocation += bSpawnAlongX ? FVector(ObstacleRandom.FRandRange(-PlatformDepth * 0.4, PlatformDepth * 0.4), 0, 0) : FVector(0, ObstacleRandom.FRandRange(-PlatformWidth * 0.4, PlatformWidth * 0.4), 0);
+
+    AddObstacle(ELayoutObstacleType::MantleWall, WallLocation, FVector(.25, Distance / 100.f, 2.5), WallRotation);
+}
+
+void FGrammarLayoutBuilder::AddVaultObstacle(const FVector& Vector, const FRotator& Rotator, const float& Distance)
+{
+    float Length = Distance * 0.9f;
+    AddObstacle(ELayoutObstacleType::Vault, Vector, FVector(ObstacleRandom.FRandRange(0.15, 1.0), Length / 100, 1), Rotator);
+}
+
+void FGrammarLayoutBuilder::AddVaultObstacles(const FPlatformEdges& PlatformEdges)
+{
+    FPlatformCalculations Properties = CalculatePlatformProperties(PlatformEdges);
+
+    FVector VaultStart = Properties.bSpawnAlongX ?
+        FVector(
+            (Properties.MinBounds.X - Properties.PlatformDepth),
+            (Properties.MinBounds.Y + Properties.MaxBounds.Y) / 2,
+            Properties.MinBounds.Z
+            ) :
+    FVector(
+        (Properties.MinBounds.X + Properties.MaxBounds.X) / 2,
+        (Properties.MaxBounds.Y - Properties.PlatformWidth),
+        Properties.MinBounds.Z
+        );
+
+    FVector VaultDirection = Properties.bSpawnAlongX ? FVector(1, 0, 0) : FVector(0, 1, 0);
+
+    VaultStart += Properties.bSpawnAlongX ? FVector(ObstacleRandom.FRandRange(100.f, (Properties.PlatformWidth / 3)), 0, 0)
+        : FVector(0, ObstacleRandom.FRandRange(100.f, Properties.PlatformDepth / 3), 0);
+
+    float Spacing = ObstacleRandom.FRandRange(550.f, 700.f);
+
+    float Distance = Properties.bSpawnAlongX ? Properties.PlatformWidth : Properties.PlatformDepth;
+
+    int NumVaults = std::min(static_cast<int>(Distance / Spacing), 7);
+
+    // figure out a way to spawn vaults depending on how big the platform space is.
+    for (int i = 0; i < NumVaults; i++)
+    {
+
+        FVector Offset = VaultDirection * (i * Spacing);
+        FVector VaultLocation = VaultStart + Offset;
+        VaultLocation.Z = Properties.MinBounds.Z;
+
+        // Ensure correct obstacle rotation
+        FRotator VaultRotation = FRotationMatrix::MakeFromXZ(VaultDirection, FVector::UpVector).Rotator();
+
+        AddVaultObstacle(VaultLocation, VaultRotation, Distance);
+        }
+}
+
+void FGrammarLayoutBuilder::AddMantleStaircase(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category, int32 StepCount)
+{
+    if (StepCount <= 1)
+    {
+        return;
+    }
+
+    FVector OldStart, OldEnd, NewStart, NewEnd;
+
+    CalculateClosestEdges(OldEdges, NewEdges, Category, OldStart, OldEnd, NewStart, NewEnd);
+
+    if (OldStart.IsZero() || NewStart.IsZero())
+    {
+        return;
+    }
+
+    // Get midpoint of the new platform's edge
+    FVector NewMid = (NewStart + NewEnd) * 0.5f;
+
+    AddObstacle(ELayoutObstacleType::MantleWall, NewMid, FVector(5, 6, 2.5), FRotator::ZeroRotator);
+}
+
+int32 FGrammarLayoutBuilder::HandleMantleSpawns(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges) const
+{
+    // Calculate how many mantle steps to spawn
+    float HeightDifference = abs(NewEdges.Centre.Z - OldEdges.Centre.Z);
+
+    // Convert difference to steps, clamped to a safe range
+    int32 StepCount = FMath::Clamp(
+        FMath::CeilToInt(HeightDifference / SpawnParams.GridUnit),
+        1,
+        10
+    );
+
+    return StepCount;
+}
+
+void FGrammarLayoutBuilder::AddObstaclesForCategory(EPlatformPlacementCategory Category,const FPlatformEdges& OldEdges,const FPlatformEdges& NewEdges)
+{
+    switch (Category)
+    {
+        case EPlatformPlacementCategory::LongJumpForward:
+        case EPlatformPlacementCategory::LongJumpBack:
+        case EPlatformPlacementCategory::LongJumpLeft:
+        case EPlatformPlacementCategory::LongJumpRight:
+            {
+                FVector ObstacleLocation = CalculateWallRunLocation(OldEdges, NewEdges, Category);
+                FRotator ObstacleRotation = CalculateWallRunRotation(OldEdges, NewEdges, Category);
+
+                float Distance = CalculateWallRunDistance(OldEdges, NewEdges, Category);
+
+                AddWallRunObstacle(ObstacleLocation, ObstacleRotation, Distance);
+
+
+                AddMantleWalls(NewEdges);
+                break;
+            }
+        case EPlatformPlacementCategory::BelowForward:
+        case EPlatformPlacementCategory::BelowLeft:
+        case EPlatformPlacementCategory::BelowRight:
+        case EPlatformPlacementCategory::VeryLowPoint:
+            {
+                int32 StepCount = HandleMantleSpawns(OldEdges, NewEdges);
+
+                AddMantleStaircase(OldEdges, NewEdges,Category, StepCount);
+
+                AddVaultObstacles(NewEdges);
+
+                break;
+            }
+        default:
+            {
+                AddVaultObstacles(NewEdges);
+                AddMantleWalls(NewEdges);
+                break;
+            }
+    }
+}
+
+EPlacementDirection FGrammarLayoutBuilder::ConvertToPlacementDirection(EPlatformPlacementCategory Category)
+{
+    switch (Category)
+    {
+    case EPlatformPlacementCategory::HorizontalForward:
+    case EPlatformPlacementCategory::SmallJumpForward:
+    case EPlatformPlacementCategory::LongJumpForward:
+    case EPlatformPlacementCategory::AboveForward:
+    case EPlatformPlacementCategory::BelowForward:
+        return EPlacementDirection::Forward;
+    case EPlatformPlacementCategory::HorizontalLeft:
+    case EPlatformPlacementCategory::SmallJumpLeft:
+    case EPlatformPlacementCategory::LongJumpLeft:
+    case EPlatformPlacementCategory::AboveLeft:
+    case EPlatformPlacementCategory::BelowLeft:
+        return EPlacementDirection::Left;
+    case EPlatformPlacementCategory::HorizontalRight:
+    case EPlatformPlacementCategory::SmallJumpRight:
+    case EPlatformPlacementCategory::LongJumpRight:
+    case EPlatformPlacementCategory::AboveRight:
+    case EPlatformPlacementCategory::BelowRight:
+        return EPlacementDirection::Right;
+    default:
+        return EPlacementDirection::Forward; // Default to Forward if invalid
+    }
+}
+
+FVector FGrammarLayoutBuilder::CalculateOffsetForDirection(EPlacementDirection Direction, const FVector& CurrentScale, const FVector& NewScale) const
+{
+    // Calculate half-extents
+    FVector CurrentHalfExtents = CurrentScale * SpawnParams.GridUnit;
+    FVector NewHalfExtents = NewScale * SpawnParams.GridUnit;
+    FVector Offset = FVector::ZeroVector;
+
+    switch (Direction)
+    {
+    case EPlacementDirection::Forward:
+        Offset.X = CurrentHalfExtents.X + NewHalfExtents.X;
+        break;
+    case EPlacementDirection::Backward:
+        Offset.X = -(CurrentHalfExtents.X + NewHalfExtents.X);
+        break;
+    case EPlacementDirection::Left:
+        Offset.Y = CurrentHalfExtents.Y + NewHalfExtents.Y;
+        break;
+    case EPlacementDirection::Right:
+        Offset.Y = -(CurrentHalfExtents.Y + NewHalfExtents.Y);
+        break;
+    }
+    return Offset;
+}
+
+FRotator FGrammarLayoutBuilder::CalculateRotationForDirection(EPlacementDirection Direction) const
+{
+    switch (Direction)
+    {
+    case EPlacementDirection::Forward:
+        return FRotator(180.f, 0.f, 0.f);
+    case EPlacementDirection::Backward:
+        return FRotator(180.f, 180.f, 0.f);
+    case EPlacementDirection::Left:
+        return FRotator(180.f, -90.f, 0.f);
+    case EPlacementDirection::Right:
+        return FRotator(180.f, 90.f, 0.f);
+    default:
+        return FRotator::ZeroRotator;
+    }
+}
+
+FVector FGrammarLayoutBuilder::CalculateOffsetForCategory(EPlatformPlacementCategory Category)
+{
+    // Pre-calculate the Z offsets for Above and Below cases.
+    const float AboveZ = ChainRandom.RandRange(SpawnParams.AboveHeightMin, SpawnParams.AboveHeightMax);
+    const float BelowZ = ChainRandom.RandRange(SpawnParams.BelowHeightMax, SpawnParams.BelowHeightMin);
+
+    switch (Category)
+    {
+        // SMALL JUMPS
+        case EPlatformPlacementCategory::SmallJumpForward:
+            return FVector(ChainRandom.RandRange(SpawnParams.SmallJumpMinimum, SpawnParams.SmallJumpMaximum),
+                           0.f,
+                           ChainRandom.RandRange(-SpawnParams.SmallJumpHeight, SpawnParams.SmallJumpHeight));
+
+        case EPlatformPlacementCategory::SmallJumpLeft:
+            return FVector(0.f,
+                           ChainRandom.RandRange(SpawnParams.SmallJumpMinimum, SpawnParams.SmallJumpMaximum),
+                           ChainRandom.RandRange(-SpawnParams.SmallJumpHeight, SpawnParams.SmallJumpHeight));
+
+        case EPlatformPlacementCategory::SmallJumpRight:
+            return FVector(0.f,
+                           -ChainRandom.RandRange(SpawnParams.SmallJumpMinimum, SpawnParams.SmallJumpMaximum),
+                           ChainRandom.RandRange(-SpawnParams.SmallJumpHeight, SpawnParams.SmallJumpHeight));
+
+        // LONG JUMPS
+        case EPlatformPlacementCategory::LongJumpForward:
+            return FVector(ChainRandom.RandRange(SpawnParams.LongJumpMinimum, SpawnParams.LongJumpMaximum),
+                           0.f,
+                           ChainRandom.RandRange(-SpawnParams.LongJumpHeight, SpawnParams.LongJumpHeight));
+
+        case EPlatformPlacementCategory::LongJumpLeft:
+            return FVector(0.f,
+                           ChainRandom.RandRange(SpawnParams.LongJumpMinimum, SpawnParams.LongJumpMaximum),
+                           ChainRandom.RandRange(-SpawnParams.LongJumpHeight, SpawnParams.LongJumpHeight));
+
+        case EPlatformPlacementCategory::LongJumpRight:
+            return FVector(0.f,
+                           -ChainRandom.RandRange(SpawnParams.LongJumpMinimum, SpawnParams.LongJumpMaximum),
+                           ChainRandom.RandRange(-SpawnParams.LongJumpHeight, SpawnParams.LongJumpHeight));
+
+        // ABOVE placements
+        case EPlatformPlacementCategory::AboveForward:
+        case EPlatformPlacementCategory::AboveBack:
+        case EPlatformPlacementCategory::AboveLeft:
+        case EPlatformPlacementCategory::AboveRight:
+            return FVector(0.f, 0.f, AboveZ);
+
+        // BELOW placements
+        case EPlatformPlacementCategory::BelowForward:
+        case EPlatformPlacementCategory::BelowBack:
+        case EPlatformPlacementCategory::BelowLeft:
+        case EPlatformPlacementCategory::BelowRight:
+            return FVector(0.f, 0.f, BelowZ);
+
+        // High up / down points
+        case EPlatformPlacementCategory::VeryHighPoint:
+            return FVector(0.f, 0.f, AboveZ * 2.5f);
+
+        case EPlatformPlacementCategory::VeryLowPoint:
+            return FVector(0.f, 0.f, BelowZ * 2.5f);
+
+        default:
+            return FVector::ZeroVector;
+    }
+}
+
+void FGrammarLayoutBuilder::AddPlatform(const FVector& Location, const FVector& Scale, const FRotator& Rotation, EPlatformPlacementCategory Category)
+{
+    const int32 PlatformIndex = Layout->Platforms.Num();
+    // Index along the whole chain, which differs from PlatformIndex once an endless chain drops old platforms
+    const int32 ChainIndex = NumPlaced++;
+
+    FLayoutPlatform& Platform = Layout->Platforms.AddZeroed_GetRef();
+    Platform.Location = FVector3f(Location);
+    Platform.Scale = FVector3f(Scale);
+    Platform.Rotation = FRotator3f(Rotation);
+
+    // Each platform gets fresh streams, so how long one placement took doesn't leak into the next
+    ChainRandom = FProcGenRandom(CurrentSeed, EProcGenStage::GrammarChain, ChainIndex + 1);
+    ObstacleRandom = FProcGenRandom(CurrentSeed, EProcGenStage::Obstacles, ChainIndex);
+
+    Platform.MeshIndex = SpawnParams.PlatformMesh.IsEmpty() ? INDEX_NONE : ObstacleRandom.RandRange(0, SpawnParams.PlatformMesh.Num() - 1);
+    Platform.Category = static_cast<uint8>(Category);
+
+    if (ChainIndex == 0)
+    {
+        // first platform gets the start material
+        Platform.Flags = ELayoutPlatformFlags::Start;
+    }
+    else
+    {
+        if (!bEndless && ChainIndex + 1 == SpawnParams.NumPlatforms)
+        {
+            Platform.Flags = ELayoutPlatformFlags::Finish;
+        }
+
+        // The chain only ever links to the platform before, so every candidate is taken
+        Report.AddConnectionCandidate(true);
+
+        FLayoutConnection& Connection = Layout->Connections.AddZeroed_GetRef();
+        Connection.From = PlatformIndex - 1;
+        Connection.To = PlatformIndex;
+        Connection.Category = static_cast<uint8>(Category);
+    }
+}
+
+void FGrammarLayoutBuilder::AddObstacle(ELayoutObstacleType Type, const FVector& Location, const FVector& Scale, const FRotator& Rotation, int32 MeshIndex)
+{
+    FLayoutObstacle& Obstacle = Layout->Obstacles.AddZeroed_GetRef();
+    Obstacle.Location = FVector3f(Location);
+    Obstacle.Scale = FVector3f(Scale);
+    Obstacle.Rotation = FRotator3f(Rotation);
+    Obstacle.MeshIndex = MeshIndex;
+    Obstacle.PlatformIndex = Layout->Platforms.Num() - 1;
+    Obstacle.Type = Type;
+
+    Report.AddObstacle(Type);
+}
+
+FVector FGrammarLayoutBuilder::SnapToGrid(const FVector& Location) const
+{
+    return FVector(
+        FMath::RoundToInt(Location.X / SpawnParams.GridUnit) * SpawnParams.GridUnit,
+        FMath::RoundToInt(Location.Y / SpawnParams.GridUnit) * SpawnParams.GridUnit,
+        Location.Z
+    );
+}
+
+FPlatformEdges FGrammarLayoutBuilder::CalculatePlatformEdges(const FVector& Location, const FVector& Scale, const FRotator& Rotation) const
+{
+    FVector HalfExtents = Scale * SpawnParams.GridUnit;
+
+    FVector LocalTopLeftFront  = FVector(HalfExtents.X, -HalfExtents.Y, 0.f);
+    FVector LocalTopRightFront = FVector(HalfExtents.X, HalfExtents.Y, 0.f);
+    FVector LocalTopLeftBack   = FVector(-HalfExtents.X, -HalfExtents.Y, 0.f);
+    FVector LocalTopRightBack  = FVector(-HalfExtents.X, HalfExtents.Y, 0.f);
+
+    FVector TopLeftFront  = Location + Rotation.RotateVector(LocalTopLeftFront);
+    FVector TopRightFront = Location + Rotation.RotateVector(LocalTopRightFront);
+    FVector TopLeftBack   = Location + Rotation.RotateVector(LocalTopLeftBack);
+    FVector TopRightBack  = Location + Rotation.RotateVector(LocalTopRightBack);
+
+    return FPlatformEdges(TopLeftFront, TopRightFront, TopLeftBack, TopRightBack, Location);
+}
+
+bool FGrammarLayoutBuilder::IsLocationValid(const FVector& Location, const FVector& Scale) const
+{
+    // calculate bounding box for the new platform
+    FBox NewBox = CalculatePlatformBoundingBox(Location, Scale);
+
+    // Check against each placed platform
+    for (const FLayoutPlatform& ExistingPlatform : Layout->Platforms)
+    {
+        FBox ExistingBox = CalculatePlatformBoundingBox(FVector(ExistingPlatform.Location), FVector(ExistingPlatform.Scale));
+        ExistingBox = ExistingBox.ExpandBy(-1.0f); // add some tolerance to allow for side by side spawns
+
+        if (NewBox.Intersect(ExistingBox))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+FBox FGrammarLayoutBuilder::CalculatePlatformBoundingBox(const FVector& Location, const FVector& Scale) const
+{
+    FVector BaseHalfExtents(SpawnParams.GridUnit, SpawnParams.GridUnit, SpawnParams.PlatformScale.Z / 2);
+    FVector AdjustedHalfExtents = BaseHalfExtents * Scale;
+
+    FVector Min = Location - AdjustedHalfExtents;
+    FVector Max = Location + AdjustedHalfExtents;
+    return FBox(Min, Max);
+}
+
+const TMap<FString, GrammarRule>& FGrammarLayoutBuilder::GetGrammarRules()
+{
+    static const TMap<FString, GrammarRule> GrammarRules = {
+    { "StartRule", {
+        {
+            // Forward
+            EPlatformPlacementCategory::SmallJumpForward,
+            EPlatformPlacementCategory::HorizontalForward,
+            EPlatformPlacementCategory::AboveForward,
+            EPlatformPlacementCategory::BelowForward,
+
+            EPlatformPlacementCategory::SmallJumpLeft,
+            EPlatformPlacementCategory::HorizontalLeft,
+            EPlatformPlacementCategory::AboveLeft,
+            EPlatformPlacementCategory::BelowLeft,
+
+            EPlatformPlacementCategory::SmallJumpRight,
+            EPlatformPlacementCategory::HorizontalRight,
+            EPlatformPlacementCategory::AboveRight,
+            EPlatformPlacementCategory::BelowRight,
+            EPlatformPlacementCategory::VeryHighPoint
+        } } },
+    { "BesideRule", {
+        {
+            // Forward
+            EPlatformPlacementCategory::HorizontalForward,
+            // Left
+            EPlatformPlacementCategory::HorizontalLeft,
+            // Right
+            EPlatformPlacementCategory::HorizontalRight
+        } } },
+    { "AboveRule", { {
+        // Forward
+        EPlatformPlacementCategory::AboveForward,
+        EPlatformPlacementCategory::SmallJumpForward,
+        // Left
+        EPlatformPlacementCategory::AboveLeft,
+        EPlatformPlacementCategory::SmallJumpLeft,
+        // Right
+        EPlatformPlacementCategory::AboveRight,
+        EPlatformPlacementCategory::SmallJumpRight
+    } } },
+    { "BelowRule", { {
+        // Forward
+        EPlatformPlacementCategory::BelowForward,
+        // Left
+        EPlatformPlacementCategory::BelowLeft,
+        // Right
+        EPlatformPlacementCategory::BelowRight,
+    } } },
+    { "FarRule", { {
+        EPlatformPlacementCategory::LongJumpForward,
+        EPlatformPlacementCategory::LongJumpLeft,
+        EPlatformPlacementCategory::LongJumpRight,
+    } } },
+    { "SmallJumpRule", { {
+        EPlatformPlacementCategory::SmallJumpForward,
+        EPlatformPlacementCategory::SmallJumpLeft,
+        EPlatformPlacementCategory::SmallJumpRight,
+    } } },
+    { "VeryHighRule", {
+        {
+            EPlatformPlacementCategory::VeryHighPoint
+        } } },
+    { "VeryLowRule", {
+        {
+            EPlatformPlacementCategory::VeryLowPoint
+        } } }
+    };
+
+    return GrammarRules;
+}
@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GrammarGenerator.h"
+#include "JumpReachability.h"
+#include "LevelLayout.h"
+#include "ProcGenRandom.h"
+#include "ProcGenStats.h"
+
+/**
+ * Data-only half of the grammar generator. Runs the grammar rules and writes platforms, obstacles and
+ * buildings into an FLevelLayout without touching a world, so layouts can be built, stored in a level
+ * pack and realised later by AGrammarGenerator.
+ */
+class PROCEDURALGENERATION_API FGrammarLayoutBuilder
+{
+public:
+    // The jump envelope comes from MakeJumpEnvelope, so a builder never reads the character defaults itself and
+    // can run on any thread
+    FGrammarLayoutBuilder(const FGrammarRules& InSpawnParams, const FDecorateLevelRules& InDecorateRules, FJumpEnvelope InJumpEnvelope);
+
+    // Builds the full level for the given seed. Positions are relative to the generator.
+    void Build(int32 Seed, uint64 ParameterHash, FLevelLayout& OutLayout);
+
+    // Endless mode. BeginChain places only the first platform, ExtendChain then grows the chain a few platforms
+    // at a time and DropOldestPlatforms forgets the ones behind the player, so the layout stays a fixed size window.
+    // The layout must outlive the chain.
+    void BeginChain(int32 Seed, uint64 ParameterHash, FLevelLayout& OutLayout, bool bInEndless = true);
+
+    // Appends up to Count platforms and their obstacles, returns how many were placed
+    int32 ExtendChain(int32 Count);
+
+    // Removes the oldest platforms with their obstacles and connections, later indices shift down by Count
+    void DropOldestPlatforms(int32 Count);
+
+    // Hash of every parameter that changes the generated layout, used as the level pack key
+    static uint64 GetParameterHash(const FGrammarRules& SpawnParams, const FDecorateLevelRules& DecorateRules, const FJumpEnvelope& JumpEnvelope);
+
+    // Reads the reachability character's defaults, game thread only. Invalid when validation is off.
+    static FJumpEnvelope MakeJumpEnvelope(const FGrammarRules& SpawnParams);
+
+    // Counts and phase times of the last Build or endless chain
+    const FProcGenReport& GetReport() const { return Report; }
+
+    static EPlacementDirection GetOppositeDirection(EPlacementDirection Dir);
+
+    static FPlatformCalculations CalculatePlatformProperties(const FPlatformEdges& PlatformEdges);
+
+protected:
+    struct FPlacementCandidate
+    {
+        EPlatformPlacementCategory Category;
+        EPlacementDirection Direction;
+        FVector Location;
+        FVector Scale;
+        FRotator Rotation;
+    };
+
+    /** Adds the first platform and then, using grammar rules, places subsequent platforms. */
+    void GeneratePlatformChain();
+    void PopulateWorld();
+
+    // Functions for adding decorations
+    void AddBuilding(const FVector& Location);
+
+    // Chooses the next grammar rule depending on available options
+    FString PickNextRule(EPlatformPlacementCategory Category);
+
+    // Adds platforms one after another according to the grammar, starting from the given rule
+    void ExpandRule(const FString& StartRule, int32 RemainingPlatforms);
+
+    // Picks a category, scale and position for the next platform off the last one
+    FPlacementCandidate MakeCandidate(const GrammarRule& SelectedRule);
+
+    // Bit N is set if the player can get from the last platform to candidate N
+    uint32 TestReachability(const FPlacementCandidate* Candidates, int32 NumCandidates) const;
+
+    void CalculateClosestEdges(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category, FVector&
+                               OutOldEdgeStart, FVector& OutOldEdgeEnd, FVector& OutNewEdgeStart, FVector& OutNewEdgeEnd) const;
+
+    FVector CalculateWallRunLocation(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category) const;
+
+    FRotator CalculateWallRunRotation(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category) const;
+
+    void AddWallRunObstacle(const FVector& Vector, const FRotator& Rotator, const float& Distance);
+
+    float CalculateWallRunDistance(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category) const;
+
+    void AddMantleObstacle(const FVector& Vector, const FRotator& Rotator);
+
+    void AddMantleWalls(const FPlatformEdges& PlatformEdges);
+
+    void AddVaultObstacle(const FVector& Vector, const FRotator& Rotator, const float& Distance);
+
+    void AddVaultObstacles(const FPlatformEdges& PlatformEdges);
+
+    void AddMantleStaircase(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges, EPlatformPlacementCategory Category, int32 StepCount);
+
+    int32 HandleMantleSpawns(const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges) const;
+
+    void AddObstaclesForCategory(EPlatformPlacementCategory NextCategory, const FPlatformEdges& OldEdges, const FPlatformEdges& NewEdges);
+
+    static EPlacementDirection ConvertToPlacementDirection(EPlatformPlacementCategory Category);
+
+    FVector CalculateOffsetForDirection(EPlacementDirection Direction, const FVector& CurrentScale, const FVector& NewScale) const;
+
+    FRotator CalculateRotationForDirection(EPlacementDirection Direction) const;
+
+    /** Calculate a relative offset (in world units) based on the chosen category. */
+    FVector CalculateOffsetForCategory(EPlatformPlacementCategory Category);
+
+    /** Helper to add a platform at a given location. */
+    void AddPlatform(const FVector& Location, const FVector& Scale, const FRotator& Rotation, EPlatformPlacementCategory Category);
+
+    void AddObstacle(ELayoutObstacleType Type, const FVector& Location, const FVector& Scale, const FRotator& Rotation, int32 MeshIndex = INDEX_NONE);
+
+    FVector SnapToGrid(const FVector& Location) const;
+
+    FPlatformEdges CalculatePlatformEdges(const FVector& Location, const FVector& Scale, const FRotator& Rotation) const;
+
+    // Helper function to check if a new platform intersects with existing platforms.
+    bool IsLocationValid(const FVector& Location, const FVector& Scale) const;
+    FBox CalculatePlatformBoundingBox(const FVector& Location, const FVector& Scale) const;
+
+    static const TMap<FString, GrammarRule>& GetGrammarRules();
+
+private:
+    FGrammarRules SpawnParams;
+    FDecorateLevelRules DecorateRules;
+
+    int32 CurrentSeed = 0;
+
+    // Only valid when the rules name a ReachabilityCharacter
+    FJumpEnvelope JumpEnvelope;
+
+    // Picks the next platform, re-keyed each time a platform is placed so retries keep drawing fresh values
+    FProcGenRandom ChainRandom;
+
+    // Mesh and obstacles of the platform that was just placed
+    FProcGenRandom ObstacleRandom;
+
+    // Layout being written by the current Build call
+    FLevelLayout* Layout = nullptr;
+
+    FProcGenReport Report;
+
+    // Track the last platform's location and scale (starting with the initial platform).
+    FVector LastPlatformLocation;
+    FVector LastPlatformScale;
+    FRotator LastPlatformRotation;
+    EPlacementDirection LastPlacementDirection;
+
+    // Rule the chain continues from on the next expansion
+    FString PendingRule;
+
+    // Platforms placed since BeginChain, including any dropped since
+    int32 NumPlaced = 0;
+
+    // Endless chains never mark a finish platform
+    bool bEndless = false;
+
+    // Invalid placements in a row before the chain is abandoned
+    static constexpr int32 MaxFailedPlacements = 256;
+    int32 FailedPlacements = 0;
+};
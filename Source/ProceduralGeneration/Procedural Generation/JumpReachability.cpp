@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "JumpReachability.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "PhysicsEngine/PhysicsSettings.h"
+
+FJumpEnvelope FJumpEnvelope::FromCharacter(const ACharacter* Character, float Speed, float InLedgeReach)
+{
+	FJumpEnvelope Envelope;
+	const UCharacterMovementComponent* Movement = Character ? Character->GetCharacterMovement() : nullptr;
+	if (!Movement)
+	{
+		return Envelope;
+	}
+
+	// Class defaults have no world, so use the project gravity rather than GetGravityZ
+	Envelope.JumpZVelocity = Movement->JumpZVelocity;
+	Envelope.Gravity = -UPhysicsSettings::Get()->DefaultGravityZ * Movement->GravityScale;
+	Envelope.HorizontalSpeed = Speed > 0.f ? Speed : Movement->MaxWalkSpeed;
+	Envelope.LedgeReach = InLedgeReach;
+	return Envelope;
+}
+
+bool FJumpEnvelope::IsReachable(float Gap, float HeightDelta) const
+{
+	// Highest point of the arc z(t) = Vz * t - g * t^2 / 2 once the gap is covered, which is the apex
+	// if the gap is crossed on the way up
+	const float Time = FMath::Max(FMath::Max(Gap, 0.f) / HorizontalSpeed, JumpZVelocity / Gravity);
+	const float ArcHeight = Time * (JumpZVelocity - 0.5f * Gravity * Time);
+
+	return ArcHeight >= HeightDelta - LedgeReach;
+}
+
+uint32 FJumpEnvelope::TestBatch(const float* Gaps, const float* HeightDeltas) const
+{
+	const VectorRegister4Float Time = VectorMax(VectorMultiply(VectorLoad(Gaps), VectorSetFloat1(1.f / HorizontalSpeed)), VectorSetFloat1(JumpZVelocity / Gravity));
+	const VectorRegister4Float ArcHeight = VectorMultiply(Time, VectorSubtract(VectorSetFloat1(JumpZVelocity), VectorMultiply(VectorSetFloat1(0.5f * Gravity), Time)));
+	const VectorRegister4Float Required = VectorSubtract(VectorLoad(HeightDeltas), VectorSetFloat1(LedgeReach));
+
+	return static_cast<uint32>(VectorMaskBits(VectorCompareGE(ArcHeight, Required)));
+}
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ACharacter;
+
+/**
+ * Ballistic jump envelope of a character, used to reject platform placements the player could never reach.
+ * A jump is treated as a running jump at HorizontalSpeed, the target is reachable if the arc from the point
+ * the gap is covered still gets above its top, minus how high above the feet a ledge can be grabbed.
+ */
+struct PROCEDURALGENERATION_API FJumpEnvelope
+{
+	static constexpr int32 BatchWidth = 4;
+
+	float JumpZVelocity = 0.f;
+	float Gravity = 0.f;
+	float HorizontalSpeed = 0.f;
+	float LedgeReach = 0.f;
+
+	// Reads the jump settings off the character's movement component. Speed overrides MaxWalkSpeed when positive.
+	static FJumpEnvelope FromCharacter(const ACharacter* Character, float Speed, float InLedgeReach);
+
+	bool IsValid() const { return JumpZVelocity > 0.f && Gravity > 0.f && HorizontalSpeed > 0.f; }
+
+	float GetApexHeight() const { return JumpZVelocity * JumpZVelocity / (2.f * Gravity); }
+
+	// Gap is the horizontal edge to edge distance, HeightDelta is target top minus source top
+	bool IsReachable(float Gap, float HeightDelta) const;
+
+	// Tests BatchWidth candidates at once, bit N of the result is set if candidate N is reachable
+	uint32 TestBatch(const float* Gaps, const float* HeightDeltas) const;
+};
@@ -0,0 +1,174 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LedgeGraph.h"
+#include "GeneratedGeometry.h"
+
+// Wider than any ledge query, so one reaches at most a few cells
+static constexpr float LedgeCellSize = 500.0f;
+
+// Ledges turned further than this from the character are walked along rather than into
+static constexpr float MinLedgeFacing = 0.5f;
+
+FIntPoint FLedgeGraph::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / LedgeCellSize), FMath::FloorToInt32(Location.Y / LedgeCellSize));
+}
+
+void FLedgeGraph::AddBox(const FGeneratedBox& Box)
+{
+	RemoveActor(Box.Actor);
+
+	// Find which of the box's axes points up
+	int32 UpAxis = INDEX_NONE;
+	FVector Axes[3];
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		FVector LocalAxis = FVector::ZeroVector;
+		LocalAxis[Axis] = 1.0f;
+		Axes[Axis] = Box.Rotation.RotateVector(LocalAxis);
+
+		if (FMath::Abs(Axes[Axis].Z) > 0.99f)
+		{
+			UpAxis = Axis;
+		}
+	}
+
+	if (UpAxis == INDEX_NONE)
+	{
+		return;
+	}
+
+	const FVector Up = Axes[UpAxis] * FMath::Sign(Axes[UpAxis].Z);
+	const FVector TopCentre = Box.Center + Up * Box.Extent[UpAxis];
+	const float Bottom = Box.Center.Z - Box.Extent[UpAxis];
+
+	TArray<int32, TInlineAllocator<4>>& Added = ActorLedges.FindOrAdd(Box.Actor);
+
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		if (Axis == UpAxis)
+		{
+			continue;
+		}
+
+		const int32 AlongAxis = 3 - UpAxis - Axis;
+		const FVector Along = Axes[AlongAxis] * Box.Extent[AlongAxis];
+
+		for (const float Side : { 1.0f, -1.0f })
+		{
+			FGeneratedLedge Ledge;
+			Ledge.Normal = FVector(Axes[Axis].X, Axes[Axis].Y, 0.0f).GetSafeNormal() * Side;
+			const FVector EdgeCentre = TopCentre + Axes[Axis] * Box.Extent[Axis] * Side;
+			Ledge.Start = EdgeCentre - Along;
+			Ledge.End = EdgeCentre + Along;
+			Ledge.Depth = Box.Extent[Axis] * 2.0f;
+			Ledge.Bottom = Bottom;
+			Ledge.Actor = Box.Actor;
+
+			const int32 Index = Ledges.Add(Ledge);
+			Added.Add(Index);
+
+			// Every cell the edge passes through, sampled finer than a cell so none are skipped
+			const int32 NumSamples = FMath::CeilToInt32(FVector::Dist2D(Ledge.Start, Ledge.End) / (LedgeCellSize * 0.5f)) + 1;
+			for (int32 Sample = 0; Sample <= NumSamples; ++Sample)
+			{
+				const FVector Point = FMath::Lerp(Ledge.Start, Ledge.End, static_cast<float>(Sample) / NumSamples);
+				Cells.FindOrAdd(GetCell(Point)).AddUnique(Index);
+			}
+		}
+	}
+}
+
+void FLedgeGraph::RemoveActor(const AActor* Actor)
+{
+	TArray<int32, TInlineAllocator<4>> Removed;
+	if (!ActorLedges.RemoveAndCopyValue(Actor, Removed))
+	{
+		return;
+	}
+
+	for (const int32 Index : Removed)
+	{
+		const FGeneratedLedge& Ledge = Ledges[Index];
+		const int32 NumSamples = FMath::CeilToInt32(FVector::Dist2D(Ledge.Start, Ledge.End) / (LedgeCellSize * 0.5f)) + 1;
+		for (int32 Sample = 0; Sample <= NumSamples; ++Sample)
+		{
+			const FIntPoint Cell = GetCell(FMath::Lerp(Ledge.Start, Ledge.End, static_cast<float>(Sample) / NumSamples));
+			if (TArray<int32>* CellLedges = Cells.Find(Cell))
+			{
+				CellLedges->RemoveSingleSwap(Index, EAllowShrinking::No);
+				if (CellLedges->IsEmpty())
+				{
+					Cells.Remove(Cell);
+				}
+			}
+		}
+
+		Ledges.RemoveAt(Index);
+	}
+}
+
+bool FLedgeGraph::FindLedge(const FVector& Location, const FVector& Direction, float MaxDistance, float MinHeight, float MaxHeight, float HalfWidth, FGeneratedLedge& OutLedge, FVector& OutPoint) const
+{
+	const FVector Forward = Direction.GetSafeNormal2D();
+	const FVector End = Location + Forward * MaxDistance;
+
+	// A ledge can sit just over a cell border from the line, so search one cell further out
+	const FIntPoint MinCell = GetCell(Location.ComponentMin(End)) - FIntPoint(1, 1);
+	const FIntPoint MaxCell = GetCell(Location.ComponentMax(End)) + FIntPoint(1, 1);
+
+	float BestDistance = MaxDistance;
+	const FGeneratedLedge* BestLedge = nullptr;
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			const TArray<int32>* CellLedges = Cells.Find(FIntPoint(X, Y));
+			if (!CellLedges)
+			{
+				continue;
+			}
+
+			for (const int32 Index : *CellLedges)
+			{
+				const FGeneratedLedge& Ledge = Ledges[Index];
+
+				const float Height = Ledge.GetHeight() - Location.Z;
+				const float Facing = FVector::DotProduct(Forward, Ledge.Normal);
+				if (Height < MinHeight || Height > MaxHeight || Ledge.Bottom > Location.Z + MinHeight || Facing > -MinLedgeFacing)
+				{
+					continue;
+				}
+
+				// Where the line crosses the edge, measured flat
+				const float Distance = FVector::DotProduct(Ledge.Start - Location, Ledge.Normal) / Facing;
+				if (Distance < 0.0f || Distance > BestDistance)
+				{
+					continue;
+				}
+
+				const FVector EdgeDelta = (Ledge.End - Ledge.Start).GetSafeNormal2D();
+				const float EdgeLength = FVector::Dist2D(Ledge.Start, Ledge.End);
+				const float Along = FVector::DotProduct(Location + Forward * Distance - Ledge.Start, EdgeDelta);
+				if (Along < -HalfWidth || Along > EdgeLength + HalfWidth)
+				{
+					continue;
+				}
+
+				BestDistance = Distance;
+				BestLedge = &Ledge;
+				OutPoint = Ledge.Start + EdgeDelta * FMath::Clamp(Along, 0.0f, EdgeLength);
+				OutPoint.Z = Ledge.GetHeight();
+			}
+		}
+	}
+
+	if (!BestLedge)
+	{
+		return false;
+	}
+
+	OutLedge = *BestLedge;
+	return true;
+}
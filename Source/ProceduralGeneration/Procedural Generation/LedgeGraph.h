@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FGeneratedBox;
+
+// Top edge of a generated box, something the character can mantle onto or vault over
+struct PROCEDURALGENERATION_API FGeneratedLedge
+{
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+
+	// Flat, pointing out of the box away from the top it borders
+	FVector Normal = FVector::ZeroVector;
+
+	// Width of the top behind the edge, and how far down the box goes under it
+	float Depth = 0.0f;
+	float Bottom = 0.0f;
+
+	const AActor* Actor = nullptr;
+
+	FORCEINLINE float GetHeight() const { return Start.Z; }
+};
+
+/**
+ * Ledges around the tops of the boxes the generators place, in a flat grid hash so the sensing pass can find
+ * the ledge in front of the character without sweeping the obstacle for its height.
+ */
+class PROCEDURALGENERATION_API FLedgeGraph
+{
+public:
+	// Adds the four top edges of an upright box, tilted boxes have no flat top to stand on
+	void AddBox(const FGeneratedBox& Box);
+	void RemoveActor(const AActor* Actor);
+
+	/**
+	 * Nearest ledge facing back at Location along Direction within MaxDistance. Its top has to sit between
+	 * MinHeight and MaxHeight above Location and the box has to reach down below MinHeight, like the face a
+	 * trace at that height would hit. HalfWidth lets the line pass just off the end of the edge.
+	 */
+	bool FindLedge(const FVector& Location, const FVector& Direction, float MaxDistance, float MinHeight, float MaxHeight, float HalfWidth, FGeneratedLedge& OutLedge, FVector& OutPoint) const;
+
+	FORCEINLINE int32 Num() const { return Ledges.Num(); }
+
+private:
+	FIntPoint GetCell(const FVector& Location) const;
+
+	TSparseArray<FGeneratedLedge> Ledges;
+	TMap<const AActor*, TArray<int32, TInlineAllocator<4>>> ActorLedges;
+	TMap<FIntPoint, TArray<int32>> Cells;
+};
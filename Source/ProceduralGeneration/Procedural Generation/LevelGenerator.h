@@ -7,6 +7,8 @@
 #include "Floor.h"
 #include "Components/ActorComponent.h"
 #include "HelperStructs.h"
+#include "LevelLayout.h"
+#include "ProcGenStats.h"
 #include "LevelGenerator.generated.h"
 
 USTRUCT(BlueprintType)
@@ -174,44 +176,28 @@ public:
 	 *	   Generation Functions
 	 *
 	 */
-	
-	void SpawnGrid();
 
-	FVector CalculatePlatformPosition(const FCornerCoordinates& Coords, float Height, int32 PlatformWidth, int32 PlatformLength) const;
+	// Spawns the actors for a layout, either freshly built or viewed straight out of a level pack
+	void RealiseLayout(const FLevelLayoutView& LevelLayout);
 
-	void AnalyseAndSpawnParkourConnections();
-	EParkourType DetermineParkourType(float Distance, float HeightDiff);
-	void SpawnParkourConnection(const FPlatformData& Start, const FPlatformData& End, EParkourType Type);
+	void SpawnPlatform(const FLayoutPlatform& Platform);
+	void SpawnObstacle(const FLayoutObstacle& Obstacle);
 
-	// Mantle
-	void SpawnMantleIndicator(const FVector& Start, const FVector& End);
-	
-	void SpawnMantlePointsAlongPath(const TArray<FVector>& PathPoints);
-	void GenerateEdgeFollowingPath(const FPlatformEdge& StartEdge, const FPlatformEdge& EndEdge, TArray<FVector>& OutPoints);
-	TArray<FPlatformEdge> GetPlatformEdges(const FPlatformData& Platform);
+	FString GetLevelPackPath() const;
 
-	// Wallrun
-	void SpawnWallRunSurface(const FPlatformData& Start, const FPlatformData& End);
+	FORCEINLINE const FProceduralGenerationParams& GetSpawnParams() const { return SpawnParams; }
 
-	/*
-	 *
-	 *		Helper Functions
-	 *
-	 */
+	// Counts and timings of the last InitialiseGrid
+	FORCEINLINE const FProcGenReport& GetLastReport() const { return Report; }
 
-	// Check if a path between platforms is clear
-	bool IsPathClear(const FPlatformData& Start, const FPlatformData& End) const;
+	// Estimated memory held by the current level, per platform and obstacle
+	FORCEINLINE const FProcGenMemorySummary& GetMemorySummary() const { return Report.Memory; }
 
-	// Get the closest points between two platforms
-	void GetClosestPlatformPoints(const FPlatformData& Start, const FPlatformData& End, 
-								FVector& OutStartPoint, FVector& OutEndPoint) const;
-
-	// Calculate edge-to-edge distance between platforms
-	float GetPlatformEdgeDistance(const FPlatformData& Start, const FPlatformData& End) const;
-	
 private:
 
-	TSharedPtr<Floor> Level;
+	// Layout built by the last InitialiseGrid call, empty when the level came from the pack
+	FLevelLayout Layout;
+	FProcGenReport Report;
 	UPROPERTY() TArray<AActor*> SpawnedActors;
 
 	TMap<int32, TArray<AActor*>> PartitionedFloorActors;
@@ -219,6 +205,17 @@ private:
 protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level Generator") FProceduralGenerationParams SpawnParams;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level Generator") FProceduralGenerationMeshes SpawnMeshes;
-	UPROPERTY() TArray<FPlatformData> PlacedPlatforms;
+
+	// Seed used for the generated layout, rolled on every generation when bRandomSeed is set
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level Generator") int32 Seed = 0;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level Generator") bool bRandomSeed = true;
+
+	// Look the seed up in the level pack before running the generator
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level Pack") bool bUseLevelPack = true;
+	// Relative to the project content directory
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Level Pack") FString LevelPackFile = TEXT("LevelPacks/BSP.lpk");
+
+	// Writes the counts and phase timings of every generation to Saved/ProcGen as JSON
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debug") bool bWriteGenerationReport = false;
 	
 };
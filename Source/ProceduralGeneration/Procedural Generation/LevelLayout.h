@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Plain records describing a generated level. Every record is trivially copyable and uses
+// fixed size types so a layout can be written to a level pack as-is and read straight back
+// out of the mapped file without any parsing. All positions are relative to the generator.
+
+enum class ELayoutObstacleType : uint8
+{
+    WallRun,
+    Mantle,
+    MantleWall,
+    Vault,
+    Building
+};
+
+namespace ELayoutPlatformFlags
+{
+    enum Type : uint8
+    {
+        None   = 0,
+        Start  = 1 << 0,
+        Finish = 1 << 1
+    };
+}
+
+struct FLayoutPlatform
+{
+    FVector3f Location;
+    FVector3f Scale;
+    FRotator3f Rotation;
+    // Index into FGrammarRules::PlatformMesh, INDEX_NONE if no mesh was available
+    int32 MeshIndex;
+    // EPlatformPlacementCategory that placed this platform
+    uint8 Category;
+    uint8 Flags;
+    uint8 Pad[2];
+};
+
+struct FLayoutObstacle
+{
+    FVector3f Location;
+    FVector3f Scale;
+    FRotator3f Rotation;
+    // Only used by buildings, obstacles take their mesh from the type
+    int32 MeshIndex;
+    // Platform the obstacle was generated for
+    int32 PlatformIndex;
+    ELayoutObstacleType Type;
+    uint8 Pad[3];
+};
+
+// Edge between two platforms in the order the grammar placed them
+struct FLayoutConnection
+{
+    int32 From;
+    int32 To;
+    uint8 Category;
+    uint8 Pad[3];
+};
+
+static_assert(sizeof(FLayoutPlatform) == 44, "FLayoutPlatform is stored in level packs, bump LevelPackVersion when changing it");
+static_assert(sizeof(FLayoutObstacle) == 48, "FLayoutObstacle is stored in level packs, bump LevelPackVersion when changing it");
+static_assert(sizeof(FLayoutConnection) == 12, "FLayoutConnection is stored in level packs, bump LevelPackVersion when changing it");
+
+/**
+ * Non-owning view of a layout, either over an FLevelLayout or directly over a mapped level pack.
+ */
+struct FLevelLayoutView
+{
+    TConstArrayView<FLayoutPlatform> Platforms;
+    TConstArrayView<FLayoutObstacle> Obstacles;
+    TConstArrayView<FLayoutConnection> Connections;
+    TConstArrayView<FLayoutObstacle> Buildings;
+
+    bool IsEmpty() const { return Platforms.IsEmpty(); }
+
+    SIZE_T GetNumBytes() const
+    {
+        return Platforms.NumBytes() + Obstacles.NumBytes() + Connections.NumBytes() + Buildings.NumBytes();
+    }
+};
+
+/**
+ * Owning layout produced by the data-only generators.
+ */
+struct FLevelLayout
+{
+    TArray<FLayoutPlatform> Platforms;
+    TArray<FLayoutObstacle> Obstacles;
+    TArray<FLayoutConnection> Connections;
+    TArray<FLayoutObstacle> Buildings;
+
+    void Reset()
+    {
+        Platforms.Reset();
+        Obstacles.Reset();
+        Connections.Reset();
+        Buildings.Reset();
+    }
+
+    SIZE_T GetAllocatedSize() const
+    {
+        return Platforms.GetAllocatedSize() + Obstacles.GetAllocatedSize() + Connections.GetAllocatedSize() + Buildings.GetAllocatedSize();
+    }
+
+    FLevelLayoutView GetView() const
+    {
+        FLevelLayoutView View;
+        View.Platforms = Platforms;
+        View.Obstacles = Obstacles;
+        View.Connections = Connections;
+        View.Buildings = Buildings;
+        return View;
+    }
+};
@@ -0,0 +1,317 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LevelPack.h"
+#include "ProcGenStats.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/StableSort.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+namespace LevelPack
+{
+    static bool EntryLess(const FLevelPackEntry& A, const FLevelPackEntry& B)
+    {
+        return A.ParameterHash != B.ParameterHash ? A.ParameterHash < B.ParameterHash : A.Seed < B.Seed;
+    }
+
+    static int64 GetLayoutSize(const FLevelPackEntry& Entry)
+    {
+        return int64(Entry.NumPlatforms) * sizeof(FLayoutPlatform)
+            + int64(Entry.NumObstacles) * sizeof(FLayoutObstacle)
+            + int64(Entry.NumConnections) * sizeof(FLayoutConnection)
+            + int64(Entry.NumBuildings) * sizeof(FLayoutObstacle);
+    }
+
+    // Keeps every blob and the index 8 byte aligned so records can be read in place
+    static void PadTo8(FArchive& Ar)
+    {
+        static uint8 Zeros[8] = {};
+        const int64 Remainder = Ar.Tell() % 8;
+        if (Remainder != 0)
+        {
+            Ar.Serialize(Zeros, 8 - Remainder);
+        }
+    }
+
+    template <typename T>
+    static void WriteRecords(FArchive& Ar, TConstArrayView<T> Records)
+    {
+        if (!Records.IsEmpty())
+        {
+            Ar.Serialize(const_cast<T*>(Records.GetData()), Records.NumBytes());
+        }
+    }
+
+    template <typename T>
+    static TConstArrayView<T> ReadRecords(const uint8*& Cursor, uint32 Num)
+    {
+        TConstArrayView<T> Records(reinterpret_cast<const T*>(Cursor), Num);
+        Cursor += int64(Num) * sizeof(T);
+        return Records;
+    }
+}
+
+FLevelPack::FLevelPack() = default;
+
+FLevelPack::~FLevelPack()
+{
+    Close();
+}
+
+bool FLevelPack::Open(const FString& Filename)
+{
+    Close();
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (!PlatformFile.FileExists(*Filename))
+    {
+        return false;
+    }
+
+    FOpenMappedResult Result = PlatformFile.OpenMappedEx(*Filename);
+    if (Result.HasValue())
+    {
+        MappedFile = Result.StealValue();
+        MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize(), true));
+    }
+
+    if (MappedRegion)
+    {
+        Data = MappedRegion->GetMappedPtr();
+        DataSize = MappedRegion->GetMappedSize();
+    }
+    else
+    {
+        // Not every platform can map files (or files inside a pak), fall back to reading it in once
+        MappedFile.Reset();
+        if (!FFileHelper::LoadFileToArray(FallbackData, *Filename, FILEREAD_Silent))
+        {
+            return false;
+        }
+        Data = FallbackData.GetData();
+        DataSize = FallbackData.Num();
+    }
+
+    if (!ValidateMapping())
+    {
+        UE_LOG(LogProcGen, Warning, TEXT("Level pack %s is invalid or out of date"), *Filename);
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void FLevelPack::Close()
+{
+    Header = nullptr;
+    Entries = TConstArrayView<FLevelPackEntry>();
+    Data = nullptr;
+    DataSize = 0;
+
+    // The region has to go before the handle it was mapped from
+    MappedRegion.Reset();
+    MappedFile.Reset();
+    FallbackData.Empty();
+}
+
+bool FLevelPack::ValidateMapping()
+{
+    if (DataSize < int64(sizeof(FLevelPackHeader)))
+    {
+        return false;
+    }
+
+    const FLevelPackHeader* PackHeader = reinterpret_cast<const FLevelPackHeader*>(Data);
+    if (PackHeader->Magic != LevelPackMagic || PackHeader->Version != LevelPackVersion)
+    {
+        return false;
+    }
+
+    const int64 IndexSize = int64(PackHeader->NumEntries) * sizeof(FLevelPackEntry);
+    if (PackHeader->IndexOffset % alignof(FLevelPackEntry) != 0 || int64(PackHeader->IndexOffset) + IndexSize > DataSize)
+    {
+        return false;
+    }
+
+    const TConstArrayView<FLevelPackEntry> PackEntries(reinterpret_cast<const FLevelPackEntry*>(Data + PackHeader->IndexOffset), PackHeader->NumEntries);
+    for (const FLevelPackEntry& Entry : PackEntries)
+    {
+        if (Entry.DataOffset % 4 != 0 || int64(Entry.DataOffset) + LevelPack::GetLayoutSize(Entry) > int64(PackHeader->IndexOffset))
+        {
+            return false;
+        }
+    }
+
+    Header = PackHeader;
+    Entries = PackEntries;
+    return true;
+}
+
+bool FLevelPack::FindLayout(uint64 ParameterHash, int32 Seed, FLevelLayoutView& OutLayout) const
+{
+    if (!IsOpen())
+    {
+        return false;
+    }
+
+    FLevelPackEntry Key = {};
+    Key.ParameterHash = ParameterHash;
+    Key.Seed = Seed;
+
+    const int32 Index = Algo::LowerBound(Entries, Key, &LevelPack::EntryLess);
+    if (!Entries.IsValidIndex(Index) || Entries[Index].ParameterHash != ParameterHash || Entries[Index].Seed != Seed)
+    {
+        return false;
+    }
+
+    return GetLayout(Entries[Index], OutLayout);
+}
+
+bool FLevelPack::GetLayout(const FLevelPackEntry& Entry, FLevelLayoutView& OutLayout) const
+{
+    if (!IsOpen())
+    {
+        return false;
+    }
+
+    const uint8* Cursor = Data + Entry.DataOffset;
+    OutLayout.Platforms = LevelPack::ReadRecords<FLayoutPlatform>(Cursor, Entry.NumPlatforms);
+    OutLayout.Obstacles = LevelPack::ReadRecords<FLayoutObstacle>(Cursor, Entry.NumObstacles);
+    OutLayout.Connections = LevelPack::ReadRecords<FLayoutConnection>(Cursor, Entry.NumConnections);
+    OutLayout.Buildings = LevelPack::ReadRecords<FLayoutObstacle>(Cursor, Entry.NumBuildings);
+    return true;
+}
+
+FLevelPackWriter::~FLevelPackWriter()
+{
+    // Abandoned without Close, don't leave a half written pack around
+    if (Writer)
+    {
+        Writer.Reset();
+        IFileManager::Get().Delete(*TempFilename);
+    }
+}
+
+bool FLevelPackWriter::Open(const FString& InFilename)
+{
+    Filename = InFilename;
+    TempFilename = Filename + TEXT(".tmp");
+    Entries.Reset();
+
+    Writer.Reset(IFileManager::Get().CreateFileWriter(*TempFilename));
+    if (!Writer)
+    {
+        UE_LOG(LogProcGen, Warning, TEXT("Failed to create level pack %s"), *TempFilename);
+        return false;
+    }
+
+    // Placeholder, the real header is written once the index offset is known
+    FLevelPackHeader PackHeader = {};
+    Writer->Serialize(&PackHeader, sizeof(PackHeader));
+    return true;
+}
+
+bool FLevelPackWriter::Add(uint64 ParameterHash, int32 Seed, const FLevelLayoutView& Layout)
+{
+    if (!Writer)
+    {
+        return false;
+    }
+
+    LevelPack::PadTo8(*Writer);
+
+    FLevelPackEntry& Entry = Entries.AddZeroed_GetRef();
+    Entry.ParameterHash = ParameterHash;
+    Entry.Seed = Seed;
+    Entry.NumPlatforms = Layout.Platforms.Num();
+    Entry.NumObstacles = Layout.Obstacles.Num();
+    Entry.NumConnections = Layout.Connections.Num();
+    Entry.NumBuildings = Layout.Buildings.Num();
+    Entry.DataOffset = Writer->Tell();
+
+    LevelPack::WriteRecords(*Writer, Layout.Platforms);
+    LevelPack::WriteRecords(*Writer, Layout.Obstacles);
+    LevelPack::WriteRecords(*Writer, Layout.Connections);
+    LevelPack::WriteRecords(*Writer, Layout.Buildings);
+
+    return !Writer->IsError();
+}
+
+bool FLevelPackWriter::AddDuplicate(uint64 ParameterHash, int32 Seed, int32 ExistingIndex)
+{
+    if (!Writer || !Entries.IsValidIndex(ExistingIndex))
+    {
+        return false;
+    }
+
+    FLevelPackEntry Entry = Entries[ExistingIndex];
+    Entry.ParameterHash = ParameterHash;
+    Entry.Seed = Seed;
+    Entries.Add(Entry);
+    return true;
+}
+
+bool FLevelPackWriter::AddPack(const FLevelPack& Pack)
+{
+    for (const FLevelPackEntry& Entry : Pack.GetEntries())
+    {
+        FLevelLayoutView Layout;
+        if (!Pack.GetLayout(Entry, Layout) || !Add(Entry.ParameterHash, Entry.Seed, Layout))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FLevelPackWriter::Close()
+{
+    if (!Writer)
+    {
+        return false;
+    }
+
+    // Stable sort keeps entries in the order they were added, so the last duplicate wins
+    Algo::StableSort(Entries, &LevelPack::EntryLess);
+    TArray<FLevelPackEntry> Index;
+    Index.Reserve(Entries.Num());
+    for (const FLevelPackEntry& Entry : Entries)
+    {
+        if (!Index.IsEmpty() && Index.Last().ParameterHash == Entry.ParameterHash && Index.Last().Seed == Entry.Seed)
+        {
+            Index.Last() = Entry;
+        }
+        else
+        {
+            Index.Add(Entry);
+        }
+    }
+
+    LevelPack::PadTo8(*Writer);
+
+    FLevelPackHeader PackHeader = {};
+    PackHeader.Magic = LevelPackMagic;
+    PackHeader.Version = LevelPackVersion;
+    PackHeader.NumEntries = Index.Num();
+    PackHeader.IndexOffset = Writer->Tell();
+
+    Writer->Serialize(Index.GetData(), Index.NumBytes());
+    Writer->Seek(0);
+    Writer->Serialize(&PackHeader, sizeof(PackHeader));
+
+    const bool bWritten = Writer->Close() && !Writer->IsError();
+    Writer.Reset();
+    Entries.Reset();
+
+    if (!bWritten || !IFileManager::Get().Move(*Filename, *TempFilename, true, true))
+    {
+        UE_LOG(LogProcGen, Warning, TEXT("Failed to write level pack %s"), *Filename);
+        IFileManager::Get().Delete(*TempFilename);
+        return false;
+    }
+
+    return true;
+}
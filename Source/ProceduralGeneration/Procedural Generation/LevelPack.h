@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LevelLayout.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// Level pack file layout:
+//   FLevelPackHeader
+//   Layout blobs, each one being [Platforms][Obstacles][Connections][Buildings]
+//   FLevelPackEntry index, sorted by parameter hash then seed
+static constexpr uint32 LevelPackMagic = 0x4B504C50; // 'PLPK'
+// 2: layouts are generated with FProcGenRandom, packs built with FRandomStream no longer match their seeds
+static constexpr uint32 LevelPackVersion = 2;
+
+struct FLevelPackHeader
+{
+    uint32 Magic;
+    uint32 Version;
+    uint32 NumEntries;
+    uint32 Reserved;
+    uint64 IndexOffset;
+};
+
+struct FLevelPackEntry
+{
+    uint64 ParameterHash;
+    int32 Seed;
+    uint32 NumPlatforms;
+    uint32 NumObstacles;
+    uint32 NumConnections;
+    uint32 NumBuildings;
+    uint32 Reserved;
+    uint64 DataOffset;
+};
+
+static_assert(sizeof(FLevelPackHeader) == 24, "FLevelPackHeader is stored on disk, bump LevelPackVersion when changing it");
+static_assert(sizeof(FLevelPackEntry) == 40, "FLevelPackEntry is stored on disk, bump LevelPackVersion when changing it");
+
+/**
+ * Read-only access to a level pack. The file is memory mapped and layouts are handed out as views
+ * straight into the mapping, so nothing is parsed or copied when a layout is looked up.
+ */
+class PROCEDURALGENERATION_API FLevelPack
+{
+public:
+    FLevelPack();
+    ~FLevelPack();
+
+    bool Open(const FString& Filename);
+    void Close();
+    bool IsOpen() const { return Header != nullptr; }
+
+    // Binary searches the index for a layout generated with the given parameters and seed
+    bool FindLayout(uint64 ParameterHash, int32 Seed, FLevelLayoutView& OutLayout) const;
+
+    bool GetLayout(const FLevelPackEntry& Entry, FLevelLayoutView& OutLayout) const;
+
+    TConstArrayView<FLevelPackEntry> GetEntries() const { return Entries; }
+
+private:
+    bool ValidateMapping();
+
+    TUniquePtr<IMappedFileHandle> MappedFile;
+    TUniquePtr<IMappedFileRegion> MappedRegion;
+
+    // Used when the platform can't map the file
+    TArray64<uint8> FallbackData;
+
+    const uint8* Data = nullptr;
+    int64 DataSize = 0;
+
+    const FLevelPackHeader* Header = nullptr;
+    TConstArrayView<FLevelPackEntry> Entries;
+};
+
+/**
+ * Streams layouts into a new level pack. Layout data is written as it's added and the index
+ * goes at the end, so only the small entry table is kept in memory.
+ */
+class PROCEDURALGENERATION_API FLevelPackWriter
+{
+public:
+    ~FLevelPackWriter();
+
+    bool Open(const FString& InFilename);
+
+    // Adding the same parameter hash and seed twice keeps the last layout
+    bool Add(uint64 ParameterHash, int32 Seed, const FLevelLayoutView& Layout);
+
+    // Points a new key at a layout that was already added, used when several seeds produce the same layout
+    bool AddDuplicate(uint64 ParameterHash, int32 Seed, int32 ExistingIndex);
+
+    // Copies every layout from another pack, so new layouts can be merged into an existing file
+    bool AddPack(const FLevelPack& Pack);
+
+    // Writes the index and moves the finished pack over the target file
+    bool Close();
+
+    int32 Num() const { return Entries.Num(); }
+
+private:
+    FString Filename;
+    FString TempFilename;
+    TUniquePtr<FArchive> Writer;
+    TArray<FLevelPackEntry> Entries;
+};
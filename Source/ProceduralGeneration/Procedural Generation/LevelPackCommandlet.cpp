@@ -0,0 +1,384 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LevelPackCommandlet.h"
+#include "BSPLayoutBuilder.h"
+#include "GrammarLayoutBuilder.h"
+#include "LevelPack.h"
+#include "ProcGenStats.h"
+#include "ProceduralGeneration/ProcGenTrace.h"
+#include "Async/ParallelFor.h"
+#include "Hash/CityHash.h"
+#include "Misc/SecureHash.h"
+#include "Misc/Paths.h"
+
+namespace LevelPackCommandlet
+{
+	// Rejects layouts that came out incomplete or broken so they never end up in a pack
+	static bool ValidateLayout(const FLevelLayout& Layout, int32 MinPlatforms)
+	{
+		if (Layout.Platforms.Num() < MinPlatforms)
+		{
+			return false;
+		}
+
+		for (const FLayoutPlatform& Platform : Layout.Platforms)
+		{
+			if (Platform.Location.ContainsNaN() || Platform.Rotation.ContainsNaN() || Platform.Scale.GetMin() <= 0.f)
+			{
+				return false;
+			}
+		}
+
+		for (const FLayoutObstacle& Obstacle : Layout.Obstacles)
+		{
+			if (Obstacle.Location.ContainsNaN() || Obstacle.Rotation.ContainsNaN() || !Layout.Platforms.IsValidIndex(Obstacle.PlatformIndex))
+			{
+				return false;
+			}
+		}
+
+		for (const FLayoutConnection& Connection : Layout.Connections)
+		{
+			if (!Layout.Platforms.IsValidIndex(Connection.From) || !Layout.Platforms.IsValidIndex(Connection.To))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Two independent hashes over the same fields. The 64-bit one keys the dedup map, the SHA-1 digest confirms a
+	// match, so a duplicate can be recognised without keeping the layouts it matches in memory.
+	struct FLayoutHasher
+	{
+		uint64 Hash = 0;
+		FSHA1 Digest;
+
+		template <typename ValueType>
+		void Mix(const ValueType& Value)
+		{
+			Hash = CityHash64WithSeed(reinterpret_cast<const char*>(&Value), sizeof(Value), Hash);
+			Digest.Update(reinterpret_cast<const uint8*>(&Value), sizeof(Value));
+		}
+	};
+
+	struct FLayoutHash
+	{
+		uint64 Hash = 0;
+		FSHAHash Digest;
+	};
+
+	// Records are hashed and compared field by field, so whatever ends up in their padding never matters
+	static void MixRecord(FLayoutHasher& Hasher, const FLayoutPlatform& Platform)
+	{
+		Hasher.Mix(Platform.Location);
+		Hasher.Mix(Platform.Scale);
+		Hasher.Mix(Platform.Rotation);
+		Hasher.Mix(Platform.MeshIndex);
+		Hasher.Mix(Platform.Category);
+		Hasher.Mix(Platform.Flags);
+	}
+
+	static void MixRecord(FLayoutHasher& Hasher, const FLayoutObstacle& Obstacle)
+	{
+		Hasher.Mix(Obstacle.Location);
+		Hasher.Mix(Obstacle.Scale);
+		Hasher.Mix(Obstacle.Rotation);
+		Hasher.Mix(Obstacle.MeshIndex);
+		Hasher.Mix(Obstacle.PlatformIndex);
+		Hasher.Mix(Obstacle.Type);
+	}
+
+	static void MixRecord(FLayoutHasher& Hasher, const FLayoutConnection& Connection)
+	{
+		Hasher.Mix(Connection.From);
+		Hasher.Mix(Connection.To);
+		Hasher.Mix(Connection.Category);
+	}
+
+	static bool IsRecordIdentical(const FLayoutPlatform& A, const FLayoutPlatform& B)
+	{
+		return A.Location == B.Location && A.Scale == B.Scale && A.Rotation == B.Rotation
+			&& A.MeshIndex == B.MeshIndex && A.Category == B.Category && A.Flags == B.Flags;
+	}
+
+	static bool IsRecordIdentical(const FLayoutObstacle& A, const FLayoutObstacle& B)
+	{
+		return A.Location == B.Location && A.Scale == B.Scale && A.Rotation == B.Rotation
+			&& A.MeshIndex == B.MeshIndex && A.PlatformIndex == B.PlatformIndex && A.Type == B.Type;
+	}
+
+	static bool IsRecordIdentical(const FLayoutConnection& A, const FLayoutConnection& B)
+	{
+		return A.From == B.From && A.To == B.To && A.Category == B.Category;
+	}
+
+	template <typename RecordType>
+	static void MixRecords(FLayoutHasher& Hasher, const TArray<RecordType>& Records)
+	{
+		Hasher.Mix(Records.Num());
+		for (const RecordType& Record : Records)
+		{
+			MixRecord(Hasher, Record);
+		}
+	}
+
+	static FLayoutHash HashLayout(const FLevelLayout& Layout)
+	{
+		FLayoutHasher Hasher;
+		MixRecords(Hasher, Layout.Platforms);
+		MixRecords(Hasher, Layout.Obstacles);
+		MixRecords(Hasher, Layout.Connections);
+		MixRecords(Hasher, Layout.Buildings);
+
+		FLayoutHash Result;
+		Result.Hash = Hasher.Hash;
+		Hasher.Digest.Final();
+		Hasher.Digest.GetHash(Result.Digest.Hash);
+		return Result;
+	}
+
+	template <typename RecordType>
+	static bool AreRecordsIdentical(const TArray<RecordType>& A, const TArray<RecordType>& B)
+	{
+		if (A.Num() != B.Num())
+		{
+			return false;
+		}
+
+		for (int32 Index = 0; Index < A.Num(); ++Index)
+		{
+			if (!IsRecordIdentical(A[Index], B[Index]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static bool AreLayoutsIdentical(const FLevelLayout& A, const FLevelLayout& B)
+	{
+		return AreRecordsIdentical(A.Platforms, B.Platforms)
+			&& AreRecordsIdentical(A.Obstacles, B.Obstacles)
+			&& AreRecordsIdentical(A.Connections, B.Connections)
+			&& AreRecordsIdentical(A.Buildings, B.Buildings);
+	}
+}
+
+ULevelPackCommandlet::ULevelPackCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 ULevelPackCommandlet::Main(const FString& Params)
+{
+	FString GeneratorName = TEXT("Grammar");
+	FParse::Value(*Params, TEXT("Generator="), GeneratorName);
+	const bool bBSP = GeneratorName.Equals(TEXT("BSP"), ESearchCase::IgnoreCase);
+
+	int32 StartSeed = 0;
+	int32 NumSeeds = 1000;
+	FParse::Value(*Params, TEXT("StartSeed="), StartSeed);
+	FParse::Value(*Params, TEXT("NumSeeds="), NumSeeds);
+
+	UClass* BaseClass = bBSP ? ALevelGenerator::StaticClass() : AGrammarGenerator::StaticClass();
+	UClass* GeneratorClass = BaseClass;
+	FString ClassPath;
+	if (FParse::Value(*Params, TEXT("Class="), ClassPath))
+	{
+		GeneratorClass = LoadClass<AActor>(nullptr, *ClassPath);
+		if (!GeneratorClass || !GeneratorClass->IsChildOf(BaseClass))
+		{
+			UE_LOG(LogProcGen, Error, TEXT("%s is not a %s"), *ClassPath, *BaseClass->GetName());
+			return 1;
+		}
+	}
+
+	// Builders are created per seed from copies of the class defaults. Anything read off a UObject, like the jump
+	// envelope and the parameter hash, is worked out here on the game thread and captured by value for the workers.
+	TFunction<void(int32, FLevelLayout&)> BuildLayout;
+	uint64 ParameterHash = 0;
+	int32 MinPlatforms = 0;
+	FString OutputFile;
+
+	if (bBSP)
+	{
+		const ALevelGenerator* Defaults = GetDefault<ALevelGenerator>(GeneratorClass);
+		const FProceduralGenerationParams SpawnParams = Defaults->GetSpawnParams();
+
+		ParameterHash = FBSPLayoutBuilder::GetParameterHash(SpawnParams);
+		MinPlatforms = 2;
+		OutputFile = Defaults->GetLevelPackPath();
+		BuildLayout = [SpawnParams](int32 Seed, FLevelLayout& OutLayout)
+		{
+			FBSPLayoutBuilder Builder(SpawnParams);
+			Builder.Build(Seed, OutLayout);
+		};
+	}
+	else
+	{
+		const AGrammarGenerator* Defaults = GetDefault<AGrammarGenerator>(GeneratorClass);
+		const FGrammarRules SpawnParams = Defaults->GetSpawnParams();
+		const FDecorateLevelRules DecorateRules = Defaults->GetDecorateRules();
+
+		const FJumpEnvelope JumpEnvelope = FGrammarLayoutBuilder::MakeJumpEnvelope(SpawnParams);
+
+		ParameterHash = FGrammarLayoutBuilder::GetParameterHash(SpawnParams, DecorateRules, JumpEnvelope);
+		MinPlatforms = SpawnParams.NumPlatforms;
+		OutputFile = Defaults->GetLevelPackPath();
+		BuildLayout = [SpawnParams, DecorateRules, JumpEnvelope, ParameterHash](int32 Seed, FLevelLayout& OutLayout)
+		{
+			FGrammarLayoutBuilder Builder(SpawnParams, DecorateRules, JumpEnvelope);
+			Builder.Build(Seed, ParameterHash, OutLayout);
+		};
+	}
+
+	FParse::Value(*Params, TEXT("Output="), OutputFile);
+
+	// Rebuilds every seed on this thread in reverse order and checks it matches the parallel build record for record
+	const bool bVerifyDeterminism = FParse::Param(*Params, TEXT("VerifyDeterminism"));
+
+	FLevelPackWriter Writer;
+	if (!Writer.Open(OutputFile))
+	{
+		return 1;
+	}
+
+	if (FParse::Param(*Params, TEXT("Append")))
+	{
+		FLevelPack ExistingPack;
+		if (ExistingPack.Open(OutputFile) && !Writer.AddPack(ExistingPack))
+		{
+			UE_LOG(LogProcGen, Error, TEXT("Failed copying the existing layouts of %s"), *OutputFile);
+			return 1;
+		}
+	}
+
+	UE_LOG(LogProcGen, Display, TEXT("Generating %d %s layouts from seed %d into %s"), NumSeeds, *GeneratorName, StartSeed, *OutputFile);
+
+	// Seeds are built in batches across all cores, then validated results are written in seed order on this thread
+	const int32 BatchSize = FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1) * 64;
+
+	TArray<FLevelLayout> Layouts;
+	TArray<LevelPackCommandlet::FLayoutHash> LayoutHashes;
+	TArray<bool> ValidLayouts;
+
+	// Pack entry of every layout written so far, only its hashes are kept, the layout itself is already on disk
+	struct FWrittenLayout
+	{
+		int32 Entry;
+		FSHAHash Digest;
+	};
+	TMultiMap<uint64, FWrittenLayout> WrittenLayouts;
+
+	int32 NumWritten = 0;
+	int32 NumDuplicates = 0;
+	int32 NumInvalid = 0;
+	int32 NumMismatched = 0;
+	FLevelLayout VerifyLayout;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	for (int32 BatchStart = 0; BatchStart < NumSeeds; BatchStart += BatchSize)
+	{
+		const int32 BatchNum = FMath::Min(BatchSize, NumSeeds - BatchStart);
+		Layouts.SetNum(BatchNum);
+		LayoutHashes.SetNum(BatchNum);
+		ValidLayouts.SetNum(BatchNum);
+
+		PROCGEN_TRACE_BOOKMARK(TEXT("LevelPack batch, seeds %d-%d"), StartSeed + BatchStart, StartSeed + BatchStart + BatchNum - 1);
+
+		ParallelFor(BatchNum, [&](int32 Index)
+		{
+			BuildLayout(StartSeed + BatchStart + Index, Layouts[Index]);
+			ValidLayouts[Index] = LevelPackCommandlet::ValidateLayout(Layouts[Index], MinPlatforms);
+			if (ValidLayouts[Index])
+			{
+				LayoutHashes[Index] = LevelPackCommandlet::HashLayout(Layouts[Index]);
+			}
+		});
+
+		if (bVerifyDeterminism)
+		{
+			for (int32 Index = BatchNum - 1; Index >= 0; --Index)
+			{
+				const int32 Seed = StartSeed + BatchStart + Index;
+				BuildLayout(Seed, VerifyLayout);
+				if (!LevelPackCommandlet::AreLayoutsIdentical(Layouts[Index], VerifyLayout))
+				{
+					UE_LOG(LogProcGen, Error, TEXT("Seed %d is not deterministic, the parallel and serial builds differ"), Seed);
+					++NumMismatched;
+				}
+			}
+		}
+
+		for (int32 Index = 0; Index < BatchNum; ++Index)
+		{
+			const int32 Seed = StartSeed + BatchStart + Index;
+			if (!ValidLayouts[Index])
+			{
+				++NumInvalid;
+				continue;
+			}
+
+			// Seeds that produce an identical layout share its data in the pack. Both hashes have to match, a 64-bit
+			// collision alone doesn't alias two different layouts.
+			const LevelPackCommandlet::FLayoutHash& LayoutHash = LayoutHashes[Index];
+			int32 ExistingEntry = INDEX_NONE;
+			for (auto It = WrittenLayouts.CreateConstKeyIterator(LayoutHash.Hash); It; ++It)
+			{
+				if (It.Value().Digest == LayoutHash.Digest)
+				{
+					ExistingEntry = It.Value().Entry;
+					break;
+				}
+			}
+
+			if (ExistingEntry != INDEX_NONE)
+			{
+				if (!Writer.AddDuplicate(ParameterHash, Seed, ExistingEntry))
+				{
+					UE_LOG(LogProcGen, Error, TEXT("Failed writing seed %d to %s"), Seed, *OutputFile);
+					return 1;
+				}
+				++NumDuplicates;
+				continue;
+			}
+
+			const int32 Entry = Writer.Num();
+			if (!Writer.Add(ParameterHash, Seed, Layouts[Index].GetView()))
+			{
+				UE_LOG(LogProcGen, Error, TEXT("Failed writing seed %d to %s"), Seed, *OutputFile);
+				return 1;
+			}
+			WrittenLayouts.Add(LayoutHash.Hash, FWrittenLayout{ Entry, LayoutHash.Digest });
+			++NumWritten;
+		}
+
+		const int32 NumDone = BatchStart + BatchNum;
+		UE_LOG(LogProcGen, Display, TEXT("%d/%d seeds (%.0f%%): %d written, %d duplicate, %d invalid"),
+			NumDone, NumSeeds, 100.0 * NumDone / NumSeeds, NumWritten, NumDuplicates, NumInvalid);
+	}
+
+	// Checked before Close, which would move the pack over the target. Returning here leaves the existing pack
+	// alone and the abandoned writer deletes its temp file.
+	if (NumMismatched > 0)
+	{
+		UE_LOG(LogProcGen, Error, TEXT("%d of %d seeds were not deterministic, %s was left unchanged"), NumMismatched, NumSeeds, *OutputFile);
+		return 1;
+	}
+
+	if (!Writer.Close())
+	{
+		return 1;
+	}
+
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+	UE_LOG(LogProcGen, Display, TEXT("Generated %d layouts in %.2fs, %.1f layouts/sec"), NumSeeds, Elapsed, NumSeeds / FMath::Max(Elapsed, UE_SMALL_NUMBER));
+
+	return 0;
+}
@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "LevelPackCommandlet.generated.h"
+
+/**
+ * Pre-generates layouts for a range of seeds and writes them into a level pack, no world needed.
+ *
+ * UnrealEditor-Cmd ProceduralGeneration.uproject -run=LevelPack -Generator=Grammar|BSP
+ *     [-Class=/Game/Path/BP_Generator.BP_Generator_C] [-StartSeed=0] [-NumSeeds=1000] [-Output=File.lpk] [-Append]
+ *     [-VerifyDeterminism]
+ *
+ * Generation parameters are read from the class defaults, so pass the Blueprint that is placed in the level.
+ * -VerifyDeterminism also builds every seed a second time serially and fails if any layout differs.
+ * Add -trace=cpu,bookmark,ProcGen to capture the whole run in Unreal Insights.
+ */
+UCLASS()
+class PROCEDURALGENERATION_API ULevelPackCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	ULevelPackCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
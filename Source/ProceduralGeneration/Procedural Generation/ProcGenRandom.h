@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Every generator stage draws from its own streams, so adding draws to one stage never shifts another
+enum class EProcGenStage : uint32
+{
+    FloorPartition,
+    PlatformOrder,
+    PlatformPlacement,
+    Connections,
+    GrammarChain,
+    Obstacles,
+    Decoration
+};
+
+/**
+ * Counter-based random numbers (SplitMix64 over a counter). Each value is a pure function of
+ * (seed, stage, entity index, draw number), so a stream gives the same values no matter which thread
+ * runs it, what order entities are processed in or what else is using FMath::Rand.
+ * Drop-in for the FRandomStream calls the generators use.
+ */
+class FProcGenRandom
+{
+public:
+    static constexpr int32 BatchWidth = 4;
+
+    FProcGenRandom() = default;
+
+    FProcGenRandom(int32 Seed, EProcGenStage Stage, uint32 EntityIndex = 0)
+        : Key(MakeKey(Seed, Stage, EntityIndex))
+    {
+    }
+
+    uint64 GetUInt64()
+    {
+        return Mix(Key + Gamma * Counter++);
+    }
+
+    uint32 GetUInt32()
+    {
+        return static_cast<uint32>(GetUInt64() >> 32);
+    }
+
+    // Uniform in [0, 1)
+    float GetFraction()
+    {
+        return (GetUInt32() >> 8) * FractionScale;
+    }
+
+    // Inclusive on both ends like FRandomStream::RandRange, returns Min when the range is empty
+    int32 RandRange(int32 Min, int32 Max)
+    {
+        const int64 Range = static_cast<int64>(Max) - Min + 1;
+        return Range > 0 ? Min + static_cast<int32>((static_cast<uint64>(GetUInt32()) * Range) >> 32) : Min;
+    }
+
+    // Mixed float/double arguments promote the same way FMath::FRandRange does
+    template <typename T1, typename T2>
+    auto FRandRange(T1 Min, T2 Max)
+    {
+        using T = decltype(Min + Max + 0.f);
+        return static_cast<T>(Min + (Max - Min) * GetFraction());
+    }
+
+    /**
+     * Fills the view with fractions in [0, 1), BatchWidth at a time. Lanes hash independent counters so
+     * there is no dependency between them, and the float conversion is done on a whole vector register.
+     * Gives the same values as calling GetFraction once per element.
+     */
+    void FillFractions(TArrayView<float> OutFractions)
+    {
+        float* Out = OutFractions.GetData();
+        const int32 Num = OutFractions.Num();
+
+        int32 Index = 0;
+        for (; Index + BatchWidth <= Num; Index += BatchWidth)
+        {
+            alignas(16) uint32 Lanes[BatchWidth];
+            for (int32 Lane = 0; Lane < BatchWidth; ++Lane)
+            {
+                Lanes[Lane] = static_cast<uint32>(Mix(Key + Gamma * (Counter + Lane)) >> 32);
+            }
+            Counter += BatchWidth;
+
+            const VectorRegister4Int Bits = VectorShiftRightImmLogical(VectorIntLoadAligned(Lanes), 8);
+            VectorStore(VectorMultiply(VectorIntToFloat(Bits), VectorSetFloat1(FractionScale)), Out + Index);
+        }
+
+        for (; Index < Num; ++Index)
+        {
+            Out[Index] = GetFraction();
+        }
+    }
+
+private:
+    static constexpr uint64 Gamma = 0x9E3779B97F4A7C15ull;
+    static constexpr float FractionScale = 1.f / 16777216.f;
+
+    static uint64 Mix(uint64 Value)
+    {
+        Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+        return Value ^ (Value >> 31);
+    }
+
+    static uint64 MakeKey(int32 Seed, EProcGenStage Stage, uint32 EntityIndex)
+    {
+        const uint64 StageKey = Mix(static_cast<uint64>(static_cast<uint32>(Seed)) | (static_cast<uint64>(Stage) << 32));
+        return Mix(StageKey ^ (Gamma * (static_cast<uint64>(EntityIndex) + 1)));
+    }
+
+    uint64 Key = 0;
+    uint64 Counter = 0;
+};
@@ -0,0 +1,198 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ProcGenStats.h"
+#include "GrammarGenerator.h"
+#include "Dom/JsonObject.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+DEFINE_LOG_CATEGORY(LogProcGen);
+
+DEFINE_STAT(STAT_ProcGen_Partition);
+DEFINE_STAT(STAT_ProcGen_PlacePlatforms);
+DEFINE_STAT(STAT_ProcGen_Connections);
+DEFINE_STAT(STAT_ProcGen_GrammarChain);
+DEFINE_STAT(STAT_ProcGen_Decoration);
+DEFINE_STAT(STAT_ProcGen_Realise);
+
+DEFINE_STAT(STAT_ProcGen_PartitionNodes);
+DEFINE_STAT(STAT_ProcGen_PlacementAttempts);
+DEFINE_STAT(STAT_ProcGen_PlacementRejections);
+DEFINE_STAT(STAT_ProcGen_ConnectionCandidates);
+DEFINE_STAT(STAT_ProcGen_ConnectionsAccepted);
+DEFINE_STAT(STAT_ProcGen_Obstacles);
+DEFINE_STAT(STAT_ProcGen_ActorsSpawned);
+DEFINE_STAT(STAT_ProcGen_ActorsReused);
+
+void FProcGenReport::Reset(const TCHAR* InGenerator, int32 InSeed, uint64 InParameterHash)
+{
+	*this = FProcGenReport();
+	Generator = InGenerator;
+	Seed = InSeed;
+	ParameterHash = InParameterHash;
+}
+
+void FProcGenReport::AddPartitionNodes(int32 Num)
+{
+	PartitionNodes += Num;
+	INC_DWORD_STAT_BY(STAT_ProcGen_PartitionNodes, Num);
+}
+
+void FProcGenReport::AddPlacementAttempt(int32 Category, bool bAccepted)
+{
+	++PlacementAttempts;
+	INC_DWORD_STAT(STAT_ProcGen_PlacementAttempts);
+
+	const bool bHasCategory = Category >= 0 && Category < MaxPlacementCategories;
+	if (bHasCategory)
+	{
+		++AttemptsByCategory[Category];
+	}
+
+	if (!bAccepted)
+	{
+		++PlacementRejections;
+		INC_DWORD_STAT(STAT_ProcGen_PlacementRejections);
+
+		if (bHasCategory)
+		{
+			++RejectionsByCategory[Category];
+		}
+	}
+}
+
+void FProcGenReport::AddConnectionCandidate(bool bAccepted)
+{
+	++ConnectionCandidates;
+	INC_DWORD_STAT(STAT_ProcGen_ConnectionCandidates);
+
+	if (bAccepted)
+	{
+		++ConnectionsAccepted;
+		INC_DWORD_STAT(STAT_ProcGen_ConnectionsAccepted);
+	}
+}
+
+void FProcGenReport::AddObstacle(ELayoutObstacleType Type)
+{
+	++ObstaclesByType[static_cast<int32>(Type)];
+	INC_DWORD_STAT(STAT_ProcGen_Obstacles);
+}
+
+void FProcGenReport::AddActors(int32 NumSpawned, int32 NumReused)
+{
+	ActorsSpawned += NumSpawned;
+	ActorsReused += NumReused;
+	INC_DWORD_STAT_BY(STAT_ProcGen_ActorsSpawned, NumSpawned);
+	INC_DWORD_STAT_BY(STAT_ProcGen_ActorsReused, NumReused);
+}
+
+void FProcGenReport::AddPhaseTime(const TCHAR* Phase, double Milliseconds)
+{
+	PhaseTimes.Emplace(Phase, Milliseconds);
+}
+
+double FProcGenReport::GetTotalTime() const
+{
+	double Total = 0.0;
+	for (const TPair<FString, double>& PhaseTime : PhaseTimes)
+	{
+		Total += PhaseTime.Value;
+	}
+	return Total;
+}
+
+FString FProcGenReport::ToJson() const
+{
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetStringField(TEXT("generator"), Generator);
+	Root->SetNumberField(TEXT("seed"), Seed);
+	Root->SetStringField(TEXT("parameterHash"), FString::Printf(TEXT("%016llx"), ParameterHash));
+	Root->SetBoolField(TEXT("fromLevelPack"), bFromLevelPack);
+	Root->SetNumberField(TEXT("totalMs"), GetTotalTime());
+
+	TSharedRef<FJsonObject> Phases = MakeShared<FJsonObject>();
+	for (const TPair<FString, double>& PhaseTime : PhaseTimes)
+	{
+		Phases->SetNumberField(PhaseTime.Key, PhaseTime.Value);
+	}
+	Root->SetObjectField(TEXT("phasesMs"), Phases);
+
+	Root->SetNumberField(TEXT("partitionNodes"), PartitionNodes);
+
+	TSharedRef<FJsonObject> Placement = MakeShared<FJsonObject>();
+	Placement->SetNumberField(TEXT("attempts"), PlacementAttempts);
+	Placement->SetNumberField(TEXT("rejections"), PlacementRejections);
+
+	TSharedRef<FJsonObject> ByCategory = MakeShared<FJsonObject>();
+	const UEnum* CategoryEnum = StaticEnum<EPlatformPlacementCategory>();
+	for (int32 Category = 0; Category < MaxPlacementCategories; ++Category)
+	{
+		if (AttemptsByCategory[Category] == 0)
+		{
+			continue;
+		}
+
+		TSharedRef<FJsonObject> CategoryCounts = MakeShared<FJsonObject>();
+		CategoryCounts->SetNumberField(TEXT("attempts"), AttemptsByCategory[Category]);
+		CategoryCounts->SetNumberField(TEXT("rejections"), RejectionsByCategory[Category]);
+		ByCategory->SetObjectField(CategoryEnum->GetNameStringByValue(Category), CategoryCounts);
+	}
+	Placement->SetObjectField(TEXT("byCategory"), ByCategory);
+	Root->SetObjectField(TEXT("placement"), Placement);
+
+	TSharedRef<FJsonObject> Connections = MakeShared<FJsonObject>();
+	Connections->SetNumberField(TEXT("candidates"), ConnectionCandidates);
+	Connections->SetNumberField(TEXT("accepted"), ConnectionsAccepted);
+	Root->SetObjectField(TEXT("connections"), Connections);
+
+	static const TCHAR* ObstacleNames[NumObstacleTypes] = { TEXT("WallRun"), TEXT("Mantle"), TEXT("MantleWall"), TEXT("Vault"), TEXT("Building") };
+	TSharedRef<FJsonObject> Obstacles = MakeShared<FJsonObject>();
+	for (int32 Type = 0; Type < NumObstacleTypes; ++Type)
+	{
+		Obstacles->SetNumberField(ObstacleNames[Type], ObstaclesByType[Type]);
+	}
+	Root->SetObjectField(TEXT("obstacles"), Obstacles);
+
+	TSharedRef<FJsonObject> Actors = MakeShared<FJsonObject>();
+	Actors->SetNumberField(TEXT("spawned"), ActorsSpawned);
+	Actors->SetNumberField(TEXT("reused"), ActorsReused);
+	Root->SetObjectField(TEXT("actors"), Actors);
+
+	TSharedRef<FJsonObject> MemoryObject = MakeShared<FJsonObject>();
+	MemoryObject->SetNumberField(TEXT("totalBytes"), Memory.GetTotalBytes());
+	MemoryObject->SetNumberField(TEXT("planningBytes"), Memory.PlanningBytes);
+	MemoryObject->SetNumberField(TEXT("platformBytes"), Memory.PlatformBytes);
+	MemoryObject->SetNumberField(TEXT("obstacleBytes"), Memory.ObstacleBytes);
+	MemoryObject->SetNumberField(TEXT("decorationBytes"), Memory.DecorationBytes);
+	MemoryObject->SetNumberField(TEXT("bytesPerPlatform"), Memory.GetBytesPerPlatform());
+	MemoryObject->SetNumberField(TEXT("bytesPerObstacle"), Memory.GetBytesPerObstacle());
+	MemoryObject->SetNumberField(TEXT("droppedDecorationLayers"), Memory.DroppedDecorationLayers);
+	Root->SetObjectField(TEXT("memory"), MemoryObject);
+
+	FString Json;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Root, Writer);
+	return Json;
+}
+
+FString FProcGenReport::GetDefaultFilename() const
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ProcGen"),
+		FString::Printf(TEXT("%s_%d_%s.json"), *Generator, Seed, *FDateTime::Now().ToString()));
+}
+
+bool FProcGenReport::WriteJson(const FString& Filename) const
+{
+	if (!FFileHelper::SaveStringToFile(ToJson(), *Filename))
+	{
+		UE_LOG(LogProcGen, Warning, TEXT("Failed to write generation report %s"), *Filename);
+		return false;
+	}
+
+	UE_LOG(LogProcGen, Log, TEXT("Wrote generation report %s"), *Filename);
+	return true;
+}
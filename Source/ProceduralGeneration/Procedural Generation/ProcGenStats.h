@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "LevelLayout.h"
+#include "ProceduralGeneration/ProcGenMemory.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogProcGen, Log, All);
+
+// "stat ProcGen" in game, or a stats capture, shows where generation time goes
+DECLARE_STATS_GROUP(TEXT("ProcGen"), STATGROUP_ProcGen, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Partition"), STAT_ProcGen_Partition, STATGROUP_ProcGen, PROCEDURALGENERATION_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Place Platforms"), STAT_ProcGen_PlacePlatforms, STATGROUP_ProcGen, PROCEDURALGENERATION_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Connections"), STAT_ProcGen_Connections, STATGROUP_ProcGen, PROCEDURALGENERATION_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Grammar Chain"), STAT_ProcGen_GrammarChain, STATGROUP_ProcGen, PROCEDURALGENERATION_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Decoration"), STAT_ProcGen_Decoration, STATGROUP_ProcGen, PROCEDURALGENERATION_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Realise Layout"), STAT_ProcGen_Realise, STATGROUP_ProcGen, PROCEDURALGENERATION_API);
+
+// Running totals since startup, the per-run numbers are in FProcGenReport
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Partition Nodes"), STAT_ProcGen_PartitionNodes, STATGROUP_ProcGen, PROCEDURALGENERATION_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Placement Attempts"), STAT_ProcGen_PlacementAttempts, STATGROUP_ProcGen, PROCEDURALGENERATION_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Placement Rejections"), STAT_ProcGen_PlacementRejections, STATGROUP_ProcGen, PROCEDURALGENERATION_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Connection Candidates"), STAT_ProcGen_ConnectionCandidates, STATGROUP_ProcGen, PROCEDURALGENERATION_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Connections Accepted"), STAT_ProcGen_ConnectionsAccepted, STATGROUP_ProcGen, PROCEDURALGENERATION_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Obstacles"), STAT_ProcGen_Obstacles, STATGROUP_ProcGen, PROCEDURALGENERATION_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Actors Spawned"), STAT_ProcGen_ActorsSpawned, STATGROUP_ProcGen, PROCEDURALGENERATION_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Actors Reused"), STAT_ProcGen_ActorsReused, STATGROUP_ProcGen, PROCEDURALGENERATION_API);
+
+/**
+ * What happened during one generation run. Builders fill it in as they go, the generator actor adds
+ * the realise step and can write it out as JSON. Every count also feeds the ProcGen stat group.
+ */
+struct PROCEDURALGENERATION_API FProcGenReport
+{
+	// Enough for every EPlatformPlacementCategory
+	static constexpr int32 MaxPlacementCategories = 32;
+	static constexpr int32 NumObstacleTypes = static_cast<int32>(ELayoutObstacleType::Building) + 1;
+
+	FString Generator;
+	int32 Seed = 0;
+	uint64 ParameterHash = 0;
+	bool bFromLevelPack = false;
+
+	// Milliseconds per phase, in the order they ran
+	TArray<TPair<FString, double>> PhaseTimes;
+
+	int32 PartitionNodes = 0;
+	int32 PlacementAttempts = 0;
+	int32 PlacementRejections = 0;
+	int32 AttemptsByCategory[MaxPlacementCategories] = {};
+	int32 RejectionsByCategory[MaxPlacementCategories] = {};
+	int32 ConnectionCandidates = 0;
+	int32 ConnectionsAccepted = 0;
+	int32 ObstaclesByType[NumObstacleTypes] = {};
+	int32 ActorsSpawned = 0;
+	int32 ActorsReused = 0;
+
+	FProcGenMemorySummary Memory;
+
+	void Reset(const TCHAR* InGenerator, int32 InSeed, uint64 InParameterHash);
+
+	void AddPartitionNodes(int32 Num);
+
+	// Category is an EPlatformPlacementCategory, or INDEX_NONE for generators that don't have one
+	void AddPlacementAttempt(int32 Category, bool bAccepted);
+
+	void AddConnectionCandidate(bool bAccepted);
+	void AddObstacle(ELayoutObstacleType Type);
+	void AddActors(int32 NumSpawned, int32 NumReused);
+
+	void AddPhaseTime(const TCHAR* Phase, double Milliseconds);
+	double GetTotalTime() const;
+
+	FString ToJson() const;
+
+	// Saved/ProcGen/<Generator>_<Seed>_<Timestamp>.json
+	FString GetDefaultFilename() const;
+	bool WriteJson(const FString& Filename) const;
+};
+
+// Times a phase into a report, use next to the matching SCOPE_CYCLE_COUNTER
+class PROCEDURALGENERATION_API FProcGenPhaseTimer
+{
+public:
+	FProcGenPhaseTimer(FProcGenReport& InReport, const TCHAR* InPhase)
+		: Report(InReport)
+		, Phase(InPhase)
+		, StartTime(FPlatformTime::Seconds())
+	{
+	}
+
+	~FProcGenPhaseTimer()
+	{
+		Report.AddPhaseTime(Phase, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	}
+
+private:
+	FProcGenReport& Report;
+	const TCHAR* Phase;
+	double StartTime;
+};
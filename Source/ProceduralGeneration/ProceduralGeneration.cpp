@@ -1,6 +1,21 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "ProceduralGeneration.h"
+#include "ProcGenMemory.h"
+#include "ProcGenTrace.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, ProceduralGeneration, "ProceduralGeneration" );
+UE_TRACE_CHANNEL_DEFINE(ProcGenChannel);
+
+class FProceduralGenerationModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+#if PROCGEN_ALLOCATION_AUDIT
+		FProcGenAllocationAuditScope::InstallIfRequested();
+#endif
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FProceduralGenerationModule, ProceduralGeneration, "ProceduralGeneration" );
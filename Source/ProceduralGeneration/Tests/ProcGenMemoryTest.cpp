@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ProceduralGeneration/ProcGenMemory.h"
+#include "ProceduralGeneration/ParkourCharacter.h"
+#include "ProceduralGeneration/MechanicComponents/MechanicsComponent.h"
+#include "ProceduralGeneration/MechanicComponents/MechanicsSubsystem.h"
+#include "ProceduralGeneration/Mechanics/SlideMechanic.h"
+#include "ProceduralGeneration/Mechanics/VaultMechanic.h"
+#include "ProceduralGeneration/Mechanics/WallRunMechanic.h"
+#include "Procedural Generation/GeneratedGeometry.h"
+#include "AIController.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && PROCGEN_ALLOCATION_AUDIT
+
+namespace ProcGenMemoryTest
+{
+	static constexpr int32 NumFrames = 30;
+	static constexpr float DeltaTime = 1.0f / 60.0f;
+
+	// The blueprint carries the anim instance and curves the mechanics drive
+	static const TCHAR* CharacterClassPath = TEXT("/Game/Blueprints/Character/BP_ParkourCharacter.BP_ParkourCharacter_C");
+	static const TCHAR* CubePath = TEXT("/Engine/BasicShapes/Cube.Cube");
+
+	// Input and ticks the way a frame runs them, only the audited scopes inside count
+	static void TickFrames(AParkourCharacter* Character, UMechanicsSubsystem* MechanicsSubsystem, const FVector2D& MoveValue)
+	{
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			Character->Move(FInputActionValue(MoveValue));
+			Character->Look(FInputActionValue(FVector2D(1.0f, 0.0f)));
+			Character->Tick(DeltaTime);
+			MechanicsSubsystem->TickMechanics(DeltaTime);
+		}
+	}
+
+	// Generated wall along the character's right, close enough for every wall run probe to hit it
+	static AStaticMeshActor* SpawnWall(UWorld* World, UStaticMesh* Cube)
+	{
+		AStaticMeshActor* Wall = World->SpawnActor<AStaticMeshActor>(FVector(0.0f, 50.0f, 0.0f), FRotator::ZeroRotator);
+		Wall->SetMobility(EComponentMobility::Movable);
+		Wall->GetStaticMeshComponent()->SetStaticMesh(Cube);
+		Wall->SetActorScale3D(FVector(10.0f, 0.2f, 4.0f));
+
+		if (UGeneratedGeometrySubsystem* GeneratedGeometry = World->GetSubsystem<UGeneratedGeometrySubsystem>())
+		{
+			GeneratedGeometry->RegisterActor(Wall, EGeneratedBoxType::WallRun);
+		}
+		return Wall;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FProcGenAllocationAuditTest, "ProceduralGeneration.Memory.AllocationAudit",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+// Adds the slide, wall run and vault to a possessed character in a throwaway world, starts them and ticks
+// them through the mechanics subsystem, none of the audited scopes may allocate
+bool FProcGenAllocationAuditTest::RunTest(const FString& Parameters)
+{
+	using namespace ProcGenMemoryTest;
+
+	if (!FProcGenAllocationAuditScope::IsInstalled())
+	{
+		AddWarning(TEXT("Allocation audit skipped, run with -ProcGenAllocAudit to wrap the allocator at startup"));
+		return true;
+	}
+
+	IConsoleVariable* AllocAudit = IConsoleManager::Get().FindConsoleVariable(TEXT("p.Parkour.AllocAudit"));
+	UClass* CharacterClass = LoadClass<AParkourCharacter>(nullptr, CharacterClassPath);
+	UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, CubePath);
+	if (!TestNotNull(TEXT("p.Parkour.AllocAudit exists"), AllocAudit) || !TestNotNull(TEXT("Character class"), CharacterClass)
+		|| !TestNotNull(TEXT("Cube mesh"), Cube))
+	{
+		return false;
+	}
+	const int32 PreviousAudit = AllocAudit->GetInt();
+	AllocAudit->Set(1, ECVF_SetByCode);
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	AParkourCharacter* Character = World->SpawnActor<AParkourCharacter>(CharacterClass, FVector::ZeroVector, FRotator::ZeroRotator);
+	AAIController* Controller = World->SpawnActor<AAIController>();
+	UMechanicsSubsystem* MechanicsSubsystem = World->GetSubsystem<UMechanicsSubsystem>();
+	UMechanicsComponent* Mechanics = Character ? Character->GetMechanicComponent() : nullptr;
+
+	if (TestNotNull(TEXT("Character spawned"), Character) && TestNotNull(TEXT("Controller spawned"), Controller)
+		&& TestNotNull(TEXT("Mechanics subsystem"), MechanicsSubsystem) && TestNotNull(TEXT("Mechanics component"), Mechanics)
+		&& TestNotNull(TEXT("Anim instance"), Mechanics->GetOwnerState().AnimInstance))
+	{
+		Controller->Possess(Character);
+		AStaticMeshActor* Wall = SpawnWall(World, Cube);
+
+		// The blueprint may already give the character some of these
+		for (UClass* MechanicClass : { USlideMechanic::StaticClass(), UWallRunMechanic::StaticClass(), UVaultMechanic::StaticClass() })
+		{
+			if (!Mechanics->GetMechanic(MechanicClass))
+			{
+				Mechanics->AddMechanic(Character, MechanicClass);
+			}
+		}
+
+		UBaseMechanic* Slide = Mechanics->GetMechanic(USlideMechanic::StaticClass());
+		UBaseMechanic* WallRun = Mechanics->GetMechanic(UWallRunMechanic::StaticClass());
+		UBaseMechanic* Vault = Mechanics->GetMechanic(UVaultMechanic::StaticClass());
+
+		if (TestNotNull(TEXT("Slide added"), Slide) && TestNotNull(TEXT("Wall run added"), WallRun) && TestNotNull(TEXT("Vault added"), Vault))
+		{
+			UCharacterMovementComponent* Movement = Character->GetCharacterMovement();
+			const uint64 AllocationsBefore = FProcGenAllocationAuditScope::GetAllocationCount();
+
+			// Faster than walking on the ground slides rather than crouches, which plays the capsule and mesh timelines
+			Movement->SetMovementMode(MOVE_Walking);
+			Movement->Velocity = Character->GetActorForwardVector() * Character->GetPlayerWalkSpeed() * 2.0f;
+			TestTrue(TEXT("Slide started"), Mechanics->StartMechanicInstance(Character, Slide));
+			TestTrue(TEXT("Vault started"), Mechanics->StartMechanicInstance(Character, Vault));
+			TickFrames(Character, MechanicsSubsystem, FVector2D(0.0f, 1.0f));
+			Mechanics->StopMechanicInstance(Character, Slide);
+			Mechanics->StopMechanicInstance(Character, Vault);
+
+			// Jump, then run into the wall while falling the same way the capsule hit does in play
+			TestTrue(TEXT("Wall run started"), Mechanics->StartMechanicInstance(Character, WallRun));
+			Movement->SetMovementMode(MOVE_Falling);
+			Character->Move(FInputActionValue(FVector2D(1.0f, 1.0f)));
+
+			FHitResult WallHit(Wall, Wall->GetStaticMeshComponent(), FVector(0.0f, 40.0f, 0.0f), FVector(0.0f, -1.0f, 0.0f));
+			Character->GetCapsuleComponent()->OnComponentHit.Broadcast(Character->GetCapsuleComponent(), Wall, Wall->GetStaticMeshComponent(), FVector::ZeroVector, WallHit);
+			TickFrames(Character, MechanicsSubsystem, FVector2D(1.0f, 1.0f));
+			Mechanics->StopMechanicInstance(Character, WallRun);
+
+			const uint64 Allocations = FProcGenAllocationAuditScope::GetAllocationCount() - AllocationsBefore;
+			TestTrue(FString::Printf(TEXT("Audited scopes made %llu heap allocations"), Allocations), Allocations == 0);
+		}
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	AllocAudit->Set(PreviousAudit, ECVF_SetByCode);
+	return true;
+}
+
+#endif
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Procedural Generation/BSPLayoutBuilder.h"
+#include "Procedural Generation/GrammarLayoutBuilder.h"
+#include "Procedural Generation/LevelGenerator.h"
+#include "Async/ParallelFor.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace ProcGenRandomTest
+{
+	static constexpr int32 StartSeed = 1;
+	static constexpr int32 NumSeeds = 64;
+
+	template <typename RecordType>
+	static bool AreRecordsIdentical(const TArray<RecordType>& A, const TArray<RecordType>& B)
+	{
+		return A.Num() == B.Num() && FMemory::Memcmp(A.GetData(), B.GetData(), A.NumBytes()) == 0;
+	}
+
+	// Builds every seed on this thread and then again across the task graph in reverse, each layout has to come
+	// out the same byte for byte, padding included, since that is what gets written to a level pack
+	static void TestBuildsMatch(FAutomationTestBase& Test, const TCHAR* Name, TFunctionRef<void(int32, FLevelLayout&)> BuildLayout)
+	{
+		TArray<FLevelLayout> Serial;
+		Serial.SetNum(NumSeeds);
+		for (int32 Index = 0; Index < NumSeeds; ++Index)
+		{
+			BuildLayout(StartSeed + Index, Serial[Index]);
+		}
+
+		TArray<FLevelLayout> Parallel;
+		Parallel.SetNum(NumSeeds);
+		ParallelFor(NumSeeds, [&](int32 Index)
+		{
+			const int32 Reversed = NumSeeds - 1 - Index;
+			BuildLayout(StartSeed + Reversed, Parallel[Reversed]);
+		});
+
+		for (int32 Index = 0; Index < NumSeeds; ++Index)
+		{
+			const FLevelLayout& A = Serial[Index];
+			const FLevelLayout& B = Parallel[Index];
+			const bool bIdentical = AreRecordsIdentical(A.Platforms, B.Platforms)
+				&& AreRecordsIdentical(A.Obstacles, B.Obstacles)
+				&& AreRecordsIdentical(A.Connections, B.Connections)
+				&& AreRecordsIdentical(A.Buildings, B.Buildings);
+
+			Test.TestTrue(FString::Printf(TEXT("%s seed %d builds the same serially and in parallel"), Name, StartSeed + Index), bIdentical);
+			Test.TestFalse(FString::Printf(TEXT("%s seed %d built platforms"), Name, StartSeed + Index), A.Platforms.IsEmpty());
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FProcGenDeterminismTest, "ProceduralGeneration.Random.Determinism",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FProcGenDeterminismTest::RunTest(const FString& Parameters)
+{
+	// Anything read off a UObject is read here, the builders only get copies
+	const AGrammarGenerator* GrammarDefaults = GetDefault<AGrammarGenerator>();
+	const FGrammarRules GrammarRules = GrammarDefaults->GetSpawnParams();
+	const FDecorateLevelRules DecorateRules = GrammarDefaults->GetDecorateRules();
+	const FJumpEnvelope JumpEnvelope = FGrammarLayoutBuilder::MakeJumpEnvelope(GrammarRules);
+	const uint64 GrammarHash = FGrammarLayoutBuilder::GetParameterHash(GrammarRules, DecorateRules, JumpEnvelope);
+
+	ProcGenRandomTest::TestBuildsMatch(*this, TEXT("Grammar"), [&](int32 Seed, FLevelLayout& OutLayout)
+	{
+		FGrammarLayoutBuilder Builder(GrammarRules, DecorateRules, JumpEnvelope);
+		Builder.Build(Seed, GrammarHash, OutLayout);
+	});
+
+	const FProceduralGenerationParams BSPParams = GetDefault<ALevelGenerator>()->GetSpawnParams();
+
+	ProcGenRandomTest::TestBuildsMatch(*this, TEXT("BSP"), [&](int32 Seed, FLevelLayout& OutLayout)
+	{
+		FBSPLayoutBuilder Builder(BSPParams);
+		Builder.Build(Seed, OutLayout);
+	});
+
+	return true;
+}
+
+#endif